@@ -0,0 +1,377 @@
+﻿#include "BitovayaKarta.h"
+#include <algorithm>
+#include <bit>
+
+static constexpr size_t RAZMER_UCHASTKA = 65536;
+static constexpr size_t SLOV_V_UCHASTKE = RAZMER_UCHASTKA / 64;
+
+//Маска битов [0, k) слова
+static inline uint64_t nizhnieBiti(size_t k) {
+    return (k >= 64) ? ~0ull : ((1ull << k) - 1);
+}
+
+//Количество установленных битов в [ot, doo) битового массива участка
+static size_t popcountPromezhutka(const uint64_t* biti, size_t ot, size_t doo) {
+    if (ot >= doo) return 0;
+    size_t w0 = ot / 64, w1 = (doo - 1) / 64;
+    if (w0 == w1) {
+        return (size_t)std::popcount(biti[w0] & nizhnieBiti(doo - w0 * 64) & ~nizhnieBiti(ot % 64));
+    }
+    size_t kolvo = (size_t)std::popcount(biti[w0] & ~nizhnieBiti(ot % 64));
+    for (size_t w = w0 + 1; w < w1; w++) {
+        kolvo += (size_t)std::popcount(biti[w]);
+    }
+    kolvo += (size_t)std::popcount(biti[w1] & nizhnieBiti(doo - w1 * 64));
+    return kolvo;
+}
+
+bool BitovayaKarta::Konteyner::proverit(uint16_t x) const {
+    if (plotniy()) return (biti[x / 64] >> (x % 64)) & 1;
+    return std::binary_search(massiv.begin(), massiv.end(), x);
+}
+
+void BitovayaKarta::Konteyner::ustanovit(uint16_t x) {
+    if (plotniy()) {
+        uint64_t bit = 1ull << (x % 64);
+        if (!(biti[x / 64] & bit)) {
+            biti[x / 64] |= bit;
+            kolvo++;
+        }
+        return;
+    }
+    if (massiv.empty() || massiv.back() < x) {
+        massiv.push_back(x);
+    }
+    else {
+        auto it = std::lower_bound(massiv.begin(), massiv.end(), x);
+        if (*it == x) return;
+        massiv.insert(it, x);
+    }
+    kolvo++;
+    if (kolvo > PREDEL_MASSIVA) normalizovat();
+}
+
+size_t BitovayaKarta::Konteyner::kolvoVPromezhutke(size_t ot, size_t doo) const {
+    if (ot == 0 && doo >= RAZMER_UCHASTKA) return kolvo;
+    doo = std::min(doo, RAZMER_UCHASTKA);
+    if (plotniy()) return popcountPromezhutka(biti.data(), ot, doo);
+    auto l = std::lower_bound(massiv.begin(), massiv.end(), ot);
+    auto r = std::lower_bound(l, massiv.end(), doo);
+    return (size_t)(r - l);
+}
+
+void BitovayaKarta::Konteyner::normalizovat() {
+    if (!plotniy() && kolvo > PREDEL_MASSIVA) {
+        biti.assign(SLOV_V_UCHASTKE, 0);
+        for (uint16_t x : massiv) {
+            biti[x / 64] |= 1ull << (x % 64);
+        }
+        massiv.clear();
+        massiv.shrink_to_fit();
+    }
+    else if (plotniy() && kolvo <= PREDEL_MASSIVA) {
+        massiv.clear();
+        massiv.reserve(kolvo);
+        for (size_t w = 0; w < SLOV_V_UCHASTKE; w++) {
+            for (uint64_t slovo = biti[w]; slovo != 0; slovo &= slovo - 1) {
+                massiv.push_back((uint16_t)(w * 64 + std::countr_zero(slovo)));
+            }
+        }
+        biti.clear();
+        biti.shrink_to_fit();
+    }
+}
+
+size_t BitovayaKarta::naytiKonteyner(size_t klyuch) const {
+    auto it = std::lower_bound(konteynery.begin(), konteynery.end(), klyuch,
+        [](const Konteyner& k, size_t x) {
+            return k.klyuch < x;
+        });
+    return (it != konteynery.end() && it->klyuch == klyuch) ? (size_t)(it - konteynery.begin()) : konteynery.size();
+}
+
+void BitovayaKarta::clear() {
+    konteynery.clear();
+    vsego = 0;
+}
+
+void BitovayaKarta::ustanovit(size_t poziciya) {
+    size_t klyuch = poziciya / RAZMER_UCHASTKA;
+    uint16_t x = (uint16_t)(poziciya % RAZMER_UCHASTKA);
+
+    // Обычный случай - дописывание в последний участок или новый участок в конце
+    size_t nomer;
+    if (!konteynery.empty() && konteynery.back().klyuch == klyuch) {
+        nomer = konteynery.size() - 1;
+    }
+    else if (konteynery.empty() || konteynery.back().klyuch < klyuch) {
+        konteynery.emplace_back();
+        konteynery.back().klyuch = klyuch;
+        nomer = konteynery.size() - 1;
+    }
+    else {
+        auto it = std::lower_bound(konteynery.begin(), konteynery.end(), klyuch,
+            [](const Konteyner& k, size_t y) {
+                return k.klyuch < y;
+            });
+        if (it == konteynery.end() || it->klyuch != klyuch) {
+            it = konteynery.insert(it, Konteyner());
+            it->klyuch = klyuch;
+        }
+        nomer = (size_t)(it - konteynery.begin());
+    }
+
+    size_t bilo = konteynery[nomer].kolvo;
+    konteynery[nomer].ustanovit(x);
+    vsego += konteynery[nomer].kolvo - bilo;
+}
+
+bool BitovayaKarta::proverit(size_t poziciya) const {
+    size_t nomer = naytiKonteyner(poziciya / RAZMER_UCHASTKA);
+    return nomer < konteynery.size() && konteynery[nomer].proverit((uint16_t)(poziciya % RAZMER_UCHASTKA));
+}
+
+//Удаляет бит ot битового массива участка и сдвигает старшие биты на один вниз; возвращает, был ли бит установлен
+static bool vinutBit(std::vector<uint64_t>& biti, size_t ot) {
+    size_t w0 = ot / 64;
+    uint64_t slovo = biti[w0];
+    bool bil = (slovo >> (ot % 64)) & 1;
+    uint64_t nizh = slovo & nizhnieBiti(ot % 64);
+    uint64_t verh = (ot % 64 == 63) ? 0 : ((slovo >> 1) & ~nizhnieBiti(ot % 64));
+    biti[w0] = nizh | verh;
+    for (size_t w = w0 + 1; w < biti.size(); w++) {
+        biti[w - 1] |= (biti[w] & 1) << 63;
+        biti[w] >>= 1;
+    }
+    return bil;
+}
+
+void BitovayaKarta::udalit(size_t poziciya) {
+    size_t klyuch = poziciya / RAZMER_UCHASTKA;
+    auto it = std::lower_bound(konteynery.begin(), konteynery.end(), klyuch,
+        [](const Konteyner& k, size_t y) {
+            return k.klyuch < y;
+        });
+
+    // Позиция 0 каждого следующего участка переходит в позицию 65535 предыдущего
+    std::vector<size_t> noviePerenosi;
+    for (size_t j = (size_t)(it - konteynery.begin()); j < konteynery.size(); j++) {
+        Konteyner& k = konteynery[j];
+        size_t ot = (k.klyuch == klyuch) ? poziciya % RAZMER_UCHASTKA : 0;
+
+        bool bil;
+        if (k.plotniy()) {
+            bil = vinutBit(k.biti, ot);
+        }
+        else {
+            auto p = std::lower_bound(k.massiv.begin(), k.massiv.end(), ot);
+            bil = (p != k.massiv.end() && *p == ot);
+            if (bil) p = k.massiv.erase(p);
+            for (; p != k.massiv.end(); ++p) {
+                (*p)--;
+            }
+        }
+        if (bil) {
+            k.kolvo--;
+            vsego--;
+        }
+
+        if (bil && k.klyuch != klyuch) {
+            // Перенос в предыдущий участок: он уже обработан (или его нет)
+            if (j > 0 && konteynery[j - 1].klyuch == k.klyuch - 1) {
+                konteynery[j - 1].ustanovit((uint16_t)(RAZMER_UCHASTKA - 1));
+            }
+            else {
+                noviePerenosi.push_back(k.klyuch - 1);
+            }
+            vsego++;
+        }
+    }
+
+    for (size_t klyuchPerenosa : noviePerenosi) {
+        auto p = std::lower_bound(konteynery.begin(), konteynery.end(), klyuchPerenosa,
+            [](const Konteyner& k, size_t y) {
+                return k.klyuch < y;
+            });
+        p = konteynery.insert(p, Konteyner());
+        p->klyuch = klyuchPerenosa;
+        p->ustanovit((uint16_t)(RAZMER_UCHASTKA - 1));
+    }
+
+    konteynery.erase(std::remove_if(konteynery.begin(), konteynery.end(),
+        [](const Konteyner& k) {
+            return k.kolvo == 0;
+        }), konteynery.end());
+    for (Konteyner& k : konteynery) {
+        if (k.plotniy() && k.kolvo <= PREDEL_MASSIVA) k.normalizovat();
+    }
+}
+
+size_t BitovayaKarta::kolvo(size_t ot, size_t doo) const {
+    if (ot >= doo) return 0;
+    size_t kolvo = 0;
+    size_t pervyy = ot / RAZMER_UCHASTKA, posledniy = (doo - 1) / RAZMER_UCHASTKA;
+    auto it = std::lower_bound(konteynery.begin(), konteynery.end(), pervyy,
+        [](const Konteyner& k, size_t y) {
+            return k.klyuch < y;
+        });
+    for (; it != konteynery.end() && it->klyuch <= posledniy; ++it) {
+        size_t baza = it->klyuch * RAZMER_UCHASTKA;
+        size_t l = (it->klyuch == pervyy) ? ot - baza : 0;
+        size_t r = (it->klyuch == posledniy) ? doo - baza : RAZMER_UCHASTKA;
+        kolvo += it->kolvoVPromezhutke(l, r);
+    }
+    return kolvo;
+}
+
+size_t BitovayaKarta::kolvoObshih(const Konteyner& a, const Konteyner& b, size_t ot, size_t doo) {
+    if (a.plotniy() && b.plotniy()) {
+        size_t kolvo = 0;
+        size_t w0 = ot / 64, w1 = (doo - 1) / 64;
+        for (size_t w = w0; w <= w1; w++) {
+            uint64_t slovo = a.biti[w] & b.biti[w];
+            if (w == w0) slovo &= ~nizhnieBiti(ot % 64);
+            if (w == w1) slovo &= nizhnieBiti(doo - w1 * 64);
+            kolvo += (size_t)std::popcount(slovo);
+        }
+        return kolvo;
+    }
+    if (a.plotniy()) return kolvoObshih(b, a, ot, doo);
+
+    auto l = std::lower_bound(a.massiv.begin(), a.massiv.end(), ot);
+    auto r = std::lower_bound(l, a.massiv.end(), doo);
+    size_t kolvo = 0;
+    if (b.plotniy()) {
+        for (; l != r; ++l) {
+            kolvo += (b.biti[*l / 64] >> (*l % 64)) & 1;
+        }
+        return kolvo;
+    }
+    auto p = std::lower_bound(b.massiv.begin(), b.massiv.end(), ot);
+    while (l != r && p != b.massiv.end() && *p < doo) {
+        if (*l < *p) ++l;
+        else if (*p < *l) ++p;
+        else {
+            kolvo++;
+            ++l;
+            ++p;
+        }
+    }
+    return kolvo;
+}
+
+size_t BitovayaKarta::kolvoI(const BitovayaKarta& a, const BitovayaKarta& b, size_t ot, size_t doo) {
+    if (ot >= doo) return 0;
+    size_t kolvo = 0;
+    size_t pervyy = ot / RAZMER_UCHASTKA, posledniy = (doo - 1) / RAZMER_UCHASTKA;
+    size_t i = 0, j = 0;
+    while (i < a.konteynery.size() && j < b.konteynery.size()) {
+        size_t ka = a.konteynery[i].klyuch, kb = b.konteynery[j].klyuch;
+        if (ka < kb || ka < pervyy) {
+            i++;
+            continue;
+        }
+        if (kb < ka) {
+            j++;
+            continue;
+        }
+        if (ka > posledniy) break;
+        size_t baza = ka * RAZMER_UCHASTKA;
+        size_t l = (ka == pervyy) ? ot - baza : 0;
+        size_t r = (ka == posledniy) ? doo - baza : RAZMER_UCHASTKA;
+        kolvo += kolvoObshih(a.konteynery[i], b.konteynery[j], l, r);
+        i++;
+        j++;
+    }
+    return kolvo;
+}
+
+size_t BitovayaKarta::kolvoIli(const BitovayaKarta& a, const BitovayaKarta& b, size_t ot, size_t doo) {
+    return a.kolvo(ot, doo) + b.kolvo(ot, doo) - kolvoI(a, b, ot, doo);
+}
+
+BitovayaKarta BitovayaKarta::soedinit(const BitovayaKarta& a, const BitovayaKarta& b, bool peresechenie) {
+    BitovayaKarta rezultat;
+    size_t i = 0, j = 0;
+    while (i < a.konteynery.size() || j < b.konteynery.size()) {
+        bool estA = i < a.konteynery.size();
+        bool estB = j < b.konteynery.size();
+        if (estA && (!estB || a.konteynery[i].klyuch < b.konteynery[j].klyuch)) {
+            if (!peresechenie) rezultat.konteynery.push_back(a.konteynery[i]);
+            i++;
+            continue;
+        }
+        if (estB && (!estA || b.konteynery[j].klyuch < a.konteynery[i].klyuch)) {
+            if (!peresechenie) rezultat.konteynery.push_back(b.konteynery[j]);
+            j++;
+            continue;
+        }
+
+        // Общий участок: считаем через биты, затем выбираем вид хранения
+        const Konteyner& x = a.konteynery[i];
+        const Konteyner& y = b.konteynery[j];
+        Konteyner k;
+        k.klyuch = x.klyuch;
+        if (peresechenie && !x.plotniy() && !y.plotniy()) {
+            std::set_intersection(x.massiv.begin(), x.massiv.end(), y.massiv.begin(), y.massiv.end(), std::back_inserter(k.massiv));
+            k.kolvo = k.massiv.size();
+        }
+        else {
+            std::vector<uint64_t> bx(SLOV_V_UCHASTKE, 0), by(SLOV_V_UCHASTKE, 0);
+            auto vBiti = [](const Konteyner& c, std::vector<uint64_t>& b) {
+                if (c.plotniy()) {
+                    b = c.biti;
+                    return;
+                }
+                for (uint16_t v : c.massiv) {
+                    b[v / 64] |= 1ull << (v % 64);
+                }
+            };
+            vBiti(x, bx);
+            vBiti(y, by);
+            k.biti.resize(SLOV_V_UCHASTKE);
+            for (size_t w = 0; w < SLOV_V_UCHASTKE; w++) {
+                k.biti[w] = peresechenie ? (bx[w] & by[w]) : (bx[w] | by[w]);
+                k.kolvo += (size_t)std::popcount(k.biti[w]);
+            }
+            k.normalizovat();
+        }
+        if (k.kolvo > 0) rezultat.konteynery.push_back(std::move(k));
+        i++;
+        j++;
+    }
+
+    for (const Konteyner& k : rezultat.konteynery) {
+        rezultat.vsego += k.kolvo;
+    }
+    return rezultat;
+}
+
+BitovayaKarta BitovayaKarta::operator & (const BitovayaKarta& other) const {
+    return soedinit(*this, other, true);
+}
+
+BitovayaKarta BitovayaKarta::operator | (const BitovayaKarta& other) const {
+    return soedinit(*this, other, false);
+}
+
+std::vector<size_t> BitovayaKarta::pozicii() const {
+    std::vector<size_t> rezultat;
+    rezultat.reserve(vsego);
+    for (const Konteyner& k : konteynery) {
+        size_t baza = k.klyuch * RAZMER_UCHASTKA;
+        if (k.plotniy()) {
+            for (size_t w = 0; w < SLOV_V_UCHASTKE; w++) {
+                for (uint64_t slovo = k.biti[w]; slovo != 0; slovo &= slovo - 1) {
+                    rezultat.push_back(baza + w * 64 + std::countr_zero(slovo));
+                }
+            }
+        }
+        else {
+            for (uint16_t x : k.massiv) {
+                rezultat.push_back(baza + x);
+            }
+        }
+    }
+    return rezultat;
+}
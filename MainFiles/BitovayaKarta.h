@@ -0,0 +1,146 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Сжатое множество позиций (битовая карта в духе Roaring).
+ * * Позиции делятся на участки по 65536: у каждого участка свой контейнер,
+ * пустые участки не хранятся. Редкий участок (не больше PREDEL_MASSIVA позиций)
+ * хранится отсортированным массивом 16-битных смещений, плотный - битовым
+ * массивом из 1024 слов. Подсчет позиций в промежутке и в пересечении / объединении
+ * двух карт идет по целым контейнерам и словам через popcount.
+ */
+class BitovayaKarta
+{
+private:
+
+    /// @brief Контейнер одного участка.
+    struct Konteyner {
+        /// @brief Номер участка (позиция >> 16).
+        size_t klyuch = 0;
+        /// @brief Смещения по возрастанию (для редкого участка).
+        std::vector<uint16_t> massiv;
+        /// @brief Биты участка (для плотного участка, иначе пусто).
+        std::vector<uint64_t> biti;
+        /// @brief Количество позиций в участке.
+        size_t kolvo = 0;
+
+        /// @brief Хранится ли участок битовым массивом.
+        bool plotniy() const {
+            return !biti.empty();
+        }
+
+        /// @brief Проверяет смещение.
+        bool proverit(uint16_t x) const;
+
+        /// @brief Добавляет смещение.
+        void ustanovit(uint16_t x);
+
+        /// @brief Количество смещений в [ot, doo).
+        size_t kolvoVPromezhutke(size_t ot, size_t doo) const;
+
+        /// @brief Выбирает вид хранения по количеству позиций.
+        void normalizovat();
+    };
+
+    /// @brief Контейнеры по возрастанию ключа.
+    std::vector<Konteyner> konteynery;
+
+    /// @brief Количество позиций во всей карте.
+    size_t vsego = 0;
+
+    /**
+     * @brief Находит контейнер участка.
+     * @param klyuch Номер участка.
+     * @return Номер контейнера или konteynery.size(), если участок пуст.
+     */
+    size_t naytiKonteyner(size_t klyuch) const;
+
+    /// @brief Количество общих смещений двух контейнеров в [ot, doo).
+    static size_t kolvoObshih(const Konteyner& a, const Konteyner& b, size_t ot, size_t doo);
+
+    /// @brief Собирает карту из двух по операции ("и" или "или").
+    static BitovayaKarta soedinit(const BitovayaKarta& a, const BitovayaKarta& b, bool peresechenie);
+
+public:
+
+    /// @brief Сколько позиций участка хранится массивом, прежде чем он станет битовым.
+    static constexpr size_t PREDEL_MASSIVA = 4096;
+
+    /// @brief Конструктор пустой карты.
+    BitovayaKarta() = default;
+
+    /// @brief Возвращает количество позиций в карте.
+    size_t size() const {
+        return vsego;
+    }
+
+    /// @brief Проверяет, пуста ли карта.
+    bool empty() const {
+        return vsego == 0;
+    }
+
+    /// @brief Удаляет все позиции.
+    void clear();
+
+    /**
+     * @brief Добавляет позицию. Добавление позиции больше всех имеющихся - O(1) (кроме перехода участка в битовый вид).
+     * @param poziciya Позиция.
+     */
+    void ustanovit(size_t poziciya);
+
+    /**
+     * @brief Проверяет позицию.
+     * @param poziciya Позиция.
+     * @return true, если позиция есть в карте.
+     */
+    bool proverit(size_t poziciya) const;
+
+    /**
+     * @brief Удаляет позицию и сдвигает все большие позиции на одну вниз
+     * (вслед за удалением элемента массива). O(n / 64) по битовым участкам.
+     * @param poziciya Позиция.
+     */
+    void udalit(size_t poziciya);
+
+    /**
+     * @brief Количество позиций в промежутке [ot, doo).
+     * @param ot Начало (включительно).
+     * @param doo Конец (не включительно).
+     * @return Количество.
+     */
+    size_t kolvo(size_t ot, size_t doo) const;
+
+    /**
+     * @brief Количество позиций в промежутке [ot, doo), которые есть в обеих картах (без построения пересечения).
+     * @param a Первая карта.
+     * @param b Вторая карта.
+     * @param ot Начало (включительно).
+     * @param doo Конец (не включительно).
+     * @return Количество.
+     */
+    static size_t kolvoI(const BitovayaKarta& a, const BitovayaKarta& b, size_t ot, size_t doo);
+
+    /**
+     * @brief Количество позиций в промежутке [ot, doo), которые есть хотя бы в одной карте.
+     * @param a Первая карта.
+     * @param b Вторая карта.
+     * @param ot Начало (включительно).
+     * @param doo Конец (не включительно).
+     * @return Количество.
+     */
+    static size_t kolvoIli(const BitovayaKarta& a, const BitovayaKarta& b, size_t ot, size_t doo);
+
+    /// @brief Пересечение карт.
+    BitovayaKarta operator & (const BitovayaKarta& other) const;
+
+    /// @brief Объединение карт.
+    BitovayaKarta operator | (const BitovayaKarta& other) const;
+
+    /**
+     * @brief Все позиции по возрастанию.
+     * @return Вектор позиций.
+     */
+    std::vector<size_t> pozicii() const;
+};
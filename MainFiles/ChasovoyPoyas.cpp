@@ -0,0 +1,272 @@
+﻿#include "ChasovoyPoyas.h"
+#include "Kalendar.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+ChasovoyPoyas::ChasovoyPoyas():
+    nachalnoeSmeshenie(0) {
+}
+
+ChasovoyPoyas ChasovoyPoyas::fiksirovanniy(long long smeshenie) {
+    ChasovoyPoyas poyas;
+    poyas.nachalnoeSmeshenie = smeshenie;
+    return poyas;
+}
+
+ChasovoyPoyas ChasovoyPoyas::zagruzit(const std::string& put) {
+    std::ifstream file(put, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open zoneinfo file: " + put);
+    }
+    return zagruzit(file);
+}
+
+//Знаковое число big-endian из bytes байт
+static long long chitatChislo(const std::string& dannie, size_t pos, size_t bytes) {
+    if (pos + bytes > dannie.size()) throw std::runtime_error("Bad TZif data");
+
+    unsigned long long x = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        x = (x << 8) | (unsigned char)dannie[pos + i];
+    }
+    if (bytes < 8 && (x >> (8 * bytes - 1)) & 1) {
+        x |= ~0ULL << (8 * bytes);  // Расширяем знак
+    }
+    return (long long)x;
+}
+
+ChasovoyPoyas ChasovoyPoyas::zagruzit(std::istream& input) {
+    std::string dannie((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    if (dannie.size() < 44 || dannie.compare(0, 4, "TZif") != 0) {
+        throw std::runtime_error("Bad TZif data");
+    }
+
+    // Заголовок: 6 счетчиков по 4 байта, начиная с 20-го байта
+    auto schetchiki = [&](size_t pos, size_t* c) {
+        if (pos + 44 > dannie.size() || dannie.compare(pos, 4, "TZif") != 0) {
+            throw std::runtime_error("Bad TZif data");
+        }
+        for (size_t k = 0; k < 6; k++) {
+            c[k] = (size_t)(unsigned int)chitatChislo(dannie, pos + 20 + 4 * k, 4);
+        }
+    };
+
+    size_t c[6];  // isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt
+    schetchiki(0, c);
+
+    size_t pos = 44;
+    size_t razmerVremeni = 4;
+
+    // Начиная с версии 2 за блоком v1 идет второй заголовок и блок с 64-битными временами
+    if (dannie[4] >= '2') {
+        pos += c[3] * 4 + c[3] + c[4] * 6 + c[5] + c[2] * 8 + c[1] + c[0];
+        schetchiki(pos, c);
+        pos += 44;
+        razmerVremeni = 8;
+    }
+
+    size_t timecnt = c[3];
+    size_t typecnt = c[4];
+    if (typecnt == 0) throw std::runtime_error("Bad TZif data");
+
+    size_t posTipov = pos + timecnt * razmerVremeni;
+    size_t posInfo = posTipov + timecnt;
+
+    std::vector<long long> smesheniyaTipov(typecnt);
+    for (size_t t = 0; t < typecnt; t++) {
+        smesheniyaTipov[t] = chitatChislo(dannie, posInfo + 6 * t, 4);
+    }
+
+    ChasovoyPoyas poyas;
+    poyas.nachalnoeSmeshenie = smesheniyaTipov[0];
+    poyas.perehodi.reserve(timecnt);
+    poyas.smesheniya.reserve(timecnt);
+
+    for (size_t k = 0; k < timecnt; k++) {
+        size_t tip = (unsigned char)chitatChislo(dannie, posTipov + k, 1);
+        if (tip >= typecnt) throw std::runtime_error("Bad TZif data");
+
+        poyas.perehodi.push_back(chitatChislo(dannie, pos + k * razmerVremeni, razmerVremeni));
+        poyas.smesheniya.push_back(smesheniyaTipov[tip]);
+    }
+
+    // Хвост версии 2+: "\n<строка POSIX TZ>\n"
+    if (razmerVremeni == 8) {
+        size_t posHvosta = posInfo + typecnt * 6 + c[5] + c[2] * 12 + c[1] + c[0];
+        if (posHvosta < dannie.size() && dannie[posHvosta] == '\n') {
+            size_t konets = dannie.find('\n', posHvosta + 1);
+            if (konets != std::string::npos) {
+                poyas.razvernutPravilo(dannie.substr(posHvosta + 1, konets - posHvosta - 1));
+            }
+        }
+    }
+
+    return poyas;
+}
+
+//Номер дня для правила Mm.w.d: d-й день недели (0 - воскресенье) w-й недели месяца m (w = 5 - последний)
+static long long denPravila(long long god, int mesyats, int nedelya, int denNedeli) {
+    long long pervyy = Kalendar::daysFromCivil(god, mesyats, 1);
+    long long sleduyushiy = (mesyats == 12) ? Kalendar::daysFromCivil(god + 1, 1, 1) : Kalendar::daysFromCivil(god, mesyats + 1, 1);
+
+    long long denNedeliPervogo = pervyy + 4 - Kalendar::delenieVniz(pervyy + 4, 7) * 7;  // 1970-01-01 - четверг
+    long long den = pervyy + (denNedeli - denNedeliPervogo + 7) % 7 + (long long)(nedelya - 1) * 7;
+    while (den >= sleduyushiy) {
+        den -= 7;
+    }
+    return den;
+}
+
+void ChasovoyPoyas::razvernutPravilo(const std::string& pravilo) {
+    size_t i = 0;
+
+    auto imya = [&]() {
+        if (i < pravilo.size() && pravilo[i] == '<') {
+            size_t konets = pravilo.find('>', i);
+            i = (konets == std::string::npos) ? pravilo.size() : konets + 1;
+        }
+        else {
+            while (i < pravilo.size() && std::isalpha((unsigned char)pravilo[i])) i++;
+        }
+    };
+
+    // [+-]hh[:mm[:ss]] в секундах
+    auto vremya = [&]() {
+        long long znak = 1;
+        if (i < pravilo.size() && (pravilo[i] == '+' || pravilo[i] == '-')) {
+            znak = (pravilo[i] == '-') ? -1 : 1;
+            i++;
+        }
+        long long sekundi = 0;
+        long long mnozhitel = 3600;
+        while (i < pravilo.size() && mnozhitel > 0) {
+            long long chislo = 0;
+            bool est = false;
+            while (i < pravilo.size() && std::isdigit((unsigned char)pravilo[i])) {
+                chislo = chislo * 10 + (pravilo[i] - '0');
+                i++;
+                est = true;
+            }
+            if (!est) break;
+            sekundi += chislo * mnozhitel;
+            mnozhitel /= 60;
+            if (i < pravilo.size() && pravilo[i] == ':') i++;
+            else break;
+        }
+        return znak * sekundi;
+    };
+
+    auto chislo = [&]() {
+        int x = 0;
+        while (i < pravilo.size() && std::isdigit((unsigned char)pravilo[i])) {
+            x = x * 10 + (pravilo[i] - '0');
+            i++;
+        }
+        return x;
+    };
+
+    imya();
+    long long standart = -vremya();  // В POSIX TZ знак обратный: "MSK-3" - это UTC+3
+
+    if (perehodi.empty()) {
+        nachalnoeSmeshenie = standart;
+    }
+
+    if (i >= pravilo.size()) return;  // Летнего времени нет
+
+    imya();
+    long long letnee = standart + 3600;
+    if (i < pravilo.size() && pravilo[i] != ',') {
+        letnee = -vremya();
+    }
+
+    // ,Mm.w.d[/time],Mm.w.d[/time]
+    int m[2], w[2], d[2];
+    long long t[2] = { 7200, 7200 };
+    for (int k = 0; k < 2; k++) {
+        if (i + 1 >= pravilo.size() || pravilo[i] != ',' || pravilo[i + 1] != 'M') return;  // Другие формы правил не поддерживаются
+        i += 2;
+        m[k] = chislo();
+        if (i < pravilo.size() && pravilo[i] == '.') i++;
+        w[k] = chislo();
+        if (i < pravilo.size() && pravilo[i] == '.') i++;
+        d[k] = chislo();
+        if (i < pravilo.size() && pravilo[i] == '/') {
+            i++;
+            t[k] = vremya();
+        }
+        if (m[k] < 1 || m[k] > 12 || w[k] < 1 || w[k] > 5 || d[k] > 6) return;
+    }
+
+    long long posledniy = perehodi.empty() ? 0 : perehodi.back();
+    long long pervyyGod = Kalendar::dataIzDati(posledniy).god;
+
+    std::vector<std::pair<long long, long long>> novie;
+    for (long long god = pervyyGod; god <= POSLEDNIY_GOD_PRAVIL; god++) {
+        // Переход на летнее время задан по стандартному времени, обратно - по летнему
+        long long nachalo = denPravila(god, m[0], w[0], d[0]) * Kalendar::SEKUND_V_SUTKAH + t[0] - standart;
+        long long konets = denPravila(god, m[1], w[1], d[1]) * Kalendar::SEKUND_V_SUTKAH + t[1] - letnee;
+        novie.push_back({ nachalo, letnee });
+        novie.push_back({ konets, standart });
+    }
+    std::sort(novie.begin(), novie.end());
+
+    for (const auto& [moment, smeshenie] : novie) {
+        if (perehodi.empty() || moment > perehodi.back()) {
+            perehodi.push_back(moment);
+            smesheniya.push_back(smeshenie);
+        }
+    }
+}
+
+long long ChasovoyPoyas::smeshenie(long long utc) const {
+    auto it = std::upper_bound(perehodi.begin(), perehodi.end(), utc);
+    if (it == perehodi.begin()) {
+        return nachalnoeSmeshenie;
+    }
+    return smesheniya[it - perehodi.begin() - 1];
+}
+
+long long ChasovoyPoyas::vUTC(long long mestnoe) const {
+    // Смещения не превышают суток, поэтому достаточно переходов в окне +-2 суток
+    const long long okno = 2 * Kalendar::SEKUND_V_SUTKAH;
+    size_t l = std::lower_bound(perehodi.begin(), perehodi.end(), mestnoe - okno) - perehodi.begin();
+    size_t r = std::upper_bound(perehodi.begin(), perehodi.end(), mestnoe + okno) - perehodi.begin();
+
+    // Кандидаты по порядку времени: смещение до окна, затем после каждого перехода в окне
+    for (size_t k = l; k <= r; k++) {
+        long long kandidat = (k == 0) ? nachalnoeSmeshenie : smesheniya[k - 1];
+        if (smeshenie(mestnoe - kandidat) == kandidat) {
+            return mestnoe - kandidat;
+        }
+    }
+
+    // Местное время попало в "дыру" при переводе часов вперед - возвращаем момент перехода
+    for (size_t k = l; k < r; k++) {
+        long long doPerehoda = (k == 0) ? nachalnoeSmeshenie : smesheniya[k - 1];
+        if (perehodi[k] + doPerehoda <= mestnoe && mestnoe < perehodi[k] + smesheniya[k]) {
+            return perehodi[k];
+        }
+    }
+
+    return mestnoe - smeshenie(mestnoe);
+}
+
+long long ChasovoyPoyas::klyuchMesyatsa(long long utc) const {
+    return Kalendar::klyuchMesyatsa(utc, smeshenie(utc));
+}
+
+long long ChasovoyPoyas::nachaloMesyatsa(long long klyuch) const {
+    return vUTC(Kalendar::nachaloMesyatsa(klyuch));
+}
+
+void ChasovoyPoyas::granitsiMesyatsa(long long date, long long& startMonth, long long& endMonth) const {
+    long long klyuch = klyuchMesyatsa(date);
+    startMonth = nachaloMesyatsa(klyuch);
+    endMonth = nachaloMesyatsa(klyuch + 1);
+}
@@ -0,0 +1,109 @@
+﻿#pragma once
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Часовой пояс в виде заранее вычисленной таблицы переходов.
+ * * Загружается один раз из файла zoneinfo (формат TZif, RFC 8536), например
+ * "/usr/share/zoneinfo/Europe/Moscow". Правило из хвоста файла (строка POSIX TZ,
+ * например "CET-1CEST,M3.5.0,M10.5.0/3") разворачивается в переходы до POSLEDNIY_GOD_PRAVIL.
+ * Смещение для любого момента времени ищется двоичным поиском по таблице,
+ * функции libc (localtime, mktime, tzset) не вызываются, поэтому объект
+ * можно одновременно использовать из нескольких потоков.
+ */
+class ChasovoyPoyas
+{
+private:
+
+    /// @brief Моменты переходов (UTC, Unix timestamp), по возрастанию.
+    std::vector<long long> perehodi;
+
+    /// @brief Смещение от UTC (в секундах), действующее начиная с соответствующего перехода.
+    std::vector<long long> smesheniya;
+
+    /// @brief Смещение до первого перехода.
+    long long nachalnoeSmeshenie;
+
+    /**
+     * @brief Разворачивает правило POSIX TZ в переходы до POSLEDNIY_GOD_PRAVIL.
+     * Поддерживается форма правил Mm.w.d, другие формы игнорируются
+     * (после последнего перехода из файла действует последнее смещение).
+     * @param pravilo Строка POSIX TZ.
+     */
+    void razvernutPravilo(const std::string& pravilo);
+
+public:
+
+    /// @brief До какого года включительно разворачивается правило из хвоста файла.
+    static constexpr long long POSLEDNIY_GOD_PRAVIL = 2100;
+
+    /// @brief Конструктор по умолчанию. Создает пояс UTC.
+    ChasovoyPoyas();
+
+    /**
+     * @brief Создает пояс с постоянным смещением.
+     * @param smeshenie Смещение от UTC в секундах (например +3 часа = 10800).
+     * @return Часовой пояс без переходов.
+     */
+    static ChasovoyPoyas fiksirovanniy(long long smeshenie);
+
+    /**
+     * @brief Загружает часовой пояс из файла TZif.
+     * @param put Путь к файлу (например "/usr/share/zoneinfo/Europe/Berlin").
+     * @return Часовой пояс.
+     * @throws std::runtime_error Если файл не открывается или имеет неверный формат.
+     */
+    static ChasovoyPoyas zagruzit(const std::string& put);
+
+    /**
+     * @brief Загружает часовой пояс из потока с данными TZif.
+     * @param input Поток (открытый в двоичном режиме).
+     * @return Часовой пояс.
+     * @throws std::runtime_error Если данные имеют неверный формат.
+     */
+    static ChasovoyPoyas zagruzit(std::istream& input);
+
+    /// @brief Возвращает количество переходов в таблице.
+    size_t kolvoPerehodov() const {
+        return perehodi.size();
+    }
+
+    /**
+     * @brief Смещение от UTC, действующее в момент времени. O(log числа переходов).
+     * @param utc Момент времени (Unix timestamp).
+     * @return Смещение в секундах.
+     */
+    long long smeshenie(long long utc) const;
+
+    /**
+     * @brief Переводит местное время в UTC.
+     * Для неоднозначного местного времени (перевод часов назад) берется более ранний момент,
+     * для несуществующего (перевод вперед) - момент перехода.
+     * @param mestnoe Местное время (секунды от 1970-01-01 00:00 по местным часам).
+     * @return Момент времени UTC.
+     */
+    long long vUTC(long long mestnoe) const;
+
+    /**
+     * @brief Ключ местного месяца ("год * 12 + (месяц - 1)", см. Kalendar::klyuchMesyatsa).
+     * @param utc Момент времени.
+     * @return Ключ месяца.
+     */
+    long long klyuchMesyatsa(long long utc) const;
+
+    /**
+     * @brief Момент начала местного месяца.
+     * @param klyuch Ключ месяца.
+     * @return Момент UTC, когда по местным часам наступает полночь первого числа.
+     */
+    long long nachaloMesyatsa(long long klyuch) const;
+
+    /**
+     * @brief Вычисляет границы местного месяца, в который попадает дата.
+     * @param date Любая дата внутри месяца (Unix timestamp).
+     * @param startMonth Сюда записывается начало месяца (включительно).
+     * @param endMonth Сюда записывается начало следующего месяца (не включительно).
+     */
+    void granitsiMesyatsa(long long date, long long& startMonth, long long& endMonth) const;
+};
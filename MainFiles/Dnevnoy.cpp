@@ -0,0 +1,162 @@
+﻿#include "Dnevnoy.h"
+#include <bit>
+#include <stdexcept>
+
+DnevnoyPrognoz::DnevnoyPrognoz(long long smeshenie):
+    pervyyDen(0), zapas(0), kolvo(0), smeshenie(smeshenie) {
+}
+
+DnevnoyPrognoz::DnevnoyPrognoz(const SlozhniyPrognoz& vector, long long smeshenie):
+    pervyyDen(0), zapas(0), kolvo(0), smeshenie(smeshenie) {
+
+    for (size_t i = 0; i < vector.size(); i++) {
+        *this += vector[i];
+    }
+}
+
+void DnevnoyPrognoz::rasshirit(long long den) {
+    if (dni.empty()) {
+        pervyyDen = den;
+        zapas = 0;
+        dni.resize(1);
+        maska.assign(1, 0);
+        return;
+    }
+
+    // Охват считается от первого добавленного дня, запас в начале массива в него не входит
+    long long perviy = pervyyDen + (long long)zapas;
+    long long posledniy = pervyyDen + (long long)dni.size() - 1;
+    if (std::max(posledniy, den) - std::min(perviy, den) >= MAKS_RAZMAH) {
+        throw std::out_of_range("Date is too far from other forecasts");
+    }
+
+    if (den < pervyyDen) {
+        // Запас в начало не меньше текущего размера - вставка в начало амортизированно O(1).
+        // Запас кратен 64, чтобы маска сдвигалась целыми словами
+        size_t nuzhno = (size_t)std::max<long long>(pervyyDen - den, (long long)dni.size());
+        size_t sdvig = (nuzhno + 63) / 64 * 64;
+
+        dni.insert(dni.begin(), sdvig, ProstoyPrognoz());
+        maska.insert(maska.begin(), sdvig / 64, 0);
+        pervyyDen -= (long long)sdvig;
+    }
+    else if (den > posledniy) {
+        size_t noviyRazmer = (size_t)(den - pervyyDen + 1);
+        if (noviyRazmer > dni.capacity()) {
+            dni.reserve(std::max(noviyRazmer, dni.capacity() * 2));
+        }
+        dni.resize(noviyRazmer);
+        maska.resize((noviyRazmer + 63) / 64, 0);
+    }
+
+    if (den < perviy) {
+        zapas = (size_t)(den - pervyyDen);
+    }
+}
+
+size_t DnevnoyPrognoz::poziciya(long long den) const {
+    if (dni.empty() || den < pervyyDen || den - pervyyDen >= (long long)dni.size()) {
+        return SlozhniyPrognoz::NE_NAYDENO;
+    }
+    return (size_t)(den - pervyyDen);
+}
+
+DnevnoyPrognoz& DnevnoyPrognoz::operator += (const ProstoyPrognoz& prognoz) {
+    long long den = Kalendar::denIzDati(prognoz.getDate(), smeshenie);
+    rasshirit(den);
+
+    size_t p = poziciya(den);
+    ProstoyPrognoz normalniy = prognoz;
+    normalniy.setDate(den * Kalendar::SEKUND_V_SUTKAH - smeshenie);
+
+    uint64_t bit = 1ULL << (p % 64);
+    if (maska[p / 64] & bit) {
+        dni[p] += normalniy;
+    }
+    else {
+        dni[p] = normalniy;
+        maska[p / 64] |= bit;
+        kolvo++;
+    }
+
+    return *this;
+}
+
+const ProstoyPrognoz* DnevnoyPrognoz::nayti(long long date) const {
+    size_t p = poziciya(Kalendar::denIzDati(date, smeshenie));
+    if (p == SlozhniyPrognoz::NE_NAYDENO || !((maska[p / 64] >> (p % 64)) & 1)) {
+        return nullptr;
+    }
+    return &dni[p];
+}
+
+bool DnevnoyPrognoz::udalit(long long date) {
+    size_t p = poziciya(Kalendar::denIzDati(date, smeshenie));
+    if (p == SlozhniyPrognoz::NE_NAYDENO || !((maska[p / 64] >> (p % 64)) & 1)) {
+        return false;
+    }
+
+    maska[p / 64] &= ~(1ULL << (p % 64));
+    dni[p] = ProstoyPrognoz();
+    kolvo--;
+    return true;
+}
+
+DnevnoyPrognoz::Srez DnevnoyPrognoz::diapazon(long long dateStart, long long dateEnd) const {
+    Srez srez;
+    if (dni.empty() || dateStart > dateEnd) return srez;
+
+    long long denStart = std::max(Kalendar::denIzDati(dateStart, smeshenie), pervyyDen + (long long)zapas);
+    long long denEnd = std::min(Kalendar::denIzDati(dateEnd, smeshenie), pervyyDen + (long long)dni.size() - 1);
+    if (denStart > denEnd) return srez;
+
+    srez.sdvig = (size_t)(denStart - pervyyDen);
+    srez.pervyyDen = denStart;
+    srez.maska = maska.data();
+    srez.prognozi = std::span<const ProstoyPrognoz>(dni.data() + srez.sdvig, (size_t)(denEnd - denStart + 1));
+    return srez;
+}
+
+ProstoyPrognoz DnevnoyPrognoz::getColdestDay(long long dateStart, long long dateEnd) const {
+    Srez srez = diapazon(dateStart, dateEnd);
+
+    size_t nachalo = srez.sdvig;
+    size_t konets = srez.sdvig + srez.prognozi.size();
+    size_t coldest = SlozhniyPrognoz::NE_NAYDENO;
+    double minimum = 0.0;
+
+    // Идем по словам маски и пропускаем пустые дни целыми пачками
+    for (size_t slovo = nachalo / 64; slovo * 64 < konets; slovo++) {
+        uint64_t biti = maska[slovo];
+        if (slovo == nachalo / 64) biti &= ~0ULL << (nachalo % 64);
+        if (konets - slovo * 64 < 64) biti &= (1ULL << (konets - slovo * 64)) - 1;
+
+        while (biti != 0) {
+            size_t p = slovo * 64 + std::countr_zero(biti);
+            biti &= biti - 1;
+
+            double average = dni[p].getAverageTemp();
+            if (coldest == SlozhniyPrognoz::NE_NAYDENO || average < minimum) {
+                minimum = average;
+                coldest = p;
+            }
+        }
+    }
+
+    if (coldest == SlozhniyPrognoz::NE_NAYDENO) {
+        throw std::logic_error("No forecasts found in your date range");
+    }
+    return dni[coldest];
+}
+
+SlozhniyPrognoz DnevnoyPrognoz::toSlozhniy() const {
+    SlozhniyPrognoz vector;
+    for (size_t slovo = 0; slovo < maska.size(); slovo++) {
+        uint64_t biti = maska[slovo];
+        while (biti != 0) {
+            vector += dni[slovo * 64 + std::countr_zero(biti)];
+            biti &= biti - 1;
+        }
+    }
+    return vector;
+}
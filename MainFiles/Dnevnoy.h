@@ -0,0 +1,152 @@
+﻿#pragma once
+#include "Slozhniy.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Плотное хранилище прогнозов "один прогноз на календарный день".
+ * * Дата каждого прогноза приводится к номеру дня (Kalendar::denIzDati), а сам прогноз
+ * хранится в массиве по индексу (день - pervyyDen). Пропущенные дни отмечаются
+ * в битовой маске присутствия. Поиск по дате - O(1), выборка за промежуток - срез массива.
+ * Повторный прогноз на тот же день сразу объединяется (operator+= класса ProstoyPrognoz),
+ * поэтому отдельный mergePovtorki не нужен.
+ */
+class DnevnoyPrognoz
+{
+private:
+
+    /// @brief Прогнозы по дням, начиная с pervyyDen (для пропусков - прогноз по умолчанию).
+    std::vector<ProstoyPrognoz> dni;
+
+    /// @brief Битовая маска присутствия: бит i установлен, если за день pervyyDen + i есть прогноз.
+    std::vector<uint64_t> maska;
+
+    /// @brief Номер дня (Kalendar::denIzDati) первого элемента массива.
+    long long pervyyDen;
+
+    /// @brief Запас в начале массива: сколько ячеек перед первым добавленным днем (в охват не входит).
+    size_t zapas;
+
+    /// @brief Количество дней, за которые есть прогноз.
+    size_t kolvo;
+
+    /// @brief Смещение часового пояса (в секундах), по которому определяются сутки.
+    long long smeshenie;
+
+    /**
+     * @brief Расширяет массив так, чтобы в него попадал день den.
+     * При расширении в начало добавляется запас, кратный 64 дням, чтобы маска сдвигалась целыми словами.
+     * Запас не входит в охват, ограниченный MAKS_RAZMAH.
+     * @param den Номер дня.
+     */
+    void rasshirit(long long den);
+
+    /**
+     * @brief Позиция дня в массиве.
+     * @param den Номер дня.
+     * @return Позиция или SlozhniyPrognoz::NE_NAYDENO, если день вне массива.
+     */
+    size_t poziciya(long long den) const;
+
+public:
+
+    /**
+     * @brief Максимальный охват хранилища в днях (около 200 лет, не больше 5-6 МБ под дни).
+     * Ячейка выделяется на каждый день охвата, поэтому одна ошибочная дата далеко от остальных
+     * отклоняется исключением, а не раздувает массив на миллионы пустых дней.
+     */
+    static constexpr long long MAKS_RAZMAH = 73050;
+
+    /**
+     * @brief Срез подряд идущих дней (результат diapazon).
+     * Отсутствующие дни присутствуют в срезе как прогнозы по умолчанию, проверять через est().
+     */
+    struct Srez {
+        /// @brief Прогнозы подряд идущих дней.
+        std::span<const ProstoyPrognoz> prognozi;
+        /// @brief Номер дня первого элемента среза.
+        long long pervyyDen = 0;
+        /// @brief Маска присутствия хранилища.
+        const uint64_t* maska = nullptr;
+        /// @brief Позиция первого элемента среза в хранилище (для маски).
+        size_t sdvig = 0;
+
+        /// @brief Есть ли прогноз за i-й день среза.
+        bool est(size_t i) const {
+            size_t p = sdvig + i;
+            return (maska[p / 64] >> (p % 64)) & 1;
+        }
+    };
+
+    /**
+     * @brief Конструктор пустого хранилища.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     */
+    explicit DnevnoyPrognoz(long long smeshenie = 0);
+
+    /**
+     * @brief Создает хранилище из вектора прогнозов.
+     * Прогнозы за одни сутки объединяются в порядке их следования в векторе.
+     * @param vector Исходный вектор прогнозов.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @throws std::out_of_range Если даты прогнозов охватывают больше MAKS_RAZMAH дней.
+     */
+    explicit DnevnoyPrognoz(const SlozhniyPrognoz& vector, long long smeshenie = 0);
+
+    /// @brief Возвращает количество дней, за которые есть прогноз.
+    size_t size() const {
+        return kolvo;
+    }
+
+    /// @brief Возвращает количество дней от первого до последнего (вместе с пропусками, без запаса).
+    size_t razmah() const {
+        return dni.size() - zapas;
+    }
+
+    /**
+     * @brief Добавляет прогноз. Дата прогноза приводится к началу суток.
+     * Если за этот день прогноз уже есть, они объединяются (operator+= класса ProstoyPrognoz).
+     * @param prognoz Прогноз для добавления.
+     * @return Ссылка на текущий объект.
+     * @throws std::out_of_range Если с новым прогнозом охват хранилища превысит MAKS_RAZMAH дней.
+     */
+    DnevnoyPrognoz& operator += (const ProstoyPrognoz& prognoz);
+
+    /**
+     * @brief Находит прогноз за сутки, в которые попадает дата. O(1).
+     * @param date Любой момент суток (Unix timestamp).
+     * @return Указатель на прогноз или nullptr, если за этот день прогноза нет.
+     */
+    const ProstoyPrognoz* nayti(long long date) const;
+
+    /**
+     * @brief Удаляет прогноз за сутки, в которые попадает дата.
+     * @param date Любой момент суток (Unix timestamp).
+     * @return true, если прогноз был удален.
+     */
+    bool udalit(long long date);
+
+    /**
+     * @brief Возвращает срез дней за промежуток (оба конца включительно) без копирования.
+     * @param dateStart Начало промежутка.
+     * @param dateEnd Конец промежутка.
+     * @return Срез (пустой, если промежуток не пересекается с хранилищем).
+     */
+    Srez diapazon(long long dateStart, long long dateEnd) const;
+
+    /**
+     * @brief Ищет самый холодный день в промежутке (по средней температуре).
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @return Копия найденного прогноза.
+     * @throws std::logic_error Если в промежутке нет прогнозов.
+     */
+    ProstoyPrognoz getColdestDay(long long dateStart, long long dateEnd) const;
+
+    /**
+     * @brief Переводит хранилище в обычный вектор прогнозов (отсортированный по дате).
+     * @return Вектор прогнозов.
+     */
+    SlozhniyPrognoz toSlozhniy() const;
+};
@@ -0,0 +1,384 @@
+﻿#include "Filtr.h"
+#include "Yadra.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+static constexpr long long MIN_DATA = std::numeric_limits<long long>::min();
+static constexpr long long MAKS_DATA = std::numeric_limits<long long>::max();
+
+static_assert(Yadra::RAZMER_BLOKA >= Filtr::RAZMER_BLOKA, "Filter block must fit into a kernel block");
+static_assert(ZonnayaKarta::RAZMER_BLOKA == Filtr::RAZMER_BLOKA, "Zone block must match the filter block");
+static_assert((int)Filtr::Pole::Osadki == ZonnayaKarta::KOLVO_POLEY - 1, "Zone fields follow Filtr::Pole");
+
+Filtr::Filtr() :
+    koren(0), nizhnyayaData(MIN_DATA), verhnyayaData(MAKS_DATA) {
+    uzli.push_back(Uzel());
+}
+
+Filtr::Filtr(const Uzel& uzel) :
+    koren(0), nizhnyayaData(MIN_DATA), verhnyayaData(MAKS_DATA) {
+    uzli.push_back(uzel);
+}
+
+Filtr Filtr::sravnenie(Pole pole, Operaciya operaciya, double znachenie) {
+    Uzel uzel;
+    uzel.vid = Vid::Sravnenie;
+    uzel.pole = pole;
+    uzel.operaciya = operaciya;
+    uzel.znachenie = znachenie;
+    return Filtr(uzel);
+}
+
+Filtr Filtr::statusi(std::initializer_list<std::string> statusi) {
+    Uzel uzel;
+    uzel.vid = Vid::Statusi;
+    for (const std::string& status : statusi) {
+        int kod = ProstoyPrognoz::kodStatusa(status);
+        if (kod < 0) throw std::out_of_range("Incorrect Status");
+        uzel.maskaStatusov |= 1u << kod;
+    }
+    return Filtr(uzel);
+}
+
+Filtr Filtr::daty(long long dateStart, long long dateEnd) {
+    Uzel uzel;
+    uzel.vid = Vid::Daty;
+    uzel.ot = dateStart;
+    uzel.po = dateEnd;
+    Filtr filtr(uzel);
+    filtr.nizhnyayaData = dateStart;
+    filtr.verhnyayaData = dateEnd;
+    return filtr;
+}
+
+Filtr Filtr::oshibochnie() {
+    Uzel uzel;
+    uzel.vid = Vid::Oshibka;
+    return Filtr(uzel);
+}
+
+size_t Filtr::skopirovat(const Filtr& other, size_t uzel) {
+    Uzel kopiya = other.uzli[uzel];
+    std::vector<size_t> deti = std::move(kopiya.deti);
+    kopiya.deti.clear();
+
+    size_t nomer = uzli.size();
+    uzli.push_back(kopiya);
+    for (size_t d : deti) {
+        size_t novyy = skopirovat(other, d);
+        uzli[nomer].deti.push_back(novyy);
+    }
+    return nomer;
+}
+
+Filtr Filtr::soedinit(Vid vid, const Filtr& a, const Filtr& b) {
+    Uzel uzel;
+    uzel.vid = vid;
+    Filtr rezultat(uzel);
+
+    for (const Filtr* chast : { &a, &b }) {
+        const Uzel& kor = chast->uzli[chast->koren];
+        if (kor.vid == vid) {
+            for (size_t d : kor.deti) {
+                size_t novyy = rezultat.skopirovat(*chast, d);
+                rezultat.uzli[0].deti.push_back(novyy);
+            }
+        }
+        else {
+            size_t novyy = rezultat.skopirovat(*chast, chast->koren);
+            rezultat.uzli[0].deti.push_back(novyy);
+        }
+    }
+
+    if (vid == Vid::I) {
+        // Дешевые и обычно избирательные условия первыми: каждое следующее проверяет меньше прогнозов
+        auto stoimost = [&](size_t d) {
+            switch (rezultat.uzli[d].vid) {
+            case Vid::Daty: return 0;
+            case Vid::Sravnenie: return 1;
+            case Vid::Statusi: return 2;
+            case Vid::Oshibka: return 3;
+            case Vid::Vse: return 5;
+            default: return 4;
+            }
+        };
+        std::stable_sort(rezultat.uzli[0].deti.begin(), rezultat.uzli[0].deti.end(),
+            [&](size_t x, size_t y) {
+                return stoimost(x) < stoimost(y);
+            });
+
+        rezultat.nizhnyayaData = std::max(a.nizhnyayaData, b.nizhnyayaData);
+        rezultat.verhnyayaData = std::min(a.verhnyayaData, b.verhnyayaData);
+    }
+    else {
+        rezultat.nizhnyayaData = std::min(a.nizhnyayaData, b.nizhnyayaData);
+        rezultat.verhnyayaData = std::max(a.verhnyayaData, b.verhnyayaData);
+    }
+    return rezultat;
+}
+
+Filtr Filtr::operator && (const Filtr& other) const {
+    return soedinit(Vid::I, *this, other);
+}
+
+Filtr Filtr::operator || (const Filtr& other) const {
+    return soedinit(Vid::Ili, *this, other);
+}
+
+Filtr Filtr::operator ! () const {
+    Uzel uzel;
+    uzel.vid = Vid::Ne;
+    Filtr rezultat(uzel);
+    size_t novyy = rezultat.skopirovat(*this, koren);
+    rezultat.uzli[0].deti.push_back(novyy);
+    return rezultat;
+}
+
+size_t Filtr::glubina(size_t uzel) const {
+    size_t g = 0;
+    for (size_t d : uzli[uzel].deti) {
+        g = std::max(g, glubina(d));
+    }
+    return g + 1;
+}
+
+//Значение поля прогноза
+static double znacheniePolya(const ProstoyPrognoz& p, Filtr::Pole pole) {
+    switch (pole) {
+    case Filtr::Pole::Utro: return p.getMorningTemp();
+    case Filtr::Pole::Den: return p.getDayTemp();
+    case Filtr::Pole::Vecher: return p.getEveningTemp();
+    case Filtr::Pole::Osadki: return p.getOsadki();
+    default: return p.getAverageTemp();
+    }
+}
+
+//Результат сравнения "a ? b"
+static bool sravnit(double a, Filtr::Operaciya operaciya, double b) {
+    switch (operaciya) {
+    case Filtr::Operaciya::Menshe: return a < b;
+    case Filtr::Operaciya::MensheIliRavno: return a <= b;
+    case Filtr::Operaciya::Bolshe: return a > b;
+    case Filtr::Operaciya::BolsheIliRavno: return a >= b;
+    case Filtr::Operaciya::Ravno: return a == b;
+    default: return a != b;
+    }
+}
+
+//Сужение вектора выбора без ветвлений: номер записывается всегда, а позиция сдвигается только если условие выполнено
+template <typename Uslovie>
+static size_t suzit(const ProstoyPrognoz* blok, uint32_t* vibor, size_t n, Uslovie uslovie) {
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t j = vibor[i];
+        vibor[m] = j;
+        m += uslovie(blok[j]) ? 1 : 0;
+    }
+    return m;
+}
+
+//Сравнение поля: отдельный цикл на каждую пару (поле, операция), чтобы внутри не было выбора
+template <typename Pol>
+static size_t suzitSravneniem(const ProstoyPrognoz* blok, uint32_t* vibor, size_t n, Pol pol, Filtr::Operaciya operaciya, double z) {
+    switch (operaciya) {
+    case Filtr::Operaciya::Menshe:
+        return suzit(blok, vibor, n, [&](const ProstoyPrognoz& p) { return pol(p) < z; });
+    case Filtr::Operaciya::MensheIliRavno:
+        return suzit(blok, vibor, n, [&](const ProstoyPrognoz& p) { return pol(p) <= z; });
+    case Filtr::Operaciya::Bolshe:
+        return suzit(blok, vibor, n, [&](const ProstoyPrognoz& p) { return pol(p) > z; });
+    case Filtr::Operaciya::BolsheIliRavno:
+        return suzit(blok, vibor, n, [&](const ProstoyPrognoz& p) { return pol(p) >= z; });
+    case Filtr::Operaciya::Ravno:
+        return suzit(blok, vibor, n, [&](const ProstoyPrognoz& p) { return pol(p) == z; });
+    default:
+        return suzit(blok, vibor, n, [&](const ProstoyPrognoz& p) { return pol(p) != z; });
+    }
+}
+
+size_t Filtr::otobrat(size_t nomer, const ProstoyPrognoz* blok, uint32_t* vibor, size_t n,
+    std::pmr::vector<std::pmr::vector<uint32_t>>& bufer, size_t uroven) const {
+
+    const Uzel& uzel = uzli[nomer];
+    switch (uzel.vid) {
+    case Vid::Vse:
+        return n;
+
+    case Vid::Sravnenie: {
+        double z = uzel.znachenie;
+        Operaciya op = uzel.operaciya;
+        switch (uzel.pole) {
+        case Pole::Utro: return suzitSravneniem(blok, vibor, n, [](const ProstoyPrognoz& p) { return p.getMorningTemp(); }, op, z);
+        case Pole::Den: return suzitSravneniem(blok, vibor, n, [](const ProstoyPrognoz& p) { return p.getDayTemp(); }, op, z);
+        case Pole::Vecher: return suzitSravneniem(blok, vibor, n, [](const ProstoyPrognoz& p) { return p.getEveningTemp(); }, op, z);
+        case Pole::Osadki: return suzitSravneniem(blok, vibor, n, [](const ProstoyPrognoz& p) { return p.getOsadki(); }, op, z);
+        default: return suzitSravneniem(blok, vibor, n, [](const ProstoyPrognoz& p) { return p.getAverageTemp(); }, op, z);
+        }
+    }
+
+    case Vid::Statusi: {
+        uint32_t maska = uzel.maskaStatusov;
+        return suzit(blok, vibor, n, [maska](const ProstoyPrognoz& p) {
+            int kod = ProstoyPrognoz::kodStatusa(p.getStatus());
+            return kod >= 0 && ((maska >> kod) & 1u);
+        });
+    }
+
+    case Vid::Daty: {
+        long long ot = uzel.ot;
+        long long po = uzel.po;
+        return suzit(blok, vibor, n, [ot, po](const ProstoyPrognoz& p) {
+            return (p.getDate() >= ot) & (p.getDate() <= po);
+        });
+    }
+
+    case Vid::Oshibka: {
+        // Выбранные прогнозы раскладываются по столбцам и проверяются пакетным ядром
+        Yadra::Kolonki kolonki;
+        uint64_t maska[Yadra::SLOV_MASKI];
+        kolonki.zapolnit(blok, vibor, n);
+        Yadra::maskaOshibok(kolonki, maska);
+        size_t m = 0;
+        for (size_t i = 0; i < n; i++) {
+            vibor[m] = vibor[i];
+            m += (maska[i / 64] >> (i % 64)) & 1;
+        }
+        return m;
+    }
+
+    case Vid::I:
+        for (size_t d : uzel.deti) {
+            if (n == 0) break;
+            n = otobrat(d, blok, vibor, n, bufer, uroven + 1);
+        }
+        return n;
+
+    default: {
+        // "Или" и "не": дети проверяются на копии вектора, подходящие номера отмечаются флагами.
+        // bufer[uroven]: [0, B) - копия входа, [B, 2B) - рабочий вектор, [2B, 3B) - флаги по номеру в блоке
+        uint32_t* ishod = bufer[uroven].data();
+        uint32_t* rabochiy = ishod + RAZMER_BLOKA;
+        uint32_t* flagi = ishod + 2 * RAZMER_BLOKA;
+
+        for (size_t i = 0; i < n; i++) {
+            ishod[i] = vibor[i];
+            flagi[vibor[i]] = 0;
+        }
+
+        for (size_t d : uzel.deti) {
+            // Для "или" следующий ребенок проверяет только еще не отмеченные номера
+            size_t m = 0;
+            for (size_t i = 0; i < n; i++) {
+                rabochiy[m] = ishod[i];
+                m += flagi[ishod[i]] ? 0 : 1;
+            }
+            if (m == 0) break;
+
+            m = otobrat(d, blok, rabochiy, m, bufer, uroven + 1);
+            for (size_t i = 0; i < m; i++) {
+                flagi[rabochiy[i]] = 1;
+            }
+        }
+
+        uint32_t nuzhniy = (uzel.vid == Vid::Ili) ? 1 : 0;
+        size_t m = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint32_t j = ishod[i];
+            vibor[m] = j;
+            m += (flagi[j] == nuzhniy) ? 1 : 0;
+        }
+        return m;
+    }
+    }
+}
+
+size_t Filtr::otobratBlok(const ProstoyPrognoz* blok, size_t razmer, uint32_t* vibor, std::pmr::vector<std::pmr::vector<uint32_t>>& bufer) const {
+    if (razmer > RAZMER_BLOKA) throw std::invalid_argument("Block is too large");
+
+    size_t g = glubina(koren);
+    if (bufer.size() < g) {
+        bufer.resize(g);
+    }
+    for (std::pmr::vector<uint32_t>& b : bufer) {
+        if (b.size() < 3 * RAZMER_BLOKA) b.resize(3 * RAZMER_BLOKA);
+    }
+
+    for (size_t i = 0; i < razmer; i++) {
+        vibor[i] = (uint32_t)i;
+    }
+    return otobrat(koren, blok, vibor, razmer, bufer, 0);
+}
+
+bool Filtr::proverit(size_t nomer, const ProstoyPrognoz& p) const {
+    const Uzel& uzel = uzli[nomer];
+    switch (uzel.vid) {
+    case Vid::Vse:
+        return true;
+    case Vid::Sravnenie:
+        return sravnit(znacheniePolya(p, uzel.pole), uzel.operaciya, uzel.znachenie);
+    case Vid::Statusi: {
+        int kod = ProstoyPrognoz::kodStatusa(p.getStatus());
+        return kod >= 0 && ((uzel.maskaStatusov >> kod) & 1u);
+    }
+    case Vid::Daty:
+        return p.getDate() >= uzel.ot && p.getDate() <= uzel.po;
+    case Vid::Oshibka:
+        return p.oshibka();
+    case Vid::I:
+        for (size_t d : uzel.deti) {
+            if (!proverit(d, p)) return false;
+        }
+        return true;
+    case Vid::Ili:
+        for (size_t d : uzel.deti) {
+            if (proverit(d, p)) return true;
+        }
+        return false;
+    default:
+        return !proverit(uzel.deti[0], p);
+    }
+}
+
+bool Filtr::proverit(const ProstoyPrognoz& p) const {
+    return proverit(koren, p);
+}
+
+bool Filtr::mozhetPodoyti(size_t nomer, const ZonnayaKarta::Zona& zona) const {
+    const Uzel& uzel = uzli[nomer];
+    switch (uzel.vid) {
+    case Vid::Sravnenie: {
+        double mn = zona.min[(int)uzel.pole];
+        double mx = zona.max[(int)uzel.pole];
+        double z = uzel.znachenie;
+        //NaN в блоке уже расширил промежуток до (-inf, +inf), а сравнение с NaN-значением ложно для всех
+        switch (uzel.operaciya) {
+        case Operaciya::Menshe: return mn < z;
+        case Operaciya::MensheIliRavno: return mn <= z;
+        case Operaciya::Bolshe: return mx > z;
+        case Operaciya::BolsheIliRavno: return mx >= z;
+        case Operaciya::Ravno: return mn <= z && z <= mx;
+        default: return !(mn == z && mx == z);
+        }
+    }
+    case Vid::Daty:
+        return zona.maxDate >= uzel.ot && zona.minDate <= uzel.po;
+    case Vid::I:
+        for (size_t d : uzel.deti) {
+            if (!mozhetPodoyti(d, zona)) return false;
+        }
+        return true;
+    case Vid::Ili:
+        for (size_t d : uzel.deti) {
+            if (mozhetPodoyti(d, zona)) return true;
+        }
+        return false;
+    default:
+        //Vse, Statusi, Oshibka и отрицание по промежуткам не оцениваются
+        return true;
+    }
+}
+
+bool Filtr::mozhetPodoyti(const ZonnayaKarta::Zona& zona) const {
+    return zona.kolvo > 0 && mozhetPodoyti(koren, zona);
+}
@@ -0,0 +1,238 @@
+﻿#pragma once
+#include "Prostoy.h"
+#include "ZonnayaKarta.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Составное условие отбора прогнозов (фильтр).
+ * * Собирается из простых условий (сравнение поля, статус из набора, промежуток дат)
+ * операторами &&, || и !. Проверяет прогнозы не по одному, а блоками: для блока ведется
+ * вектор выбора (номера прогнозов, еще проходящих условие), и каждое условие одним
+ * циклом без ветвлений сужает его. Для "и" условия применяются по очереди к уже суженному
+ * вектору, поэтому дешевые и избирательные условия стоит ставить первыми.
+ * При сборке фильтр вычисляет общие границы дат, по которым SlozhniyPrognoz может
+ * пропустить часть отсортированного массива, а по зонам (ZonnayaKarta) - целые блоки,
+ * в которых условие заведомо не выполняется.
+ */
+class Filtr
+{
+public:
+
+    /// @brief Поле прогноза для сравнения.
+    enum class Pole {
+        /// @brief Утренняя температура.
+        Utro,
+        /// @brief Дневная температура.
+        Den,
+        /// @brief Вечерняя температура.
+        Vecher,
+        /// @brief Средняя температура (getAverageTemp).
+        SrednyayaTemp,
+        /// @brief Осадки.
+        Osadki
+    };
+
+    /// @brief Операция сравнения "поле ? значение".
+    enum class Operaciya {
+        /// @brief Поле меньше значения.
+        Menshe,
+        /// @brief Поле меньше или равно значению.
+        MensheIliRavno,
+        /// @brief Поле больше значения.
+        Bolshe,
+        /// @brief Поле больше или равно значению.
+        BolsheIliRavno,
+        /// @brief Поле равно значению.
+        Ravno,
+        /// @brief Поле не равно значению (для значения NaN выполняется всегда).
+        NeRavno
+    };
+
+    /// @brief Сколько прогнозов проверяется за один блок.
+    static constexpr size_t RAZMER_BLOKA = 1024;
+
+private:
+
+    /// @brief Вид узла дерева условий.
+    enum class Vid {
+        /// @brief Подходит любой прогноз.
+        Vse,
+        /// @brief Сравнение поля со значением.
+        Sravnenie,
+        /// @brief Статус из набора.
+        Statusi,
+        /// @brief Дата в промежутке.
+        Daty,
+        /// @brief Ошибочный прогноз (oshibka()).
+        Oshibka,
+        /// @brief Все дети выполняются.
+        I,
+        /// @brief Выполняется хотя бы один ребенок.
+        Ili,
+        /// @brief Отрицание единственного ребенка.
+        Ne
+    };
+
+    /// @brief Узел дерева условий. Узлы хранятся в одном массиве, дети - по номерам.
+    struct Uzel {
+        Vid vid = Vid::Vse;
+        Pole pole = Pole::SrednyayaTemp;
+        Operaciya operaciya = Operaciya::Menshe;
+        double znachenie = 0.0;
+        /// @brief Промежуток дат (оба конца включительно) для Vid::Daty.
+        long long ot = 0, po = 0;
+        /// @brief Бит i установлен, если подходит статус с номером ProstoyPrognoz::kodStatusa == i.
+        uint32_t maskaStatusov = 0;
+        /// @brief Дети узлов I, Ili и Ne.
+        std::vector<size_t> deti;
+    };
+
+    /// @brief Узлы дерева.
+    std::vector<Uzel> uzli;
+
+    /// @brief Номер корневого узла.
+    size_t koren;
+
+    /// @brief Границы дат, вне которых условие заведомо не выполняется (оба конца включительно).
+    long long nizhnyayaData, verhnyayaData;
+
+    /// @brief Создает фильтр из одного узла.
+    explicit Filtr(const Uzel& uzel);
+
+    /**
+     * @brief Объединяет два фильтра узлом "и" / "или". Вложенные узлы того же вида разворачиваются.
+     * @param vid Vid::I или Vid::Ili.
+     * @param a Первый фильтр.
+     * @param b Второй фильтр.
+     * @return Новый фильтр.
+     */
+    static Filtr soedinit(Vid vid, const Filtr& a, const Filtr& b);
+
+    /**
+     * @brief Копирует поддерево другого фильтра в конец массива узлов.
+     * @param other Фильтр.
+     * @param uzel Номер узла в other.
+     * @return Номер скопированного узла.
+     */
+    size_t skopirovat(const Filtr& other, size_t uzel);
+
+    /**
+     * @brief Сужает вектор выбора условием узла.
+     * @param uzel Номер узла.
+     * @param blok Начало блока прогнозов.
+     * @param vibor Номера прогнозов блока (по возрастанию), проходящих предыдущие условия.
+     * @param n Количество номеров в vibor.
+     * @param bufer Временная память для узлов "или" / "не" (по одному массиву на уровень вложенности).
+     * @param uroven Уровень вложенности узла.
+     * @return Сколько номеров осталось (они записаны в начало vibor по возрастанию).
+     */
+    size_t otobrat(size_t uzel, const ProstoyPrognoz* blok, uint32_t* vibor, size_t n,
+        std::pmr::vector<std::pmr::vector<uint32_t>>& bufer, size_t uroven) const;
+
+    /**
+     * @brief Глубина поддерева (для выделения временной памяти).
+     * @param uzel Номер узла.
+     * @return 1 для простого условия, иначе 1 + наибольшая глубина детей.
+     */
+    size_t glubina(size_t uzel) const;
+
+    /**
+     * @brief Проверяет условие узла для одного прогноза.
+     * @param uzel Номер узла.
+     * @param p Прогноз.
+     * @return true, если условие выполняется.
+     */
+    bool proverit(size_t uzel, const ProstoyPrognoz& p) const;
+
+    /**
+     * @brief Проверяет, может ли условие узла выполняться в блоке с данной зоной.
+     * @param uzel Номер узла.
+     * @param zona Зона блока.
+     * @return false, если ни один прогноз блока заведомо не подходит.
+     */
+    bool mozhetPodoyti(size_t uzel, const ZonnayaKarta::Zona& zona) const;
+
+public:
+
+    /// @brief Фильтр, которому удовлетворяет любой прогноз.
+    Filtr();
+
+    /**
+     * @brief Сравнение поля с числом, например sravnenie(Pole::Vecher, Operaciya::Menshe, 5.0).
+     * @param pole Поле.
+     * @param operaciya Операция.
+     * @param znachenie Значение.
+     * @return Фильтр.
+     */
+    static Filtr sravnenie(Pole pole, Operaciya operaciya, double znachenie);
+
+    /**
+     * @brief Статус прогноза входит в набор.
+     * @param statusi Статусы (например {"Rain", "Snow"}).
+     * @return Фильтр.
+     * @throws std::out_of_range Если какой-то статус неизвестен.
+     */
+    static Filtr statusi(std::initializer_list<std::string> statusi);
+
+    /**
+     * @brief Дата прогноза в промежутке.
+     * @param dateStart Начало (включительно).
+     * @param dateEnd Конец (включительно).
+     * @return Фильтр.
+     */
+    static Filtr daty(long long dateStart, long long dateEnd);
+
+    /// @brief Прогноз ошибочный (ProstoyPrognoz::oshibka).
+    static Filtr oshibochnie();
+
+    /// @brief Оба условия.
+    Filtr operator && (const Filtr& other) const;
+
+    /// @brief Хотя бы одно из условий.
+    Filtr operator || (const Filtr& other) const;
+
+    /// @brief Отрицание условия.
+    Filtr operator ! () const;
+
+    /// @brief Нижняя граница дат, при которых условие может выполняться.
+    long long nizhnyaya() const {
+        return nizhnyayaData;
+    }
+
+    /// @brief Верхняя граница дат, при которых условие может выполняться.
+    long long verhnyaya() const {
+        return verhnyayaData;
+    }
+
+    /**
+     * @brief Проверяет условие для одного прогноза.
+     * @param p Прогноз.
+     * @return true, если прогноз подходит.
+     */
+    bool proverit(const ProstoyPrognoz& p) const;
+
+    /**
+     * @brief Проверяет по зоне блока, стоит ли читать его прогнозы.
+     * Оценка осторожная: true не гарантирует, что подходящие прогнозы есть,
+     * а false гарантирует, что их нет. Статусы и признак ошибки зоной не отсекаются.
+     * @param zona Зона блока (см. ZonnayaKarta).
+     * @return false, если блок можно пропустить.
+     */
+    bool mozhetPodoyti(const ZonnayaKarta::Zona& zona) const;
+
+    /**
+     * @brief Проверяет блок подряд идущих прогнозов.
+     * @param blok Начало блока.
+     * @param razmer Размер блока (не больше RAZMER_BLOKA).
+     * @param vibor Сюда записываются номера подходящих прогнозов (от начала блока, по возрастанию);
+     * массив должен вмещать razmer элементов.
+     * @param bufer Временная память, переиспользуемая между блоками (может быть выделена в арене запроса).
+     * @return Количество подходящих прогнозов.
+     */
+    size_t otobratBlok(const ProstoyPrognoz* blok, size_t razmer, uint32_t* vibor, std::pmr::vector<std::pmr::vector<uint32_t>>& bufer) const;
+};
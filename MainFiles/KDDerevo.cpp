@@ -0,0 +1,191 @@
+﻿#include "KDDerevo.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static constexpr double GRADUS = 3.14159265358979323846 / 180.0;
+
+void KDDerevo::vVektor(double shirota, double dolgota, double xyz[3]) {
+    double f = shirota * GRADUS;
+    double l = dolgota * GRADUS;
+    xyz[0] = std::cos(f) * std::cos(l);
+    xyz[1] = std::cos(f) * std::sin(l);
+    xyz[2] = std::sin(f);
+}
+
+//Расстояние по большому кругу через длину хорды
+static double izHordi(double horda2) {
+    double horda = std::sqrt(horda2);
+    return 2.0 * KDDerevo::RADIUS_ZEMLI * std::asin(std::min(1.0, horda / 2.0));
+}
+
+double KDDerevo::rasstoyanie(double shirota1, double dolgota1, double shirota2, double dolgota2) {
+    double a[3], b[3];
+    vVektor(shirota1, dolgota1, a);
+    vVektor(shirota2, dolgota2, b);
+    double horda2 = 0.0;
+    for (int i = 0; i < 3; i++) {
+        horda2 += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return izHordi(horda2);
+}
+
+KDDerevo::KDDerevo(const std::vector<Tochka>& tochki) {
+    uzli.resize(tochki.size());
+    for (size_t i = 0; i < tochki.size(); i++) {
+        const Tochka& t = tochki[i];
+        if (!(t.shirota >= -90.0 && t.shirota <= 90.0 && t.dolgota >= -180.0 && t.dolgota <= 180.0)) {
+            throw std::invalid_argument("Coordinates out of range");
+        }
+        uzli[i].tochka = t;
+        vVektor(t.shirota, t.dolgota, uzli[i].xyz);
+    }
+    postroitPoddrevo(0, uzli.size());
+}
+
+void KDDerevo::postroitPoddrevo(size_t l, size_t r) {
+    if (l >= r) return;
+
+    double minXyz[3], maxXyz[3];
+    double minShirota = 90.0, maxShirota = -90.0, minDolgota = 180.0, maxDolgota = -180.0;
+    for (int o = 0; o < 3; o++) {
+        minXyz[o] = 2.0;
+        maxXyz[o] = -2.0;
+    }
+    for (size_t i = l; i < r; i++) {
+        for (int o = 0; o < 3; o++) {
+            minXyz[o] = std::min(minXyz[o], uzli[i].xyz[o]);
+            maxXyz[o] = std::max(maxXyz[o], uzli[i].xyz[o]);
+        }
+        minShirota = std::min(minShirota, uzli[i].tochka.shirota);
+        maxShirota = std::max(maxShirota, uzli[i].tochka.shirota);
+        minDolgota = std::min(minDolgota, uzli[i].tochka.dolgota);
+        maxDolgota = std::max(maxDolgota, uzli[i].tochka.dolgota);
+    }
+
+    int os = 0;
+    for (int o = 1; o < 3; o++) {
+        if (maxXyz[o] - minXyz[o] > maxXyz[os] - minXyz[os]) os = o;
+    }
+
+    size_t m = l + (r - l) / 2;
+    std::nth_element(uzli.begin() + l, uzli.begin() + m, uzli.begin() + r,
+        [os](const Uzel& a, const Uzel& b) {
+            return a.xyz[os] < b.xyz[os];
+        });
+
+    Uzel& uzel = uzli[m];
+    uzel.os = os;
+    for (int o = 0; o < 3; o++) {
+        uzel.minXyz[o] = minXyz[o];
+        uzel.maxXyz[o] = maxXyz[o];
+    }
+    uzel.minShirota = minShirota;
+    uzel.maxShirota = maxShirota;
+    uzel.minDolgota = minDolgota;
+    uzel.maxDolgota = maxDolgota;
+
+    postroitPoddrevo(l, m);
+    postroitPoddrevo(m + 1, r);
+}
+
+void KDDerevo::iskatBlizhayshie(size_t l, size_t r, const double q[3], size_t k, std::vector<std::pair<double, size_t>>& kucha) const {
+    if (l >= r) return;
+
+    size_t m = l + (r - l) / 2;
+    const Uzel& uzel = uzli[m];
+
+    // Нижняя оценка расстояния до любой точки поддерева - расстояние до его прямоугольника
+    if (kucha.size() == k) {
+        double dBox = 0.0;
+        for (int o = 0; o < 3; o++) {
+            double d = std::max({ 0.0, uzel.minXyz[o] - q[o], q[o] - uzel.maxXyz[o] });
+            dBox += d * d;
+        }
+        if (dBox >= kucha.front().first) return;
+    }
+
+    double d2 = 0.0;
+    for (int o = 0; o < 3; o++) {
+        d2 += (uzel.xyz[o] - q[o]) * (uzel.xyz[o] - q[o]);
+    }
+    if (kucha.size() < k) {
+        kucha.push_back({ d2, m });
+        std::push_heap(kucha.begin(), kucha.end());
+    }
+    else if (d2 < kucha.front().first) {
+        std::pop_heap(kucha.begin(), kucha.end());
+        kucha.back() = { d2, m };
+        std::push_heap(kucha.begin(), kucha.end());
+    }
+
+    // Сначала половина, в которую попадает искомая точка
+    if (q[uzel.os] < uzel.xyz[uzel.os]) {
+        iskatBlizhayshie(l, m, q, k, kucha);
+        iskatBlizhayshie(m + 1, r, q, k, kucha);
+    }
+    else {
+        iskatBlizhayshie(m + 1, r, q, k, kucha);
+        iskatBlizhayshie(l, m, q, k, kucha);
+    }
+}
+
+std::vector<KDDerevo::Sosed> KDDerevo::blizhayshie(double shirota, double dolgota, size_t k) const {
+    std::vector<Sosed> rezultat;
+    if (k == 0 || uzli.empty()) return rezultat;
+
+    double q[3];
+    vVektor(shirota, dolgota, q);
+
+    std::vector<std::pair<double, size_t>> kucha;
+    kucha.reserve(std::min(k, uzli.size()));
+    iskatBlizhayshie(0, uzli.size(), q, k, kucha);
+
+    std::sort_heap(kucha.begin(), kucha.end());
+    for (const auto& para : kucha) {
+        rezultat.push_back(Sosed{ uzli[para.second].tochka.nomer, izHordi(para.first) });
+    }
+    return rezultat;
+}
+
+void KDDerevo::iskatVPryamougolnike(size_t l, size_t r, double minShirota, double maxShirota,
+    double minDolgota, double maxDolgota, std::vector<size_t>& rezultat) const {
+
+    if (l >= r) return;
+
+    size_t m = l + (r - l) / 2;
+    const Uzel& uzel = uzli[m];
+
+    if (uzel.maxShirota < minShirota || uzel.minShirota > maxShirota ||
+        uzel.maxDolgota < minDolgota || uzel.minDolgota > maxDolgota) {
+        return;
+    }
+
+    // Поддерево целиком внутри - забираем без проверок
+    if (uzel.minShirota >= minShirota && uzel.maxShirota <= maxShirota &&
+        uzel.minDolgota >= minDolgota && uzel.maxDolgota <= maxDolgota) {
+        for (size_t i = l; i < r; i++) {
+            rezultat.push_back(uzli[i].tochka.nomer);
+        }
+        return;
+    }
+
+    const Tochka& t = uzel.tochka;
+    if (t.shirota >= minShirota && t.shirota <= maxShirota && t.dolgota >= minDolgota && t.dolgota <= maxDolgota) {
+        rezultat.push_back(t.nomer);
+    }
+    iskatVPryamougolnike(l, m, minShirota, maxShirota, minDolgota, maxDolgota, rezultat);
+    iskatVPryamougolnike(m + 1, r, minShirota, maxShirota, minDolgota, maxDolgota, rezultat);
+}
+
+std::vector<size_t> KDDerevo::vPryamougolnike(double minShirota, double maxShirota, double minDolgota, double maxDolgota) const {
+    std::vector<size_t> rezultat;
+    if (minDolgota <= maxDolgota) {
+        iskatVPryamougolnike(0, uzli.size(), minShirota, maxShirota, minDolgota, maxDolgota, rezultat);
+    }
+    else {
+        iskatVPryamougolnike(0, uzli.size(), minShirota, maxShirota, minDolgota, 180.0, rezultat);
+        iskatVPryamougolnike(0, uzli.size(), minShirota, maxShirota, -180.0, maxDolgota, rezultat);
+    }
+    return rezultat;
+}
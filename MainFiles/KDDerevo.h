@@ -0,0 +1,139 @@
+﻿#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Пространственный индекс точек на сфере (k-d дерево).
+ * * Точка (широта, долгота) переводится в единичный вектор (x, y, z), поэтому
+ * расстояние не ломается на линии перемены дат и у полюсов: хорда монотонна
+ * по расстоянию по большому кругу. Дерево неявное: узел поддерева [l, r) хранится
+ * в позиции (l + r) / 2, дети - в левой и правой половинах. Каждый узел хранит
+ * ограничивающий прямоугольник поддерева в (x, y, z) для отсечения при поиске
+ * ближайших и в широте / долготе для запросов по прямоугольнику.
+ */
+class KDDerevo
+{
+public:
+
+    /// @brief Средний радиус Земли в километрах.
+    static constexpr double RADIUS_ZEMLI = 6371.0;
+
+    /// @brief Точка для построения дерева.
+    struct Tochka {
+        /// @brief Широта в градусах [-90, 90].
+        double shirota = 0.0;
+        /// @brief Долгота в градусах [-180, 180].
+        double dolgota = 0.0;
+        /// @brief Номер точки у вызывающего (например номер станции).
+        size_t nomer = 0;
+    };
+
+    /// @brief Результат поиска ближайших.
+    struct Sosed {
+        /// @brief Номер точки.
+        size_t nomer = 0;
+        /// @brief Расстояние по большому кругу в километрах.
+        double rasstoyanie = 0.0;
+    };
+
+private:
+
+    /// @brief Узел дерева: точка и границы ее поддерева.
+    struct Uzel {
+        /// @brief Точка в виде единичного вектора.
+        double xyz[3] = {};
+        /// @brief Исходные координаты точки.
+        Tochka tochka;
+        /// @brief Ось разбиения (0, 1, 2).
+        int os = 0;
+        /// @brief Границы поддерева по осям x, y, z.
+        double minXyz[3] = {}, maxXyz[3] = {};
+        /// @brief Границы поддерева по широте и долготе.
+        double minShirota = 0.0, maxShirota = 0.0, minDolgota = 0.0, maxDolgota = 0.0;
+    };
+
+    /// @brief Узлы неявного дерева.
+    std::vector<Uzel> uzli;
+
+    /**
+     * @brief Строит поддерево на отрезке [l, r): выбирает ось с наибольшим разбросом и медиану.
+     * @param l Начало отрезка.
+     * @param r Конец отрезка (не включительно).
+     */
+    void postroitPoddrevo(size_t l, size_t r);
+
+    /**
+     * @brief Рекурсивный поиск k ближайших.
+     * @param l Начало отрезка поддерева.
+     * @param r Конец отрезка поддерева.
+     * @param q Искомая точка (единичный вектор).
+     * @param k Сколько точек найти.
+     * @param kucha Куча (квадрат хорды, позиция узла) с наибольшим расстоянием на вершине.
+     */
+    void iskatBlizhayshie(size_t l, size_t r, const double q[3], size_t k, std::vector<std::pair<double, size_t>>& kucha) const;
+
+    /**
+     * @brief Рекурсивный поиск точек в прямоугольнике широт и долгот (без перехода через 180-й меридиан).
+     * @param l Начало отрезка поддерева.
+     * @param r Конец отрезка поддерева.
+     * @param minShirota Южная граница.
+     * @param maxShirota Северная граница.
+     * @param minDolgota Западная граница.
+     * @param maxDolgota Восточная граница.
+     * @param rezultat Сюда дописываются номера найденных точек.
+     */
+    void iskatVPryamougolnike(size_t l, size_t r, double minShirota, double maxShirota,
+        double minDolgota, double maxDolgota, std::vector<size_t>& rezultat) const;
+
+public:
+
+    /// @brief Конструктор пустого дерева.
+    KDDerevo() = default;
+
+    /**
+     * @brief Строит дерево по точкам за O(n log n).
+     * @param tochki Точки.
+     * @throws std::invalid_argument Если координаты точки вне допустимых пределов.
+     */
+    explicit KDDerevo(const std::vector<Tochka>& tochki);
+
+    /// @brief Возвращает количество точек.
+    size_t size() const {
+        return uzli.size();
+    }
+
+    /**
+     * @brief Переводит широту и долготу в единичный вектор.
+     * @param shirota Широта в градусах.
+     * @param dolgota Долгота в градусах.
+     * @param xyz Сюда записывается вектор.
+     */
+    static void vVektor(double shirota, double dolgota, double xyz[3]);
+
+    /**
+     * @brief Расстояние по большому кругу между двумя точками.
+     * @return Расстояние в километрах.
+     */
+    static double rasstoyanie(double shirota1, double dolgota1, double shirota2, double dolgota2);
+
+    /**
+     * @brief Находит k ближайших точек. O(log n + k) в среднем.
+     * @param shirota Широта искомой точки.
+     * @param dolgota Долгота искомой точки.
+     * @param k Сколько точек найти.
+     * @return Точки по возрастанию расстояния (меньше k, если точек мало).
+     */
+    std::vector<Sosed> blizhayshie(double shirota, double dolgota, size_t k) const;
+
+    /**
+     * @brief Находит точки в прямоугольнике широт и долгот (границы включительно).
+     * Если minDolgota > maxDolgota, прямоугольник проходит через 180-й меридиан.
+     * @param minShirota Южная граница.
+     * @param maxShirota Северная граница.
+     * @param minDolgota Западная граница.
+     * @param maxDolgota Восточная граница.
+     * @return Номера точек (в порядке дерева).
+     */
+    std::vector<size_t> vPryamougolnike(double minShirota, double maxShirota, double minDolgota, double maxDolgota) const;
+};
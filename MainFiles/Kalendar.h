@@ -0,0 +1,202 @@
+﻿#pragma once
+
+/**
+ * @brief Григорианский календарь на целочисленной арифметике.
+ * * Переводит Unix timestamp в номер дня, дату (год, месяц, день) и обратно
+ * без вызова localtime/mktime: все функции constexpr, не используют глобальное
+ * состояние и поэтому потокобезопасны. Время считается в UTC, смещение часового
+ * пояса (в секундах, например +3 часа = 10800) задается явно.
+ * Формулы days_from_civil / civil_from_days (Howard Hinnant), эра = 400 лет.
+ */
+class Kalendar
+{
+public:
+
+    /// @brief Количество секунд в сутках.
+    static constexpr long long SEKUND_V_SUTKAH = 86400;
+
+    /// @brief Календарная дата.
+    struct Data {
+        /// @brief Год (может быть отрицательным).
+        long long god;
+        /// @brief Месяц от 1 до 12.
+        int mesyats;
+        /// @brief День месяца от 1 до 31.
+        int den;
+    };
+
+    /**
+     * @brief Целочисленное деление с округлением вниз (в отличие от / для отрицательных чисел).
+     * @param a Делимое.
+     * @param b Делитель (больше 0).
+     * @return floor(a / b).
+     */
+    static constexpr long long delenieVniz(long long a, long long b) {
+        return (a >= 0) ? a / b : -((-a + b - 1) / b);
+    }
+
+    /**
+     * @brief Номер дня от 1970-01-01 для календарной даты.
+     * @param god Год.
+     * @param mesyats Месяц (1..12).
+     * @param den День месяца (1..31).
+     * @return Количество дней от 1970-01-01 (отрицательное для более ранних дат).
+     */
+    static constexpr long long daysFromCivil(long long god, int mesyats, int den) {
+        god -= (mesyats <= 2) ? 1 : 0;
+        long long era = delenieVniz(god, 400);
+        long long yoe = god - era * 400;                                      // [0, 399]
+        long long doy = (153 * (mesyats > 2 ? mesyats - 3 : mesyats + 9) + 2) / 5 + den - 1; // [0, 365]
+        long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                // [0, 146096]
+        return era * 146097 + doe - 719468;
+    }
+
+    /**
+     * @brief Календарная дата по номеру дня от 1970-01-01.
+     * @param dni Номер дня.
+     * @return Дата (год, месяц, день).
+     */
+    static constexpr Data civilFromDays(long long dni) {
+        dni += 719468;
+        long long era = delenieVniz(dni, 146097);
+        long long doe = dni - era * 146097;                                   // [0, 146096]
+        long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+        long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);              // [0, 365]
+        long long mp = (5 * doy + 2) / 153;                                   // [0, 11]
+        int den = (int)(doy - (153 * mp + 2) / 5 + 1);
+        int mesyats = (int)(mp < 10 ? mp + 3 : mp - 9);
+        long long god = yoe + era * 400 + (mesyats <= 2 ? 1 : 0);
+        return Data{ god, mesyats, den };
+    }
+
+    /**
+     * @brief Номер дня (от 1970-01-01) для момента времени.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах (0 - UTC).
+     * @return Номер местного дня.
+     */
+    static constexpr long long denIzDati(long long date, long long smeshenie = 0) {
+        return delenieVniz(date + smeshenie, SEKUND_V_SUTKAH);
+    }
+
+    /**
+     * @brief Календарная дата для момента времени.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах (0 - UTC).
+     * @return Местная дата.
+     */
+    static constexpr Data dataIzDati(long long date, long long smeshenie = 0) {
+        return civilFromDays(denIzDati(date, smeshenie));
+    }
+
+    /**
+     * @brief Номер месяца "год * 12 + (месяц - 1)" - удобный ключ для группировки по месяцам.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах (0 - UTC).
+     * @return Ключ месяца.
+     */
+    static constexpr long long klyuchMesyatsa(long long date, long long smeshenie = 0) {
+        Data d = dataIzDati(date, smeshenie);
+        return d.god * 12 + (d.mesyats - 1);
+    }
+
+    /**
+     * @brief Момент начала месяца по ключу месяца.
+     * @param klyuch Ключ месяца (см. klyuchMesyatsa).
+     * @param smeshenie Смещение часового пояса в секундах (0 - UTC).
+     * @return Unix timestamp местной полуночи первого числа месяца.
+     */
+    static constexpr long long nachaloMesyatsa(long long klyuch, long long smeshenie = 0) {
+        long long god = delenieVniz(klyuch, 12);
+        int mesyats = (int)(klyuch - god * 12) + 1;
+        return daysFromCivil(god, mesyats, 1) * SEKUND_V_SUTKAH - smeshenie;
+    }
+
+    /**
+     * @brief Вычисляет границы месяца, в который попадает дата.
+     * @param date Любая дата внутри месяца (Unix timestamp).
+     * @param smeshenie Смещение часового пояса в секундах (0 - UTC).
+     * @param startMonth Сюда записывается начало месяца (включительно).
+     * @param endMonth Сюда записывается начало следующего месяца (не включительно).
+     */
+    static constexpr void granitsiMesyatsa(long long date, long long smeshenie, long long& startMonth, long long& endMonth) {
+        long long klyuch = klyuchMesyatsa(date, smeshenie);
+        startMonth = nachaloMesyatsa(klyuch, smeshenie);
+        endMonth = nachaloMesyatsa(klyuch + 1, smeshenie);
+    }
+
+    /**
+     * @brief День недели по номеру дня.
+     * @param dni Номер дня от 1970-01-01.
+     * @return 0 - понедельник, ..., 6 - воскресенье.
+     */
+    static constexpr int denNedeli(long long dni) {
+        return (int)(dni + 3 - delenieVniz(dni + 3, 7) * 7);  // 1970-01-01 - четверг
+    }
+
+    /**
+     * @brief Границы недели (с понедельника по воскресенье), в которую попадает дата.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах.
+     * @param start Сюда записывается начало недели (включительно).
+     * @param end Сюда записывается начало следующей недели (не включительно).
+     */
+    static constexpr void granitsiNedeli(long long date, long long smeshenie, long long& start, long long& end) {
+        long long den = denIzDati(date, smeshenie);
+        long long ponedelnik = den - denNedeli(den);
+        start = ponedelnik * SEKUND_V_SUTKAH - smeshenie;
+        end = (ponedelnik + 7) * SEKUND_V_SUTKAH - smeshenie;
+    }
+
+    /**
+     * @brief Границы декады (1-10, 11-20, 21-конец месяца), в которую попадает дата.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах.
+     * @param start Сюда записывается начало декады (включительно).
+     * @param end Сюда записывается начало следующей декады (не включительно).
+     */
+    static constexpr void granitsiDekady(long long date, long long smeshenie, long long& start, long long& end) {
+        Data d = dataIzDati(date, smeshenie);
+        int pervyyDen = (d.den <= 10) ? 1 : (d.den <= 20 ? 11 : 21);
+        start = daysFromCivil(d.god, d.mesyats, pervyyDen) * SEKUND_V_SUTKAH - smeshenie;
+        if (pervyyDen < 21) {
+            end = daysFromCivil(d.god, d.mesyats, pervyyDen + 10) * SEKUND_V_SUTKAH - smeshenie;
+        }
+        else {
+            end = nachaloMesyatsa(d.god * 12 + d.mesyats, smeshenie);
+        }
+    }
+
+    /**
+     * @brief Границы метеорологического сезона (декабрь-февраль, март-май, июнь-август, сентябрь-ноябрь).
+     * Декабрь относится к зиме следующего года.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах.
+     * @param start Сюда записывается начало сезона (включительно).
+     * @param end Сюда записывается начало следующего сезона (не включительно).
+     */
+    static constexpr void granitsiSezona(long long date, long long smeshenie, long long& start, long long& end) {
+        long long klyuch = klyuchMesyatsa(date, smeshenie);
+        long long pervyy = delenieVniz(klyuch + 1, 3) * 3 - 1;
+        start = nachaloMesyatsa(pervyy, smeshenie);
+        end = nachaloMesyatsa(pervyy + 3, smeshenie);
+    }
+
+    /**
+     * @brief Границы года, в который попадает дата.
+     * @param date Unix timestamp.
+     * @param smeshenie Смещение часового пояса в секундах.
+     * @param start Сюда записывается начало года (включительно).
+     * @param end Сюда записывается начало следующего года (не включительно).
+     */
+    static constexpr void granitsiGoda(long long date, long long smeshenie, long long& start, long long& end) {
+        long long god = dataIzDati(date, smeshenie).god;
+        start = nachaloMesyatsa(god * 12, smeshenie);
+        end = nachaloMesyatsa((god + 1) * 12, smeshenie);
+    }
+};
+
+static_assert(Kalendar::daysFromCivil(1970, 1, 1) == 0);
+static_assert(Kalendar::daysFromCivil(2000, 3, 1) == 11017);
+static_assert(Kalendar::civilFromDays(-1).god == 1969 && Kalendar::civilFromDays(-1).mesyats == 12);
+static_assert(Kalendar::denNedeli(0) == 3 && Kalendar::denNedeli(-4) == 6);
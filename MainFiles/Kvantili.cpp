@@ -0,0 +1,153 @@
+﻿#include "Kvantili.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+EskizKvantiley::EskizKvantiley(size_t k) :
+    k(k), razmer(0), maksRazmer(0), kolvo(0), minimum(0.0), maksimum(0.0),
+    sluchaynoe(0x9E3779B97F4A7C15ULL), keshGotov(false) {
+
+    if (k < 8) throw std::invalid_argument("Sketch parameter k must be at least 8");
+    dobavitUroven();
+}
+
+size_t EskizKvantiley::vmestimost(size_t h) const {
+    size_t glubina = urovni.size() - h - 1;
+    size_t v = (size_t)std::ceil(std::pow(2.0 / 3.0, (double)glubina) * (double)k) + 1;
+    return std::max<size_t>(v, 2);
+}
+
+void EskizKvantiley::dobavitUroven() {
+    urovni.emplace_back();
+    maksRazmer = 0;
+    for (size_t h = 0; h < urovni.size(); h++) {
+        maksRazmer += vmestimost(h);
+    }
+}
+
+bool EskizKvantiley::monetka() {
+    sluchaynoe ^= sluchaynoe << 13;
+    sluchaynoe ^= sluchaynoe >> 7;
+    sluchaynoe ^= sluchaynoe << 17;
+    return sluchaynoe & 1;
+}
+
+void EskizKvantiley::szhat() {
+    while (razmer >= maksRazmer) {
+        for (size_t h = 0; h < urovni.size(); h++) {
+            if (urovni[h].size() < vmestimost(h)) continue;
+            if (h + 1 == urovni.size()) {
+                dobavitUroven();
+            }
+
+            // Сортируем уровень и поднимаем каждое второе значение (с весом вдвое больше).
+            // При нечетном размере наименьшее значение остается на месте.
+            std::vector<double>& uroven = urovni[h];
+            std::sort(uroven.begin(), uroven.end());
+            size_t nachalo = uroven.size() % 2;
+            size_t sdvig = monetka() ? 1 : 0;
+            for (size_t i = nachalo + sdvig; i < uroven.size(); i += 2) {
+                urovni[h + 1].push_back(uroven[i]);
+            }
+            size_t podnyato = (uroven.size() - nachalo) / 2;
+            uroven.resize(nachalo);
+            razmer -= podnyato;
+
+            if (razmer < maksRazmer) break;
+        }
+    }
+}
+
+void EskizKvantiley::dobavit(double x) {
+    if (kolvo == 0) {
+        minimum = x;
+        maksimum = x;
+    }
+    else {
+        minimum = std::min(minimum, x);
+        maksimum = std::max(maksimum, x);
+    }
+    kolvo++;
+
+    urovni[0].push_back(x);
+    razmer++;
+    keshGotov = false;
+
+    if (razmer >= maksRazmer) {
+        szhat();
+    }
+}
+
+void EskizKvantiley::obedinit(const EskizKvantiley& other) {
+    if (other.kolvo == 0) return;
+
+    if (kolvo == 0) {
+        minimum = other.minimum;
+        maksimum = other.maksimum;
+    }
+    else {
+        minimum = std::min(minimum, other.minimum);
+        maksimum = std::max(maksimum, other.maksimum);
+    }
+    kolvo += other.kolvo;
+
+    while (urovni.size() < other.urovni.size()) {
+        dobavitUroven();
+    }
+    for (size_t h = 0; h < other.urovni.size(); h++) {
+        urovni[h].insert(urovni[h].end(), other.urovni[h].begin(), other.urovni[h].end());
+        razmer += other.urovni[h].size();
+    }
+    sluchaynoe ^= other.sluchaynoe;
+    if (sluchaynoe == 0) sluchaynoe = 0x9E3779B97F4A7C15ULL;
+    keshGotov = false;
+
+    szhat();
+}
+
+double EskizKvantiley::rang(double x) const {
+    if (kolvo == 0) return 0.0;
+
+    unsigned long long ves = 0;
+    for (size_t h = 0; h < urovni.size(); h++) {
+        for (double v : urovni[h]) {
+            if (v <= x) ves += 1ULL << h;
+        }
+    }
+    return (double)ves / (double)kolvo;
+}
+
+double EskizKvantiley::kvantil(double q) {
+    if (kolvo == 0) throw std::logic_error("Sketch is empty");
+    if (!(q >= 0.0 && q <= 1.0)) throw std::invalid_argument("Quantile must be in [0, 1]");
+
+    if (q == 0.0) return minimum;
+    if (q == 1.0) return maksimum;
+
+    if (!keshGotov) {
+        nakoplennie.clear();
+        nakoplennie.reserve(razmer);
+        for (size_t h = 0; h < urovni.size(); h++) {
+            for (double v : urovni[h]) {
+                nakoplennie.push_back({ v, 1ULL << h });
+            }
+        }
+        std::sort(nakoplennie.begin(), nakoplennie.end());
+        unsigned long long summa = 0;
+        for (auto& para : nakoplennie) {
+            summa += para.second;
+            para.second = summa;
+        }
+        keshGotov = true;
+    }
+
+    // Первое значение, накопленный вес которого достигает q * (общий вес)
+    unsigned long long obshiy = nakoplennie.back().second;
+    double cel = q * (double)obshiy;
+    auto it = std::lower_bound(nakoplennie.begin(), nakoplennie.end(), cel,
+        [](const std::pair<double, unsigned long long>& para, double c) {
+            return (double)para.second < c;
+        });
+    if (it == nakoplennie.end()) return maksimum;
+    return it->first;
+}
@@ -0,0 +1,121 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Приближенные квантили потока чисел (скетч KLL, Karnin-Lang-Liberty).
+ * * Хранит не все значения, а иерархию "компакторов": уровень h содержит значения
+ * с весом 2^h. Когда уровень переполняется, он сортируется и каждое второе значение
+ * (со случайным сдвигом) переходит на уровень выше. Объем памяти - около 3k чисел
+ * независимо от количества добавленных значений, ошибка ранга - порядка 1/k.
+ * Скетчи, построенные по частям данных (в разных потоках или по разным массивам),
+ * объединяются через obedinit(). Удаление значений не поддерживается.
+ */
+class EskizKvantiley
+{
+private:
+
+    /// @brief Параметр точности (вместимость верхнего уровня).
+    size_t k;
+
+    /// @brief Компакторы: значения уровня h имеют вес 2^h.
+    std::vector<std::vector<double>> urovni;
+
+    /// @brief Сколько значений хранится на всех уровнях.
+    size_t razmer;
+
+    /// @brief Суммарная вместимость уровней: при достижении запускается сжатие.
+    size_t maksRazmer;
+
+    /// @brief Сколько значений было добавлено всего.
+    unsigned long long kolvo;
+
+    /// @brief Точные минимум и максимум добавленных значений.
+    double minimum, maksimum;
+
+    /// @brief Состояние генератора случайных битов (детерминированного, чтобы результат повторялся).
+    uint64_t sluchaynoe;
+
+    /// @brief Отсортированные значения с нарастающим весом (строится при первом запросе kvantil,
+    /// по 16 байт на хранимое значение - примерно вдвое больше самих значений).
+    std::vector<std::pair<double, unsigned long long>> nakoplennie;
+
+    /// @brief Актуален ли массив nakoplennie.
+    bool keshGotov;
+
+    /**
+     * @brief Вместимость уровня: верхний уровень вмещает k, каждый нижний - в 2/3 от вышестоящего.
+     * @param h Номер уровня.
+     * @return Вместимость (не меньше 2).
+     */
+    size_t vmestimost(size_t h) const;
+
+    /// @brief Добавляет новый верхний уровень и пересчитывает maksRazmer.
+    void dobavitUroven();
+
+    /// @brief Сжимает переполненные уровни, пока razmer не станет меньше maksRazmer.
+    void szhat();
+
+    /// @brief Возвращает случайный бит (xorshift64).
+    bool monetka();
+
+public:
+
+    /// @brief Параметр точности по умолчанию: ошибка ранга около 1%, память около 5 КБ на значения
+    /// и еще около 10 КБ на кэш nakoplennie (пары значение-вес) после первого вызова kvantil.
+    static constexpr size_t K_PO_UMOLCHANIYU = 200;
+
+    /**
+     * @brief Создает пустой скетч.
+     * @param k Параметр точности (больше - точнее и больше памяти).
+     * @throws std::invalid_argument Если k меньше 8.
+     */
+    explicit EskizKvantiley(size_t k = K_PO_UMOLCHANIYU);
+
+    /// @brief Возвращает количество добавленных значений.
+    unsigned long long size() const {
+        return kolvo;
+    }
+
+    /// @brief Проверяет, добавлено ли хотя бы одно значение.
+    bool empty() const {
+        return kolvo == 0;
+    }
+
+    /// @brief Возвращает количество значений, которые хранятся в памяти.
+    size_t hranimih() const {
+        return razmer;
+    }
+
+    /**
+     * @brief Добавляет значение. Амортизированно O(log k).
+     * @param x Значение.
+     */
+    void dobavit(double x);
+
+    /**
+     * @brief Добавляет в скетч все значения другого скетча.
+     * Точность результата определяется параметром k текущего скетча.
+     * @param other Скетч, построенный по другой части данных.
+     */
+    void obedinit(const EskizKvantiley& other);
+
+    /**
+     * @brief Приближенная доля значений, не превосходящих x.
+     * @param x Значение.
+     * @return Число от 0 до 1 (0 для пустого скетча).
+     */
+    double rang(double x) const;
+
+    /**
+     * @brief Приближенный квантиль (например 0.5 - медиана, 0.95 - 95-й процентиль).
+     * Первый запрос после изменений сортирует хранимые значения, следующие - двоичный поиск.
+     * @param q Уровень квантиля от 0 до 1 (0 - точный минимум, 1 - точный максимум).
+     * @return Значение квантиля.
+     * @throws std::logic_error Если скетч пуст.
+     * @throws std::invalid_argument Если q вне [0, 1].
+     */
+    double kvantil(double q);
+};
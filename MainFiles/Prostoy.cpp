@@ -1,6 +1,7 @@
 ﻿#include "Prostoy.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
 
 ProstoyPrognoz::ProstoyPrognoz():      //Пустой конструктор
     date(0), tempMorning(0.0), tempDay(0.0), tempEvening(0.0), osadki(0.0), status("Sunny") {
@@ -51,14 +52,8 @@ void ProstoyPrognoz::setOsadki(double mm) {
     osadki = mm;
 }
 void ProstoyPrognoz::setStatus(std::string p) {
-    static const std::string perechen[4] = { "Sunny", "Cloudy", "Rain", "Snow" };
-    for (int i = 0; i < 4; i++) {
-        if (p == perechen[i]) {
-            status = p;
-            return;
-        }
-    }
-    throw std::out_of_range("Incorrect Status");
+    if (kodStatusa(p) < 0) throw std::out_of_range("Incorrect Status");
+    status = p;
 }
 
 //Методы (остальные)
@@ -184,18 +179,26 @@ std::istream& operator >> (std::istream& input, ProstoyPrognoz& vvod) {
 
 
 //Еще методы
-std::string ProstoyPrognoz::worstStatus(std::string stat1, std::string stat2) {
-    static const std::string perechen[4] = { "Sunny", "Cloudy", "Rain", "Snow" };
-    int znach1 = 0;
-    int znach2 = 0;
-    for (int i = 0; i < 4; i++) {
-        if (stat1 == perechen[i]) {
-            znach1 = i;
-        }
-        if (stat2 == perechen[i]) {
-            znach2 = i;
+static const std::string perechen[ProstoyPrognoz::KOLVO_STATUSOV] = { "Sunny", "Cloudy", "Rain", "Snow" };
+
+int ProstoyPrognoz::kodStatusa(const std::string& status) {
+    for (int i = 0; i < KOLVO_STATUSOV; i++) {
+        if (status == perechen[i]) {
+            return i;
         }
     }
+    return -1;
+}
+
+const std::string& ProstoyPrognoz::imyaStatusa(int kod) {
+    if (kod < 0 || kod >= KOLVO_STATUSOV) throw std::out_of_range("Incorrect Status");
+    return perechen[kod];
+}
+
+std::string ProstoyPrognoz::worstStatus(std::string stat1, std::string stat2) {
+    // Неизвестный статус считается таким же, как "Sunny"
+    int znach1 = std::max(kodStatusa(stat1), 0);
+    int znach2 = std::max(kodStatusa(stat2), 0);
 
     return (znach1 >= znach2) ? stat1 : stat2;
 
@@ -95,7 +95,7 @@ public:
     }
 
     /// @brief Возвращает статус погоды в виде строки.
-    std::string getStatus() const {
+    const std::string& getStatus() const {
         return status;
     }
 
@@ -166,6 +166,26 @@ public:
     bool oshibka() const;
 
 
+    /// @brief Количество известных погодных статусов.
+    static constexpr int KOLVO_STATUSOV = 4;
+
+    /**
+     * @brief Возвращает номер статуса в порядке от лучшего к худшему.
+     * Sunny = 0, Cloudy = 1, Rain = 2, Snow = 3 (тот же порядок, что и в worstStatus).
+     * @param status Статус в виде строки.
+     * @return Номер статуса или -1, если статус неизвестен.
+     */
+    static int kodStatusa(const std::string& status);
+
+    /**
+     * @brief Возвращает статус по его номеру.
+     * @param kod Номер статуса (от 0 до KOLVO_STATUSOV - 1).
+     * @return Статус в виде строки.
+     * @throws std::out_of_range Если номер неверен.
+     */
+    static const std::string& imyaStatusa(int kod);
+
+
  
 
 
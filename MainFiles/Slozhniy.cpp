@@ -1,19 +1,65 @@
 ﻿#include "Slozhniy.h"
+#include "Yadra.h"
 #include <utility>
 #include <iostream>
 #include <algorithm>
-#include <ctime>
+#include <bit>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Источник памяти по умолчанию вместо nullptr
+static std::pmr::memory_resource* iliObshiy(std::pmr::memory_resource* resurs) {
+    return (resurs != nullptr) ? resurs : std::pmr::get_default_resource();
+}
+
+ProstoyPrognoz* SlozhniyPrognoz::vydelit(size_t n) {
+    ProstoyPrognoz* p = (n <= VSTROENNAYA_EMKOST) ? vstroenniyMassiv()
+        : static_cast<ProstoyPrognoz*>(resurs->allocate(n * sizeof(ProstoyPrognoz), alignof(ProstoyPrognoz)));
+    std::uninitialized_default_construct_n(p, n);
+    return p;
+}
+
+void SlozhniyPrognoz::osvobodit(ProstoyPrognoz* p, size_t n) {
+    if (p == nullptr) return;
+    std::destroy_n(p, n);
+    if (p != vstroenniyMassiv()) {
+        resurs->deallocate(p, n * sizeof(ProstoyPrognoz), alignof(ProstoyPrognoz));
+    }
+}
+
+void SlozhniyPrognoz::zabratMassiv(SlozhniyPrognoz& other) noexcept {
+    capacity = other.capacity;
+    if (other.vstroen()) {
+        prognozi = vstroenniyMassiv();
+        std::uninitialized_move_n(other.prognozi, other.capacity, prognozi);
+        std::destroy_n(other.prognozi, other.capacity);
+    }
+    else {
+        prognozi = other.prognozi;
+    }
+    other.prognozi = nullptr;
+    other.capacity = 0;
+}
 
 void SlozhniyPrognoz::reserve(size_t newCapacity) {
     if (newCapacity <= capacity) return;
 
-    ProstoyPrognoz* newPrognozi = new ProstoyPrognoz[newCapacity];
+    // Во встроенном буфере массив растет на месте
+    if (vstroen() && newCapacity <= VSTROENNAYA_EMKOST) {
+        std::uninitialized_default_construct(prognozi + capacity, prognozi + newCapacity);
+        capacity = newCapacity;
+        return;
+    }
+
+    ProstoyPrognoz* newPrognozi = vydelit(newCapacity);
 
     for (size_t i = 0; i < count; i++) {
         newPrognozi[i] = std::move(prognozi[i]);
     }
 
-    delete[] prognozi;
+    osvobodit(prognozi, capacity);
 
     prognozi = newPrognozi;
     capacity = newCapacity;
@@ -26,11 +72,19 @@ SlozhniyPrognoz::SlozhniyPrognoz():
     sortedStatus(true) {
 }
 
-SlozhniyPrognoz::SlozhniyPrognoz(const ProstoyPrognoz* arr, size_t size):
-    count(size), capacity(size), sortedStatus(false) {
+SlozhniyPrognoz::SlozhniyPrognoz(std::pmr::memory_resource* resurs):
+    prognozi(nullptr),
+    count(0),
+    capacity(0),
+    sortedStatus(true),
+    resurs(iliObshiy(resurs)) {
+}
+
+SlozhniyPrognoz::SlozhniyPrognoz(const ProstoyPrognoz* arr, size_t size, std::pmr::memory_resource* resurs):
+    count(size), capacity(size), sortedStatus(false), resurs(iliObshiy(resurs)) {
 
     if (size > 0) {
-        prognozi = new ProstoyPrognoz[size];
+        prognozi = vydelit(size);
         std::copy_n(arr, size, prognozi);
     }
     else {
@@ -41,15 +95,17 @@ SlozhniyPrognoz::SlozhniyPrognoz(const ProstoyPrognoz* arr, size_t size):
 
 SlozhniyPrognoz::SlozhniyPrognoz(const ProstoyPrognoz& prognoz):
     count(1), capacity(1), sortedStatus(true) {
-    prognozi = new ProstoyPrognoz[1];
+    prognozi = vydelit(1);
     prognozi[0] = prognoz;
 }
 
 SlozhniyPrognoz::SlozhniyPrognoz(const SlozhniyPrognoz& other):
-    count(other.count), capacity(other.capacity), sortedStatus(other.sortedStatus) {
+    count(other.count), capacity(other.count), sortedStatus(other.sortedStatus),
+    indeksMesyatsev(other.indeksMesyatsev), svodki(other.svodki), indeksSumm(other.indeksSumm),
+    indeksiSeriy(other.indeksiSeriy), indeksKart(other.indeksKart), indeksZon(other.indeksZon) {
 
     if (capacity > 0) {
-        prognozi = new ProstoyPrognoz[capacity];
+        prognozi = vydelit(capacity);
         std::copy_n(other.prognozi, count, prognozi);
     }
     else {
@@ -58,28 +114,76 @@ SlozhniyPrognoz::SlozhniyPrognoz(const SlozhniyPrognoz& other):
 }
 
 SlozhniyPrognoz::SlozhniyPrognoz(SlozhniyPrognoz&& other) noexcept:
-    prognozi(other.prognozi), count(other.count), capacity(other.capacity), sortedStatus(other.sortedStatus) {
+    prognozi(nullptr), count(other.count), capacity(0), sortedStatus(other.sortedStatus), resurs(other.resurs),
+    indeksMesyatsev(std::move(other.indeksMesyatsev)), svodki(std::move(other.svodki)),
+    indeksSumm(std::move(other.indeksSumm)), indeksiSeriy(std::move(other.indeksiSeriy)),
+    indeksKart(std::move(other.indeksKart)), indeksZon(std::move(other.indeksZon)) {
 
-    other.prognozi = nullptr;
+    zabratMassiv(other);
     other.count = 0;
-    other.capacity = 0;
     other.sortedStatus = true;
+    other.sbrosIndeksov();
+    other.svodki = Svodki();
 }
 
 
 SlozhniyPrognoz::~SlozhniyPrognoz() {
-    delete[] prognozi;
+    osvobodit(prognozi, capacity);
 }
 
 SlozhniyPrognoz& SlozhniyPrognoz::operator += (const ProstoyPrognoz& newPrognoz) {
     if (count == capacity) {
-        reserve(capacity == 0 ? 1 : capacity * 2);
+        size_t novaya = (capacity == 0) ? 1 : capacity * 2;
+        // Встроенный массив сначала дорастает до конца буфера и только потом уходит в кучу
+        if (capacity < VSTROENNAYA_EMKOST && novaya > VSTROENNAYA_EMKOST) novaya = VSTROENNAYA_EMKOST;
+        reserve(novaya);
     }
+    bool poPoryadku = (count == 0) || (prognozi[count - 1].getDate() <= newPrognoz.getDate());
+
     prognozi[count] = newPrognoz;
     count++;
 
-    if (count > 1) {
+    if (svodki.vklyucheni) {
+        uchestVSvodke(prognozi[count - 1], 1);
+    }
+
+    // Зоны привязаны к позициям, а не к порядку дат, поэтому дополняются при любом добавлении
+    bool zoni = indeksZon.valid;
+    if (zoni) {
+        indeksZon.karta.dopisat(prognozi[count - 1]);
+    }
+
+    if (!poPoryadku) {
         sortedStatus = false;
+        sbrosIndeksov();
+        indeksZon.valid = zoni;
+        return *this;
+    }
+
+    if (indeksSumm.valid) {
+        dopisatVIndeksSumm(count - 1);
+    }
+    for (IndeksSeriy& indeks : indeksiSeriy) {
+        dopisatVIndeksSeriy(indeks, count - 1);
+    }
+    if (indeksKart.valid) {
+        dopisatVIndeksKart(count - 1);
+    }
+
+    if (indeksMesyatsev.valid) {
+        // Дописываем новый месяц(ы) в индекс, если прогноз открыл следующий месяц
+        long long klyuch = Kalendar::klyuchMesyatsa(newPrognoz.getDate(), indeksMesyatsev.smeshenie);
+        long long posledniy = indeksMesyatsev.pervyyMesyats + (long long)indeksMesyatsev.nachala.size() - 2;
+
+        if (count == 1 || klyuch - indeksMesyatsev.pervyyMesyats >= MAKS_MESYATSEV_INDEKSA) {
+            indeksMesyatsev.valid = false;
+        }
+        else {
+            for (long long k = posledniy; k < klyuch; k++) {
+                indeksMesyatsev.nachala.push_back(count - 1);
+            }
+            indeksMesyatsev.nachala.back() = count;
+        }
     }
 
     return *this;
@@ -88,6 +192,20 @@ SlozhniyPrognoz& SlozhniyPrognoz::operator += (const ProstoyPrognoz& newPrognoz)
 ProstoyPrognoz& SlozhniyPrognoz::operator [] (size_t index) {
     if (index >= count) throw std::out_of_range("Index out of range");
     sortedStatus = false;
+
+    // Дерево Фенвика учтет запись позже точечным обновлением, остальные индексы сбрасываются
+    if (indeksSumm.valid && indeksSumm.tip == TipIndeksaSumm::Fenwick && indeksSumm.izmenennie.size() < count) {
+        sbrosIndeksov(true);
+        indeksSumm.izmenennie.push_back(index);
+    }
+    else {
+        sbrosIndeksov();
+    }
+
+    // Вклад вернется в сводки уже с теми значениями, которые запишут по ссылке
+    if (svodki.vklyucheni && svodki.izmenennie.insert(index).second) {
+        uchestVSvodke(prognozi[index], -1);
+    }
     return prognozi[index];
 }
 
@@ -99,13 +217,20 @@ const ProstoyPrognoz& SlozhniyPrognoz::operator [] (size_t index) const {
 SlozhniyPrognoz& SlozhniyPrognoz::operator = (const SlozhniyPrognoz& other) {
     if (this == &other) return *this; 
 
-    delete[] prognozi;
+    osvobodit(prognozi, capacity);
 
     count = other.count;
-    capacity = other.capacity;
+    capacity = other.count;
+    sortedStatus = other.sortedStatus;
+    indeksMesyatsev = other.indeksMesyatsev;
+    svodki = other.svodki;
+    indeksSumm = other.indeksSumm;
+    indeksiSeriy = other.indeksiSeriy;
+    indeksKart = other.indeksKart;
+    indeksZon = other.indeksZon;
 
     if (capacity > 0) {
-        prognozi = new ProstoyPrognoz[capacity];
+        prognozi = vydelit(capacity);
         std::copy_n(other.prognozi, count, prognozi);
         
     }
@@ -116,18 +241,43 @@ SlozhniyPrognoz& SlozhniyPrognoz::operator = (const SlozhniyPrognoz& other) {
     return *this;
 }
 
-SlozhniyPrognoz& SlozhniyPrognoz::operator = (SlozhniyPrognoz&& other) noexcept {
+SlozhniyPrognoz& SlozhniyPrognoz::operator = (SlozhniyPrognoz&& other) {
     if (this == &other) return *this;
 
-    delete[] prognozi;
-
-    prognozi = other.prognozi;
+    // Источник памяти остается своим, как у std::pmr::vector: массив из чужого источника
+    // (например арены запроса) нельзя забрать, он освобождается вместе с ним
+    if (resurs == other.resurs || other.vstroen()) {
+        osvobodit(prognozi, capacity);
+        zabratMassiv(other);
+    }
+    else {
+        // Длинный массив выделяется до освобождения старого: при нехватке памяти объект не меняется.
+        // Короткий ляжет во встроенный буфер, который сначала нужно освободить
+        size_t n = other.count;
+        ProstoyPrognoz* noviy = (n > VSTROENNAYA_EMKOST) ? vydelit(n) : nullptr;
+        osvobodit(prognozi, capacity);
+        if (n > 0 && noviy == nullptr) noviy = vydelit(n);
+        std::move(other.prognozi, other.prognozi + n, noviy);
+        prognozi = noviy;
+        capacity = n;
+
+        other.osvobodit(other.prognozi, other.capacity);
+        other.prognozi = nullptr;
+        other.capacity = 0;
+    }
     count = other.count;
-    capacity = other.capacity;
+    sortedStatus = other.sortedStatus;
+    indeksMesyatsev = std::move(other.indeksMesyatsev);
+    svodki = std::move(other.svodki);
+    indeksSumm = std::move(other.indeksSumm);
+    indeksiSeriy = std::move(other.indeksiSeriy);
+    indeksKart = std::move(other.indeksKart);
+    indeksZon = std::move(other.indeksZon);
 
-    other.prognozi = nullptr;
     other.count = 0;
-    other.capacity = 0;
+    other.sortedStatus = true;
+    other.sbrosIndeksov();
+    other.svodki = Svodki();
 
     return *this;
 }
@@ -172,38 +322,147 @@ std::istream& operator >> (std::istream& input, SlozhniyPrognoz& vvod) {
 void SlozhniyPrognoz::remove(size_t index) {
     if (index >= count) throw std::out_of_range("Index out of range");
 
+    if (svodki.vklyucheni) {
+        primenitIzmeneniya();
+        uchestVSvodke(prognozi[index], -1);
+    }
+
     for (size_t i = index; i < count - 1; i++) {
         prognozi[i] = std::move(prognozi[i + 1]);
     }
     count--;
+
+    // Битовые карты сдвигаются вслед за массивом, остальные индексы строятся заново
+    bool karti = indeksKart.valid;
+    sbrosIndeksov();
+    if (karti) {
+        for (BitovayaKarta& karta : indeksKart.poStatusam) {
+            karta.udalit(index);
+        }
+        indeksKart.oshibki.udalit(index);
+        indeksKart.valid = true;
+    }
 }
 
 ProstoyPrognoz SlozhniyPrognoz::getColdestDay(long long dateStart, long long dateEnd) const {
     if (count == 0) throw std::logic_error("Class is empty");
 
-    ProstoyPrognoz coldest;
+    // Минимум ищется по столбцам дат и температур, прогноз копируется один раз в конце
+    size_t nachalo, konets;
+    granitsiDiapazona(dateStart, dateEnd, nachalo, konets);
     bool found = false;
     double minimum = 0.0;
+    size_t index = Yadra::minimumSrednego(prognozi + nachalo, konets - nachalo, dateStart, dateEnd, found, minimum);
 
-    for (size_t i = 0; i < count; i++) {
-        long long date = prognozi[i].getDate();
+    if (!found) {
+        throw std::logic_error("No forecasts found in your date range");
+    }
 
-        if (date >= dateStart && date <= dateEnd) {
-            double average = prognozi[i].getAverageTemp();
+    return prognozi[nachalo + index];
+}
 
-            if (!found || (average < minimum)) {
-                minimum = average;
-                coldest = prognozi[i];
-                found = true;
-            }
+double SlozhniyPrognoz::znachenieKlyucha(const ProstoyPrognoz& p, Klyuch klyuch) {
+    switch (klyuch) {
+    case Klyuch::Utro: return p.getMorningTemp();
+    case Klyuch::Den: return p.getDayTemp();
+    case Klyuch::Vecher: return p.getEveningTemp();
+    case Klyuch::Osadki: return p.getOsadki();
+    default: return p.getAverageTemp();
+    }
+}
+
+void SlozhniyPrognoz::granitsiDiapazona(long long dateStart, long long dateEnd, size_t& nachalo, size_t& konets) const {
+    nachalo = 0;
+    konets = count;
+    if (!sortedStatus) return;
+
+    auto poDate = [](const ProstoyPrognoz& p, long long d) {
+        return p.getDate() < d;
+    };
+    auto poDateSprava = [](long long d, const ProstoyPrognoz& p) {
+        return d < p.getDate();
+    };
+    nachalo = std::lower_bound(prognozi, prognozi + count, dateStart, poDate) - prognozi;
+    konets = std::upper_bound(prognozi + nachalo, prognozi + count, dateEnd, poDateSprava) - prognozi;
+}
+
+std::vector<size_t> SlozhniyPrognoz::topK(long long dateStart, long long dateEnd, Klyuch klyuch, size_t k, Poryadok poryadok) const {
+    std::vector<size_t> kucha;
+    if (k == 0 || count == 0 || dateStart > dateEnd) return kucha;
+
+    auto znachenie = [&](size_t i) {
+        double z = znachenieKlyucha(prognozi[i], klyuch);
+        // Наибольшие ищем как наименьшие с обратным знаком
+        return (poryadok == Poryadok::Naimenshie) ? z : -z;
+    };
+
+    // "a лучше b": меньшее значение, при равенстве - меньший индекс.
+    // На вершине кучи - худший из отобранных, его и вытесняет новый кандидат.
+    auto luchshe = [&](size_t a, size_t b) {
+        double za = znachenie(a);
+        double zb = znachenie(b);
+        return za < zb || (za == zb && a < b);
+    };
+
+    size_t nachalo = 0;
+    size_t konets = 0;
+    granitsiDiapazona(dateStart, dateEnd, nachalo, konets);
+
+    kucha.reserve(std::min(k, konets - nachalo));
+    for (size_t i = nachalo; i < konets; i++) {
+        long long date = prognozi[i].getDate();
+        if (date < dateStart || date > dateEnd) continue;
+
+        if (kucha.size() < k) {
+            kucha.push_back(i);
+            std::push_heap(kucha.begin(), kucha.end(), luchshe);
+        }
+        else if (luchshe(i, kucha.front())) {
+            std::pop_heap(kucha.begin(), kucha.end(), luchshe);
+            kucha.back() = i;
+            std::push_heap(kucha.begin(), kucha.end(), luchshe);
         }
     }
 
-    if (!found) {
-        throw std::logic_error("No forecasts found in your date range");
+    std::sort_heap(kucha.begin(), kucha.end(), luchshe);
+    return kucha;
+}
+
+EskizKvantiley SlozhniyPrognoz::eskizKvantiley(long long dateStart, long long dateEnd, Klyuch klyuch, size_t k) const {
+    EskizKvantiley eskiz(k);
+    if (dateStart > dateEnd) return eskiz;
+
+    size_t nachalo = 0;
+    size_t konets = 0;
+    granitsiDiapazona(dateStart, dateEnd, nachalo, konets);
+
+    for (size_t i = nachalo; i < konets; i++) {
+        long long date = prognozi[i].getDate();
+        if (date >= dateStart && date <= dateEnd) {
+            eskiz.dobavit(znachenieKlyucha(prognozi[i], klyuch));
+        }
     }
+    return eskiz;
+}
 
-    return coldest;
+std::map<long long, EskizKvantiley> SlozhniyPrognoz::eskiziPoMesyatsam(Klyuch klyuch, long long smeshenie, size_t k) const {
+    std::map<long long, EskizKvantiley> eskizi;
+
+    // Для отсортированного массива месяц меняется редко: запоминаем текущий скетч и конец его месяца
+    EskizKvantiley* tekushiy = nullptr;
+    long long startMonth = 0;
+    long long endMonth = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        long long date = prognozi[i].getDate();
+        if (tekushiy == nullptr || date < startMonth || date >= endMonth) {
+            Kalendar::granitsiMesyatsa(date, smeshenie, startMonth, endMonth);
+            long long klyuchMes = Kalendar::klyuchMesyatsa(date, smeshenie);
+            tekushiy = &eskizi.try_emplace(klyuchMes, k).first->second;
+        }
+        tekushiy->dobavit(znachenieKlyucha(prognozi[i], klyuch));
+    }
+    return eskizi;
 }
 
 ProstoyPrognoz SlozhniyPrognoz::getNextSunnyDay(long long currentDate) const {
@@ -228,78 +487,1301 @@ void SlozhniyPrognoz::removeOshibki() {
 
     if (count == 0) return;
 
-    for (size_t i = count; i > 0; i--) {
-        size_t index = i - 1;  //Типо size_t беззнаковый и сравнивать с 0 ну такооооое
-        if (prognozi[index].oshibka()) {
-            remove(index);
+    if (svodki.vklyucheni) {
+        primenitIzmeneniya();
+    }
+
+    // Ошибки ищутся пакетно по блокам, затем массив уплотняется за один проход
+    Yadra::Kolonki kolonki;
+    uint64_t maska[Yadra::SLOV_MASKI];
+    size_t ostavleno = 0;
+    for (size_t nachalo = 0; nachalo < count; nachalo += Yadra::RAZMER_BLOKA) {
+        size_t razmer = std::min(Yadra::RAZMER_BLOKA, count - nachalo);
+        kolonki.zapolnit(prognozi + nachalo, razmer);
+        Yadra::maskaOshibok(kolonki, maska);
+
+        for (size_t i = 0; i < razmer; i++) {
+            size_t index = nachalo + i;
+            if ((maska[i / 64] >> (i % 64)) & 1) {
+                if (svodki.vklyucheni) uchestVSvodke(prognozi[index], -1);
+                continue;
+            }
+            if (ostavleno != index) prognozi[ostavleno] = std::move(prognozi[index]);
+            ostavleno++;
+        }
+    }
+
+    if (ostavleno != count) {
+        count = ostavleno;
+        sbrosIndeksov();
+    }
+}
+
+
+static bool menshePoDate(const ProstoyPrognoz& a, const ProstoyPrognoz& b) {
+    return a.getDate() < b.getDate();
+}
+
+//Запускает f(0), ..., f(zadach - 1), каждый вызов в своем потоке (нулевой - в текущем)
+template <typename F>
+static void vipolnitParallelno(size_t zadach, F f) {
+    std::vector<std::thread> potoki;
+    potoki.reserve(zadach);
+    for (size_t z = 1; z < zadach; z++) {
+        potoki.emplace_back(f, z);
+    }
+    f(0);
+    for (std::thread& potok : potoki) {
+        potok.join();
+    }
+}
+
+//Сколько элементов из a попадет в первые k элементов устойчивого слияния a и b
+static size_t coRank(size_t k, const ProstoyPrognoz* a, size_t m, const ProstoyPrognoz* b, size_t n) {
+    size_t lo = (k > n) ? k - n : 0;
+    size_t hi = std::min(k, m);
+
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+        // a[i] не меньше b[j-1] по дате -> при равенстве a идет первым, значит взяли мало из a
+        if (j > 0 && !menshePoDate(b[j - 1], a[i])) {
+            lo = i + 1;
+        }
+        else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+void SlozhniyPrognoz::sortDatesParallel(size_t potokov, std::pmr::memory_resource* vremennaya) {
+    std::pmr::vector<ProstoyPrognoz> bufer(count, vremennaya);
+
+    // Границы отсортированных кусков: [granitsi[k], granitsi[k + 1])
+    std::pmr::vector<size_t> granitsi(potokov + 1, vremennaya);
+    for (size_t k = 0; k <= potokov; k++) {
+        granitsi[k] = count * k / potokov;
+    }
+
+    vipolnitParallelno(potokov, [&](size_t k) {
+        std::stable_sort(prognozi + granitsi[k], prognozi + granitsi[k + 1], menshePoDate);
+    });
+
+    ProstoyPrognoz* otkuda = prognozi;
+    ProstoyPrognoz* kuda = bufer.data();
+
+    while (granitsi.size() > 2) {
+        size_t par = (granitsi.size() - 1) / 2;
+        size_t kuskovNaSliyanie = std::max<size_t>(1, potokov / par);
+
+        // Каждое слияние пары кусков делим на kuskovNaSliyanie независимых частей
+        vipolnitParallelno(par * kuskovNaSliyanie, [&](size_t z) {
+            size_t p = z / kuskovNaSliyanie;
+            size_t chast = z % kuskovNaSliyanie;
+
+            size_t nachalo = granitsi[2 * p];
+            size_t seredina = granitsi[2 * p + 1];
+            size_t konets = granitsi[2 * p + 2];
+            const ProstoyPrognoz* a = otkuda + nachalo;
+            const ProstoyPrognoz* b = otkuda + seredina;
+            size_t m = seredina - nachalo;
+            size_t n = konets - seredina;
+
+            size_t k1 = (m + n) * chast / kuskovNaSliyanie;
+            size_t k2 = (m + n) * (chast + 1) / kuskovNaSliyanie;
+            size_t i1 = coRank(k1, a, m, b, n);
+            size_t i2 = coRank(k2, a, m, b, n);
+
+            std::merge(std::make_move_iterator(a + i1), std::make_move_iterator(a + i2),
+                std::make_move_iterator(b + (k1 - i1)), std::make_move_iterator(b + (k2 - i2)),
+                kuda + nachalo + k1, menshePoDate);
+        });
+
+        // Нечетный последний кусок просто переносим
+        if ((granitsi.size() - 1) % 2 == 1) {
+            size_t nachalo = granitsi[granitsi.size() - 2];
+            std::move(otkuda + nachalo, otkuda + count, kuda + nachalo);
+        }
+
+        std::pmr::vector<size_t> novieGranitsi(vremennaya);
+        for (size_t k = 0; k < granitsi.size(); k += 2) {
+            novieGranitsi.push_back(granitsi[k]);
+        }
+        if (novieGranitsi.back() != count) {
+            novieGranitsi.push_back(count);
         }
+        granitsi = std::move(novieGranitsi);
+
+        std::swap(otkuda, kuda);
+    }
+
+    if (otkuda != prognozi) {
+        vipolnitParallelno(potokov, [&](size_t k) {
+            size_t nachalo = count * k / potokov;
+            size_t konets = count * (k + 1) / potokov;
+            std::move(otkuda + nachalo, otkuda + konets, prognozi + nachalo);
+        });
     }
 }
 
+void SlozhniyPrognoz::sortDates(std::pmr::memory_resource* vremennaya) {
 
-void SlozhniyPrognoz::sortDates() {
+    primenitIzmeneniya();  // Запомненные индексы после сортировки были бы уже другими
 
     if (sortedStatus) return;
 
+    if (count < 2) {
+        sortedStatus = true;
+        return;
+    }
+
+    // Часто массив уже упорядочен (например, после [] только для чтения) - это проверяется за O(n)
+    if (std::is_sorted(prognozi, prognozi + count, menshePoDate)) {
+        sortedStatus = true;
+        return;
+    }
+
+    size_t potokov = std::thread::hardware_concurrency();
+    if (count >= POROG_PARALLELNOY_SORTIROVKI && potokov > 1) {
+        sortDatesParallel(potokov, iliObshiy(vremennaya));
+    }
+    else {
+        std::stable_sort(prognozi, prognozi + count, menshePoDate);
+    }
+
+    sbrosIndeksov();
+    sortedStatus = true;
+}
+
+//Перемешивает биты даты (финализатор splitmix64). Даты обычно кратны 86400,
+//поэтому простой остаток от деления складывал бы все даты в один раздел
+static size_t heshDati(long long date) {
+    unsigned long long x = (unsigned long long)date;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (size_t)x;
+}
+
+void SlozhniyPrognoz::mergePovtorkiParallel(size_t potokov, std::pmr::memory_resource* vremennaya) {
+    // Шаг 1: каждый поток раскладывает свой кусок индексов по разделам
+    std::vector<std::vector<std::vector<size_t>>> korzini(potokov, std::vector<std::vector<size_t>>(potokov));
+
+    vipolnitParallelno(potokov, [&](size_t t) {
+        size_t nachalo = count * t / potokov;
+        size_t konets = count * (t + 1) / potokov;
+        for (size_t i = nachalo; i < konets; i++) {
+            korzini[t][heshDati(prognozi[i].getDate()) % potokov].push_back(i);
+        }
+    });
+
+    // Шаг 2: каждый раздел объединяется независимо. Куски обходятся по порядку,
+    // поэтому прогнозы одной даты складываются в том же порядке, что и в массиве
+    std::vector<std::vector<ProstoyPrognoz>> razdeli(potokov);
+
+    vipolnitParallelno(potokov, [&](size_t w) {
+        std::unordered_map<long long, size_t> pozicii;
+        std::vector<ProstoyPrognoz>& razdel = razdeli[w];
+
+        for (size_t t = 0; t < potokov; t++) {
+            for (size_t i : korzini[t][w]) {
+                auto [it, noviy] = pozicii.try_emplace(prognozi[i].getDate(), razdel.size());
+                if (noviy) {
+                    razdel.push_back(prognozi[i]);
+                }
+                else {
+                    razdel[it->second] += prognozi[i];
+                }
+            }
+        }
+    });
+
+    // Шаг 3: собираем разделы обратно и упорядочиваем по дате (даты уже уникальны)
+    std::pmr::vector<size_t> smesheniya(potokov + 1, 0, vremennaya);
+    for (size_t w = 0; w < potokov; w++) {
+        smesheniya[w + 1] = smesheniya[w] + razdeli[w].size();
+    }
+
+    vipolnitParallelno(potokov, [&](size_t w) {
+        std::move(razdeli[w].begin(), razdeli[w].end(), prognozi + smesheniya[w]);
+    });
+
+    count = smesheniya[potokov];
+    sortedStatus = false;
+    sbrosIndeksov();
+    perestroitSvodki();
+    sortDates(vremennaya);
+}
+
+void SlozhniyPrognoz::mergePovtorki(std::pmr::memory_resource* vremennaya) {
     if (count < 2) return;
 
-    for (size_t i = 0; i < count - 1; i++) {
-        for (size_t j = 0; j < count - i - 1; j++) {
-            if (prognozi[j] <=> prognozi[j + 1] > 0) {   // Можно и через swap, без разницы
-                ProstoyPrognoz temp = std::move(prognozi[j]);
-                prognozi[j] = std::move(prognozi[j + 1]);
-                prognozi[j + 1] = std::move(temp);
+    size_t potokov = std::thread::hardware_concurrency();
+    if (!sortedStatus && count >= POROG_PARALLELNOGO_SLIYANIYA && potokov > 1) {
+        mergePovtorkiParallel(potokov, iliObshiy(vremennaya));
+        return;
+    }
+
+    sortDates(vremennaya);
+
+    // Сжатие на месте за один проход (вместо remove() на каждый повтор)
+    size_t zapis = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (prognozi[zapis] == prognozi[i]) {
+            prognozi[zapis] += prognozi[i];
+        }
+        else {
+            zapis++;
+            if (zapis != i) {
+                prognozi[zapis] = std::move(prognozi[i]);
+            }
+        }
+    }
+
+    if (zapis + 1 < count) {
+        sbrosIndeksov();
+        count = zapis + 1;
+        perestroitSvodki();
+    }
+}
+
+std::span<const ProstoyPrognoz> SlozhniyPrognoz::otrezokDat(long long dateStart, long long dateEnd) const {
+    auto poDate = [](const ProstoyPrognoz& p, long long d) {
+        return p.getDate() < d;
+    };
+    const ProstoyPrognoz* l = std::lower_bound((const ProstoyPrognoz*)prognozi, (const ProstoyPrognoz*)(prognozi + count), dateStart, poDate);
+    const ProstoyPrognoz* r = std::lower_bound(l, (const ProstoyPrognoz*)(prognozi + count), dateEnd, poDate);
+    return std::span<const ProstoyPrognoz>(l, r);
+}
+
+SlozhniyPrognoz SlozhniyPrognoz::vyborka(long long startMonth, long long endMonth, std::pmr::memory_resource* resurs) const {
+    SlozhniyPrognoz podmnozh(resurs);
+
+    // Отсортированный массив: месяц - это непрерывный отрезок, копируем его целиком
+    if (sortedStatus) {
+        std::span<const ProstoyPrognoz> otrezok = otrezokDat(startMonth, endMonth);
+        if (!otrezok.empty()) {
+            SlozhniyPrognoz kopiya(otrezok.data(), otrezok.size(), resurs);
+            kopiya.sortedStatus = true;
+            return kopiya;
+        }
+        return podmnozh;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        long long datePrognoz = prognozi[i].getDate();
+
+        if (datePrognoz >= startMonth && datePrognoz < endMonth) {
+            podmnozh += prognozi[i];
+        }
+    }
+
+    podmnozh.sortDates();
+    return podmnozh;
+}
+
+SlozhniyPrognoz SlozhniyPrognoz::getMonth(long long date, long long smeshenie, std::pmr::memory_resource* resurs) const {
+    long long startMonth, endMonth;
+    Kalendar::granitsiMesyatsa(date, smeshenie, startMonth, endMonth);
+    return vyborka(startMonth, endMonth, resurs);
+}
+
+SlozhniyPrognoz SlozhniyPrognoz::getMonth(long long date, const ChasovoyPoyas& poyas, std::pmr::memory_resource* resurs) const {
+    long long startMonth, endMonth;
+    poyas.granitsiMesyatsa(date, startMonth, endMonth);
+    return vyborka(startMonth, endMonth, resurs);
+}
+
+std::span<const ProstoyPrognoz> SlozhniyPrognoz::getMonthView(long long date, long long smeshenie) {
+    sortDates();
+
+    if (!indeksMesyatsev.valid || indeksMesyatsev.smeshenie != smeshenie) {
+        postroitIndeksMesyatsev(smeshenie);
+    }
+
+    // Слишком широкий разброс дат - индекс не строится, ищем двоичным поиском
+    if (!indeksMesyatsev.valid) {
+        long long startMonth, endMonth;
+        Kalendar::granitsiMesyatsa(date, smeshenie, startMonth, endMonth);
+        return otrezokDat(startMonth, endMonth);
+    }
+
+    long long k = Kalendar::klyuchMesyatsa(date, smeshenie) - indeksMesyatsev.pervyyMesyats;
+    if (k < 0 || k + 1 >= (long long)indeksMesyatsev.nachala.size()) {
+        return {};
+    }
+
+    return std::span<const ProstoyPrognoz>(prognozi + indeksMesyatsev.nachala[k], prognozi + indeksMesyatsev.nachala[k + 1]);
+}
+
+std::span<const ProstoyPrognoz> SlozhniyPrognoz::getMonthView(long long date, const ChasovoyPoyas& poyas) {
+    sortDates();
+
+    long long startMonth, endMonth;
+    poyas.granitsiMesyatsa(date, startMonth, endMonth);
+    return otrezokDat(startMonth, endMonth);
+}
+
+SlozhniyPrognoz::SvodkaOkon SlozhniyPrognoz::gruppirovat(TipOkna okno, long long smeshenie) const {
+    SvodkaOkon svodka;
+
+    std::vector<size_t> poryadok;
+    if (!sortedStatus) {
+        poryadok = poryadokPoDate();
+    }
+
+    long long start = 0;
+    long long end = 0;
+    bool estOkno = false;
+    double summaUtro = 0.0, summaDen = 0.0, summaVecher = 0.0;
+
+    // Закрывает текущее окно: переводит суммы температур в средние
+    auto zakrit = [&]() {
+        if (!estOkno) return;
+        double n = (double)svodka.kolvo.back();
+        svodka.srednUtro.push_back(summaUtro / n);
+        svodka.srednDen.push_back(summaDen / n);
+        svodka.srednVecher.push_back(summaVecher / n);
+    };
+
+    for (size_t k = 0; k < count; k++) {
+        const ProstoyPrognoz& p = sortedStatus ? prognozi[k] : prognozi[poryadok[k]];
+        long long date = p.getDate();
+        int kod = std::max(ProstoyPrognoz::kodStatusa(p.getStatus()), 0);
+
+        if (!estOkno || date >= end) {
+            zakrit();
+
+            switch (okno) {
+            case TipOkna::Nedelya: Kalendar::granitsiNedeli(date, smeshenie, start, end); break;
+            case TipOkna::Dekada: Kalendar::granitsiDekady(date, smeshenie, start, end); break;
+            case TipOkna::Mesyats: Kalendar::granitsiMesyatsa(date, smeshenie, start, end); break;
+            case TipOkna::Sezon: Kalendar::granitsiSezona(date, smeshenie, start, end); break;
+            case TipOkna::God: Kalendar::granitsiGoda(date, smeshenie, start, end); break;
+            }
+
+            svodka.nachalo.push_back(start);
+            svodka.konets.push_back(end);
+            svodka.kolvo.push_back(1);
+            svodka.minUtro.push_back(p.getMorningTemp());
+            svodka.maxUtro.push_back(p.getMorningTemp());
+            svodka.minDen.push_back(p.getDayTemp());
+            svodka.maxDen.push_back(p.getDayTemp());
+            svodka.minVecher.push_back(p.getEveningTemp());
+            svodka.maxVecher.push_back(p.getEveningTemp());
+            svodka.summaOsadkov.push_back(p.getOsadki());
+            svodka.hudshiyStatus.push_back(kod);
+            summaUtro = p.getMorningTemp();
+            summaDen = p.getDayTemp();
+            summaVecher = p.getEveningTemp();
+            estOkno = true;
+            continue;
+        }
+
+        svodka.kolvo.back()++;
+        svodka.minUtro.back() = std::min(svodka.minUtro.back(), p.getMorningTemp());
+        svodka.maxUtro.back() = std::max(svodka.maxUtro.back(), p.getMorningTemp());
+        svodka.minDen.back() = std::min(svodka.minDen.back(), p.getDayTemp());
+        svodka.maxDen.back() = std::max(svodka.maxDen.back(), p.getDayTemp());
+        svodka.minVecher.back() = std::min(svodka.minVecher.back(), p.getEveningTemp());
+        svodka.maxVecher.back() = std::max(svodka.maxVecher.back(), p.getEveningTemp());
+        svodka.summaOsadkov.back() += p.getOsadki();
+        svodka.hudshiyStatus.back() = std::max(svodka.hudshiyStatus.back(), kod);
+        summaUtro += p.getMorningTemp();
+        summaDen += p.getDayTemp();
+        summaVecher += p.getEveningTemp();
+    }
+
+    zakrit();
+    return svodka;
+}
+
+void SlozhniyPrognoz::skolzyashieOkna(long long dney, SkolzyashieOkna& okna, long long smeshenie) const {
+    if (dney < 1) throw std::invalid_argument("Window must be at least one day");
+
+    std::vector<size_t>& poryadok = okna.rabochie.poryadok;
+    if (!sortedStatus) {
+        poryadokPoDate(poryadok);
+    }
+
+    okna.date.resize(count);
+    okna.kolvo.resize(count);
+    okna.srednTemp.resize(count);
+    okna.minTemp.resize(count);
+    okna.maxTemp.resize(count);
+    okna.summaOsadkov.resize(count);
+
+    // Номер дня и средняя температура в порядке дат
+    std::vector<long long>& dni = okna.rabochie.dni;
+    std::vector<double>& temp = okna.rabochie.temp;
+    dni.resize(count);
+    temp.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        const ProstoyPrognoz& p = sortedStatus ? prognozi[k] : prognozi[poryadok[k]];
+        okna.date[k] = p.getDate();
+        dni[k] = Kalendar::denIzDati(p.getDate(), smeshenie);
+        temp[k] = p.getAverageTemp();
+    }
+
+    // Монотонные очереди индексов: каждый индекс попадает в очередь один раз,
+    // поэтому хватает массива на count элементов с указателями начала и конца
+    std::vector<size_t>& ocheredMin = okna.rabochie.ocheredMin;
+    std::vector<size_t>& ocheredMax = okna.rabochie.ocheredMax;
+    ocheredMin.resize(count);
+    ocheredMax.resize(count);
+    size_t nachaloMin = 0, konetsMin = 0;
+    size_t nachaloMax = 0, konetsMax = 0;
+
+    size_t levo = 0;
+    double summaTemp = 0.0;
+    double summaOsadkov = 0.0;
+
+    size_t k = 0;
+    while (k < count) {
+        // В окно сразу входят все прогнозы текущего дня
+        long long den = dni[k];
+        size_t konetsDnya = k;
+        while (konetsDnya < count && dni[konetsDnya] == den) {
+            const ProstoyPrognoz& p = sortedStatus ? prognozi[konetsDnya] : prognozi[poryadok[konetsDnya]];
+            summaTemp += temp[konetsDnya];
+            summaOsadkov += p.getOsadki();
+
+            while (konetsMin > nachaloMin && temp[ocheredMin[konetsMin - 1]] >= temp[konetsDnya]) konetsMin--;
+            ocheredMin[konetsMin++] = konetsDnya;
+            while (konetsMax > nachaloMax && temp[ocheredMax[konetsMax - 1]] <= temp[konetsDnya]) konetsMax--;
+            ocheredMax[konetsMax++] = konetsDnya;
+
+            konetsDnya++;
+        }
+
+        // Из окна выходят прогнозы за дни раньше (den - dney + 1)
+        while (dni[levo] <= den - dney) {
+            const ProstoyPrognoz& p = sortedStatus ? prognozi[levo] : prognozi[poryadok[levo]];
+            summaTemp -= temp[levo];
+            summaOsadkov -= p.getOsadki();
+            levo++;
+        }
+        while (ocheredMin[nachaloMin] < levo) nachaloMin++;
+        while (ocheredMax[nachaloMax] < levo) nachaloMax++;
+
+        size_t kolvo = konetsDnya - levo;
+        for (; k < konetsDnya; k++) {
+            okna.kolvo[k] = kolvo;
+            okna.srednTemp[k] = summaTemp / (double)kolvo;
+            okna.minTemp[k] = temp[ocheredMin[nachaloMin]];
+            okna.maxTemp[k] = temp[ocheredMax[nachaloMax]];
+            okna.summaOsadkov[k] = summaOsadkov;
+        }
+    }
+}
+
+void SlozhniyPrognoz::uchestVSvodke(const ProstoyPrognoz& p, int znak) {
+    long long klyuch = Kalendar::klyuchMesyatsa(p.getDate(), svodki.smeshenie);
+    SvodkaMesyatsa& svodka = svodki.poMesyatsam[klyuch];
+
+    svodka.kolvo += znak;
+    svodka.summaTemp += znak * p.getAverageTemp();
+    svodka.summaOsadkov += znak * p.getOsadki();
+
+    int kod = ProstoyPrognoz::kodStatusa(p.getStatus());
+    if (kod >= 0) {
+        svodka.poStatusam[kod] += znak;
+    }
+    if (p.oshibka()) {
+        svodka.oshibok += znak;
+    }
+
+    if (svodka.kolvo == 0) {
+        svodki.poMesyatsam.erase(klyuch);
+    }
+}
+
+void SlozhniyPrognoz::primenitIzmeneniya() {
+    if (svodki.izmenennie.empty()) return;
+
+    for (size_t index : svodki.izmenennie) {
+        uchestVSvodke(prognozi[index], 1);
+    }
+    svodki.izmenennie.clear();
+}
+
+void SlozhniyPrognoz::perestroitSvodki() {
+    if (!svodki.vklyucheni) return;
+
+    svodki.poMesyatsam.clear();
+    svodki.izmenennie.clear();
+    for (size_t i = 0; i < count; i++) {
+        uchestVSvodke(prognozi[i], 1);
+    }
+}
+
+void SlozhniyPrognoz::vklyuchitSvodki(long long smeshenie) {
+    svodki.vklyucheni = true;
+    svodki.smeshenie = smeshenie;
+    perestroitSvodki();
+}
+
+void SlozhniyPrognoz::viklyuchitSvodki() {
+    svodki = Svodki();
+}
+
+SlozhniyPrognoz::SvodkaMesyatsa SlozhniyPrognoz::getSvodkaMesyatsa(long long date) {
+    if (!svodki.vklyucheni) throw std::logic_error("Monthly summaries are not enabled");
+
+    primenitIzmeneniya();
+
+    auto it = svodki.poMesyatsam.find(Kalendar::klyuchMesyatsa(date, svodki.smeshenie));
+    if (it == svodki.poMesyatsam.end()) {
+        return SvodkaMesyatsa();
+    }
+    return it->second;
+}
+
+//Вклад прогноза в столбцы индекса сумм: осадки, градусо-дни отопления и охлаждения
+static void vkladVSummi(const ProstoyPrognoz& p, double bazaTemp, double& osadki, double& otoplenie, double& ohlazhdenie) {
+    double t = p.getAverageTemp();
+    osadki = p.getOsadki();
+    otoplenie = std::max(0.0, bazaTemp - t);
+    ohlazhdenie = std::max(0.0, t - bazaTemp);
+}
+
+void SlozhniyPrognoz::postroitIndeksSumm() {
+    IndeksSumm& ind = indeksSumm;
+    ind.osadki.assign(count + 1, 0.0);
+    ind.otoplenie.assign(count + 1, 0.0);
+    ind.ohlazhdenie.assign(count + 1, 0.0);
+    ind.izmenennie.clear();
+
+    for (size_t i = 0; i < count; i++) {
+        double o, hdd, cdd;
+        vkladVSummi(prognozi[i], ind.bazaTemp, o, hdd, cdd);
+
+        if (ind.tip == TipIndeksaSumm::Prefiksniy) {
+            ind.osadki[i + 1] = ind.osadki[i] + o;
+            ind.otoplenie[i + 1] = ind.otoplenie[i] + hdd;
+            ind.ohlazhdenie[i + 1] = ind.ohlazhdenie[i] + cdd;
+        }
+        else {
+            // Построение дерева Фенвика за O(n): узел передает свою сумму родителю
+            size_t j = i + 1;
+            ind.osadki[j] += o;
+            ind.otoplenie[j] += hdd;
+            ind.ohlazhdenie[j] += cdd;
+            size_t roditel = j + (j & (~j + 1));
+            if (roditel <= count) {
+                ind.osadki[roditel] += ind.osadki[j];
+                ind.otoplenie[roditel] += ind.otoplenie[j];
+                ind.ohlazhdenie[roditel] += ind.ohlazhdenie[j];
             }
         }
     }
+    ind.valid = true;
+}
+
+void SlozhniyPrognoz::dopisatVIndeksSumm(size_t index) {
+    IndeksSumm& ind = indeksSumm;
+    double o, hdd, cdd;
+    vkladVSummi(prognozi[index], ind.bazaTemp, o, hdd, cdd);
+
+    if (ind.tip == TipIndeksaSumm::Prefiksniy) {
+        ind.osadki.push_back(ind.osadki.back() + o);
+        ind.otoplenie.push_back(ind.otoplenie.back() + hdd);
+        ind.ohlazhdenie.push_back(ind.ohlazhdenie.back() + cdd);
+        return;
+    }
+
+    // Новый узел j отвечает за отрезок (j - lowbit(j), j]: его значение плюс уже имеющиеся элементы отрезка
+    size_t j = index + 1;
+    size_t nizhe = j - (j & (~j + 1));
+    ind.osadki.push_back(o + summaPervih(ind.osadki, j - 1) - summaPervih(ind.osadki, nizhe));
+    ind.otoplenie.push_back(hdd + summaPervih(ind.otoplenie, j - 1) - summaPervih(ind.otoplenie, nizhe));
+    ind.ohlazhdenie.push_back(cdd + summaPervih(ind.ohlazhdenie, j - 1) - summaPervih(ind.ohlazhdenie, nizhe));
+}
+
+double SlozhniyPrognoz::summaPervih(const std::vector<double>& stolbets, size_t i) const {
+    if (indeksSumm.tip == TipIndeksaSumm::Prefiksniy) {
+        return stolbets[i];
+    }
+
+    double summa = 0.0;
+    for (; i > 0; i -= i & (~i + 1)) {
+        summa += stolbets[i];
+    }
+    return summa;
+}
+
+void SlozhniyPrognoz::primenitIzmeneniyaSumm() {
+    IndeksSumm& ind = indeksSumm;
+
+    std::sort(ind.izmenennie.begin(), ind.izmenennie.end());
+    ind.izmenennie.erase(std::unique(ind.izmenennie.begin(), ind.izmenennie.end()), ind.izmenennie.end());
 
+    // Порядок дат мог нарушиться только рядом с измененными позициями
+    for (size_t index : ind.izmenennie) {
+        long long date = prognozi[index].getDate();
+        bool poPoryadku = (index == 0 || prognozi[index - 1].getDate() <= date) &&
+            (index + 1 == count || date <= prognozi[index + 1].getDate());
+        if (!poPoryadku) {
+            sbrosIndeksov();
+            return;
+        }
+    }
+
+    // Точечное обновление: разница между новым вкладом и тем, что сейчас учтено в дереве
+    for (size_t index : ind.izmenennie) {
+        double o, hdd, cdd;
+        vkladVSummi(prognozi[index], ind.bazaTemp, o, hdd, cdd);
+        double delta[3] = {
+            o - (summaPervih(ind.osadki, index + 1) - summaPervih(ind.osadki, index)),
+            hdd - (summaPervih(ind.otoplenie, index + 1) - summaPervih(ind.otoplenie, index)),
+            cdd - (summaPervih(ind.ohlazhdenie, index + 1) - summaPervih(ind.ohlazhdenie, index))
+        };
+        for (size_t j = index + 1; j <= count; j += j & (~j + 1)) {
+            ind.osadki[j] += delta[0];
+            ind.otoplenie[j] += delta[1];
+            ind.ohlazhdenie[j] += delta[2];
+        }
+    }
+    ind.izmenennie.clear();
     sortedStatus = true;
 }
 
-void SlozhniyPrognoz::mergePovtorki() {
-    if (count < 2) return;
+void SlozhniyPrognoz::nastroitIndeksSumm(TipIndeksaSumm tip, double bazaTemp) {
+    indeksSumm.valid = false;
+    indeksSumm.izmenennie.clear();
+    indeksSumm.tip = tip;
+    indeksSumm.bazaTemp = bazaTemp;
+}
+
+SlozhniyPrognoz::SummiZaPeriod SlozhniyPrognoz::getSummi(long long dateStart, long long dateEnd) {
+    if (indeksSumm.valid && !indeksSumm.izmenennie.empty()) {
+        primenitIzmeneniyaSumm();
+    }
+    if (!indeksSumm.valid) {
+        sortDates();
+        postroitIndeksSumm();
+    }
+
+    SummiZaPeriod summi;
+    if (dateStart > dateEnd) return summi;
+
+    size_t nachalo = 0;
+    size_t konets = 0;
+    granitsiDiapazona(dateStart, dateEnd, nachalo, konets);
+
+    summi.kolvo = konets - nachalo;
+    summi.osadki = summaPervih(indeksSumm.osadki, konets) - summaPervih(indeksSumm.osadki, nachalo);
+    summi.gradusoDniOtopleniya = summaPervih(indeksSumm.otoplenie, konets) - summaPervih(indeksSumm.otoplenie, nachalo);
+    summi.gradusoDniOhlazhdeniya = summaPervih(indeksSumm.ohlazhdenie, konets) - summaPervih(indeksSumm.ohlazhdenie, nachalo);
+    return summi;
+}
+
+bool SlozhniyPrognoz::UslovieSerii::vipolneno(const ProstoyPrognoz& p) const {
+    switch (vid) {
+    case Vid::NizhePoroga:
+        return std::min({ p.getMorningTemp(), p.getDayTemp(), p.getEveningTemp() }) < porog;
+    case Vid::VishePoroga:
+        return std::max({ p.getMorningTemp(), p.getDayTemp(), p.getEveningTemp() }) > porog;
+    default:
+        return p.getStatus() == status;
+    }
+}
+
+void SlozhniyPrognoz::obnovitKonetsTablitsy(IndeksSeriy& indeks, bool novaya) {
+    size_t posledniy = indeks.serii.size() - 1;
+    auto dlinnee = [&](size_t a, size_t b) {
+        return (indeks.serii[b].dney > indeks.serii[a].dney) ? b : a;
+    };
+
+    if (novaya) {
+        if (indeks.tablitsa.empty()) indeks.tablitsa.emplace_back();
+        indeks.tablitsa[0].push_back(posledniy);
+    }
+
+    // Последняя серия на уровне k входит только в ячейку, которая ею заканчивается
+    for (size_t k = 1; ((size_t)1 << k) <= posledniy + 1; k++) {
+        size_t i = posledniy + 1 - ((size_t)1 << k);
+        size_t luchshaya = dlinnee(indeks.tablitsa[k - 1][i], indeks.tablitsa[k - 1][i + ((size_t)1 << (k - 1))]);
+        if (novaya) {
+            if (indeks.tablitsa.size() == k) indeks.tablitsa.emplace_back();
+            indeks.tablitsa[k].push_back(luchshaya);
+        }
+        else {
+            indeks.tablitsa[k][i] = luchshaya;
+        }
+    }
+}
+
+void SlozhniyPrognoz::dopisatVIndeksSeriy(IndeksSeriy& indeks, size_t index) const {
+    const ProstoyPrognoz& p = prognozi[index];
+    if (!indeks.uslovie.vipolneno(p)) return;
+
+    long long den = Kalendar::denIzDati(p.getDate(), indeks.smeshenie);
+
+    // Продолжение последней серии: предыдущий прогноз входит в нее и он за тот же или предыдущий день
+    if (!indeks.serii.empty()) {
+        Seriya& posled = indeks.serii.back();
+        long long denPosled = Kalendar::denIzDati(posled.konets, indeks.smeshenie);
+        if (posled.posledniy + 1 == index && den - denPosled <= 1) {
+            posled.posledniy = index;
+            posled.konets = p.getDate();
+            posled.dney = den - Kalendar::denIzDati(posled.nachalo, indeks.smeshenie) + 1;
+            obnovitKonetsTablitsy(indeks, false);
+            return;
+        }
+    }
 
+    indeks.serii.push_back(Seriya{ p.getDate(), p.getDate(), index, index, 1 });
+    obnovitKonetsTablitsy(indeks, true);
+}
+
+const SlozhniyPrognoz::IndeksSeriy& SlozhniyPrognoz::indeksSeriy(const UslovieSerii& uslovie, long long smeshenie) {
+    sortDates();
+
+    for (const IndeksSeriy& indeks : indeksiSeriy) {
+        if (indeks.uslovie == uslovie && indeks.smeshenie == smeshenie) {
+            return indeks;
+        }
+    }
+
+    if (indeksiSeriy.size() == MAKS_INDEKSOV_SERIY) {
+        indeksiSeriy.erase(indeksiSeriy.begin());
+    }
+
+    IndeksSeriy indeks;
+    indeks.uslovie = uslovie;
+    indeks.smeshenie = smeshenie;
+    for (size_t i = 0; i < count; i++) {
+        dopisatVIndeksSeriy(indeks, i);
+    }
+    indeksiSeriy.push_back(std::move(indeks));
+    return indeksiSeriy.back();
+}
+
+void SlozhniyPrognoz::dopisatVIndeksKart(size_t index) {
+    int kod = ProstoyPrognoz::kodStatusa(prognozi[index].getStatus());
+    if (kod >= 0) indeksKart.poStatusam[kod].ustanovit(index);
+    if (prognozi[index].oshibka()) indeksKart.oshibki.ustanovit(index);
+}
+
+void SlozhniyPrognoz::postroitIndeksKart() {
     sortDates();
+    if (indeksKart.valid) return;
 
+    for (BitovayaKarta& karta : indeksKart.poStatusam) {
+        karta.clear();
+    }
+    indeksKart.oshibki.clear();
+
+    // Статусы и ошибки берутся из столбцов блока, ошибки - одной маской на блок
+    Yadra::Kolonki kolonki;
+    uint64_t maska[Yadra::SLOV_MASKI];
+    for (size_t nachalo = 0; nachalo < count; nachalo += Yadra::RAZMER_BLOKA) {
+        size_t razmer = std::min(Yadra::RAZMER_BLOKA, count - nachalo);
+        kolonki.zapolnit(prognozi + nachalo, razmer);
+        Yadra::maskaOshibok(kolonki, maska);
+        for (size_t i = 0; i < razmer; i++) {
+            if (kolonki.status[i] >= 0) indeksKart.poStatusam[kolonki.status[i]].ustanovit(nachalo + i);
+        }
+        for (size_t w = 0; w < (razmer + 63) / 64; w++) {
+            for (uint64_t slovo = maska[w]; slovo != 0; slovo &= slovo - 1) {
+                indeksKart.oshibki.ustanovit(nachalo + w * 64 + std::countr_zero(slovo));
+            }
+        }
+    }
+    indeksKart.valid = true;
+}
+
+const BitovayaKarta& SlozhniyPrognoz::kartaStatusa(const std::string& status) {
+    int kod = ProstoyPrognoz::kodStatusa(status);
+    if (kod < 0) throw std::out_of_range("Unknown status: " + status);
+    postroitIndeksKart();
+    return indeksKart.poStatusam[kod];
+}
+
+const BitovayaKarta& SlozhniyPrognoz::kartaOshibok() {
+    postroitIndeksKart();
+    return indeksKart.oshibki;
+}
+
+void SlozhniyPrognoz::poziciiDiapazona(long long dateStart, long long dateEnd, size_t& nachalo, size_t& konets) {
+    sortDates();
+    nachalo = konets = 0;
+    if (dateStart <= dateEnd) granitsiDiapazona(dateStart, dateEnd, nachalo, konets);
+}
+
+size_t SlozhniyPrognoz::poschitatStatus(const std::string& status, long long dateStart, long long dateEnd) {
+    const BitovayaKarta& karta = kartaStatusa(status);
+    size_t nachalo, konets;
+    poziciiDiapazona(dateStart, dateEnd, nachalo, konets);
+    return karta.kolvo(nachalo, konets);
+}
+
+size_t SlozhniyPrognoz::poschitatOshibki(long long dateStart, long long dateEnd) {
+    const BitovayaKarta& karta = kartaOshibok();
+    size_t nachalo, konets;
+    poziciiDiapazona(dateStart, dateEnd, nachalo, konets);
+    return karta.kolvo(nachalo, konets);
+}
+
+std::map<long long, size_t> SlozhniyPrognoz::poschitatStatusPoMesyatsam(const std::string& status, long long smeshenie) {
+    const BitovayaKarta& karta = kartaStatusa(status);
+    std::map<long long, size_t> rezultat;
+
+    // Границы месяцев - двоичным поиском от начала очередного месяца
     size_t i = 0;
-    while (i < count - 1) {
-        if (prognozi[i] == prognozi[i + 1]) {
-            prognozi[i] += prognozi[i + 1];
+    while (i < count) {
+        long long klyuch = Kalendar::klyuchMesyatsa(prognozi[i].getDate(), smeshenie);
+        long long konetsMesyatsa = Kalendar::nachaloMesyatsa(klyuch + 1, smeshenie);
+        size_t j = std::lower_bound(prognozi + i, prognozi + count, konetsMesyatsa,
+            [](const ProstoyPrognoz& p, long long d) {
+                return p.getDate() < d;
+            }) - prognozi;
+        rezultat[klyuch] = karta.kolvo(i, j);
+        i = j;
+    }
+    return rezultat;
+}
 
-            remove(i + 1);
+std::vector<SlozhniyPrognoz::Seriya> SlozhniyPrognoz::getSerii(const UslovieSerii& uslovie, long long dateStart, long long dateEnd, long long smeshenie) {
+    const IndeksSeriy& indeks = indeksSeriy(uslovie, smeshenie);
+    std::vector<Seriya> rezultat;
+    if (dateStart > dateEnd) return rezultat;
+
+    auto it = std::lower_bound(indeks.serii.begin(), indeks.serii.end(), dateStart,
+        [](const Seriya& s, long long d) {
+            return s.konets < d;
+        });
+    for (; it != indeks.serii.end() && it->nachalo <= dateEnd; ++it) {
+        rezultat.push_back(*it);
+    }
+    return rezultat;
+}
+
+SlozhniyPrognoz::Seriya SlozhniyPrognoz::getSamayaDlinnayaSeriya(const UslovieSerii& uslovie, long long dateStart, long long dateEnd, long long smeshenie) {
+    const IndeksSeriy& indeks = indeksSeriy(uslovie, smeshenie);
+    const std::vector<Seriya>& serii = indeks.serii;
+
+    size_t nachalo = 0;
+    size_t konets = 0;
+    if (dateStart <= dateEnd) {
+        granitsiDiapazona(dateStart, dateEnd, nachalo, konets);
+    }
+
+    // Серии [r1, r2), пересекающиеся с позициями [nachalo, konets)
+    size_t r1 = std::lower_bound(serii.begin(), serii.end(), nachalo,
+        [](const Seriya& s, size_t i) {
+            return s.posledniy < i;
+        }) - serii.begin();
+    size_t r2 = std::lower_bound(serii.begin(), serii.end(), konets,
+        [](const Seriya& s, size_t i) {
+            return s.pervyy < i;
+        }) - serii.begin();
+
+    if (nachalo >= konets || r1 >= r2) {
+        throw std::logic_error("No streaks found in your date range");
+    }
+
+    // Крайние серии обрезаются по периоду
+    auto obrezat = [&](Seriya s) {
+        s.pervyy = std::max(s.pervyy, nachalo);
+        s.posledniy = std::min(s.posledniy, konets - 1);
+        s.nachalo = prognozi[s.pervyy].getDate();
+        s.konets = prognozi[s.posledniy].getDate();
+        s.dney = Kalendar::denIzDati(s.konets, smeshenie) - Kalendar::denIzDati(s.nachalo, smeshenie) + 1;
+        return s;
+    };
+
+    Seriya luchshaya = obrezat(serii[r1]);
+    if (r2 - r1 > 2) {
+        // Внутренние серии целиком лежат в периоде: максимум по разреженной таблице за O(1)
+        size_t a = r1 + 1;
+        size_t b = r2 - 2;
+        size_t k = std::bit_width(b - a + 1) - 1;
+        size_t i1 = indeks.tablitsa[k][a];
+        size_t i2 = indeks.tablitsa[k][b + 1 - ((size_t)1 << k)];
+        size_t vnutr = (serii[i2].dney > serii[i1].dney) ? i2 : i1;
+        if (serii[vnutr].dney > luchshaya.dney) {
+            luchshaya = serii[vnutr];
         }
-        else {
+    }
+    if (r2 - r1 > 1) {
+        Seriya poslednyaya = obrezat(serii[r2 - 1]);
+        if (poslednyaya.dney > luchshaya.dney) {
+            luchshaya = poslednyaya;
+        }
+    }
+    return luchshaya;
+}
+
+template <class Vektor>
+size_t SlozhniyPrognoz::primenitFiltr(const Filtr& filtr, Vektor* indeksi, std::pmr::memory_resource* vremennaya) const {
+    if (filtr.nizhnyaya() > filtr.verhnyaya()) return 0;
+
+    size_t nachalo = 0;
+    size_t konets = 0;
+    granitsiDiapazona(filtr.nizhnyaya(), filtr.verhnyaya(), nachalo, konets);
+
+    std::pmr::vector<uint32_t> vibor(Filtr::RAZMER_BLOKA, vremennaya);
+    std::pmr::vector<std::pmr::vector<uint32_t>> bufer(vremennaya);
+    size_t kolvo = 0;
+
+    // Блоки выровнены по ZonnayaKarta::RAZMER_BLOKA, чтобы каждому соответствовала одна зона
+    for (size_t b = nachalo / ZonnayaKarta::RAZMER_BLOKA; b * ZonnayaKarta::RAZMER_BLOKA < konets; b++) {
+        if (indeksZon.valid && !filtr.mozhetPodoyti(indeksZon.karta[b])) continue;
+        size_t blok = std::max(nachalo, b * ZonnayaKarta::RAZMER_BLOKA);
+        size_t razmer = std::min((b + 1) * ZonnayaKarta::RAZMER_BLOKA, konets) - blok;
+        size_t n = filtr.otobratBlok(prognozi + blok, razmer, vibor.data(), bufer);
+        kolvo += n;
+        if (indeksi != nullptr) {
+            for (size_t i = 0; i < n; i++) {
+                indeksi->push_back(blok + vibor[i]);
+            }
+        }
+    }
+    return kolvo;
+}
+
+std::vector<size_t> SlozhniyPrognoz::nayti(const Filtr& filtr) const {
+    std::vector<size_t> indeksi;
+    primenitFiltr(filtr, &indeksi, std::pmr::get_default_resource());
+    return indeksi;
+}
+
+std::pmr::vector<size_t> SlozhniyPrognoz::nayti(const Filtr& filtr, std::pmr::memory_resource* resurs) const {
+    std::pmr::vector<size_t> indeksi(iliObshiy(resurs));
+    primenitFiltr(filtr, &indeksi, iliObshiy(resurs));
+    return indeksi;
+}
+
+size_t SlozhniyPrognoz::poschitat(const Filtr& filtr, std::pmr::memory_resource* vremennaya) const {
+    return primenitFiltr<std::vector<size_t>>(filtr, nullptr, iliObshiy(vremennaya));
+}
+
+std::vector<const ProstoyPrognoz*> SlozhniyPrognoz::vibrat(const Filtr& filtr) const {
+    std::vector<size_t> indeksi = nayti(filtr);
+    std::vector<const ProstoyPrognoz*> rezultat(indeksi.size());
+    for (size_t i = 0; i < indeksi.size(); i++) {
+        rezultat[i] = prognozi + indeksi[i];
+    }
+    return rezultat;
+}
+
+std::pmr::vector<const ProstoyPrognoz*> SlozhniyPrognoz::vibrat(const Filtr& filtr, std::pmr::memory_resource* resurs) const {
+    std::pmr::vector<size_t> indeksi = nayti(filtr, resurs);
+    std::pmr::vector<const ProstoyPrognoz*> rezultat(indeksi.size(), iliObshiy(resurs));
+    for (size_t i = 0; i < indeksi.size(); i++) {
+        rezultat[i] = prognozi + indeksi[i];
+    }
+    return rezultat;
+}
+
+void SlozhniyPrognoz::postroitZoni() {
+    if (indeksZon.valid) return;
+    indeksZon.karta.postroit(prognozi, count);
+    indeksZon.valid = true;
+}
+
+bool SlozhniyPrognoz::estLi(const Filtr& filtr) {
+    if (filtr.nizhnyaya() > filtr.verhnyaya()) return false;
+    sortDates();
+    postroitZoni();
+
+    size_t nachalo = 0;
+    size_t konets = 0;
+    granitsiDiapazona(filtr.nizhnyaya(), filtr.verhnyaya(), nachalo, konets);
+
+    std::vector<uint32_t> vibor(Filtr::RAZMER_BLOKA);
+    std::pmr::vector<std::pmr::vector<uint32_t>> bufer;
+    for (size_t b = nachalo / ZonnayaKarta::RAZMER_BLOKA; b * ZonnayaKarta::RAZMER_BLOKA < konets; b++) {
+        if (!filtr.mozhetPodoyti(indeksZon.karta[b])) continue;
+        size_t blok = std::max(nachalo, b * ZonnayaKarta::RAZMER_BLOKA);
+        size_t razmer = std::min((b + 1) * ZonnayaKarta::RAZMER_BLOKA, konets) - blok;
+        if (filtr.otobratBlok(prognozi + blok, razmer, vibor.data(), bufer) > 0) return true;
+    }
+    return false;
+}
+
+void SlozhniyPrognoz::sbrosIndeksov(bool kromeSumm) {
+    indeksMesyatsev.valid = false;
+    if (!kromeSumm) {
+        indeksSumm.valid = false;
+        indeksSumm.izmenennie.clear();
+    }
+    indeksiSeriy.clear();
+    indeksKart.valid = false;
+    indeksZon.valid = false;
+}
+
+void SlozhniyPrognoz::postroitIndeksMesyatsev(long long smeshenie) {
+    indeksMesyatsev.nachala.clear();
+    indeksMesyatsev.smeshenie = smeshenie;
+    indeksMesyatsev.valid = false;
+
+    if (count == 0) return;
+
+    long long pervyy = Kalendar::klyuchMesyatsa(prognozi[0].getDate(), smeshenie);
+    long long posledniy = Kalendar::klyuchMesyatsa(prognozi[count - 1].getDate(), smeshenie);
+    if (posledniy - pervyy >= MAKS_MESYATSEV_INDEKSA) return;
+
+    indeksMesyatsev.pervyyMesyats = pervyy;
+    indeksMesyatsev.nachala.reserve(posledniy - pervyy + 2);
+
+    // Идем по массиву один раз, сравнивая даты с началом следующего месяца
+    size_t i = 0;
+    for (long long k = pervyy; k <= posledniy; k++) {
+        long long nachalo = Kalendar::nachaloMesyatsa(k, smeshenie);
+        while (i < count && prognozi[i].getDate() < nachalo) {
             i++;
         }
+        indeksMesyatsev.nachala.push_back(i);
     }
+    indeksMesyatsev.nachala.push_back(count);
+    indeksMesyatsev.valid = true;
 }
 
-SlozhniyPrognoz SlozhniyPrognoz::getMonth(long long date) const {
-    SlozhniyPrognoz podmnozh;
 
-    time_t rawtime = (time_t)date;
-    struct tm start;
-    localtime_s(&start, &rawtime);
+//Пакетные запросы
+std::vector<size_t> SlozhniyPrognoz::poryadokPoDate() const {
+    std::vector<size_t> poryadok;
+    poryadokPoDate(poryadok);
+    return poryadok;
+}
 
-    start.tm_mday = 1;
-    start.tm_hour = 0;
-    start.tm_min = 0;
-    start.tm_sec = 0;
+void SlozhniyPrognoz::poryadokPoDate(std::vector<size_t>& poryadok) const {
+    poryadok.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        poryadok[i] = i;
+    }
 
-    long long startMonth = (long long)mktime(&start);
+    if (!sortedStatus) {
+        std::stable_sort(poryadok.begin(), poryadok.end(), [this](size_t a, size_t b) {
+            return prognozi[a].getDate() < prognozi[b].getDate();
+        });
+    }
+}
 
-    start.tm_mon += 1;
-    long long endMonth = (long long)mktime(&start);
+std::vector<size_t> SlozhniyPrognoz::getColdestDays(const std::vector<std::pair<long long, long long>>& diapazoni) const {
+    std::vector<size_t> otveti(diapazoni.size(), NE_NAYDENO);
+    if (count == 0) return otveti;
 
+    std::vector<size_t> poryadok = poryadokPoDate();
 
+    std::vector<long long> dati(count);
+    std::vector<double> srednie(count);
     for (size_t i = 0; i < count; i++) {
-        long long datePrognoz = prognozi[i].getDate();
+        dati[i] = prognozi[poryadok[i]].getDate();
+        srednie[i] = prognozi[i].getAverageTemp();
+    }
 
-        if (datePrognoz >= startMonth && datePrognoz < endMonth) {
-            podmnozh += prognozi[i];
+    // Кто холоднее из двух индексов массива (при равенстве - меньший индекс)
+    auto luchshiy = [&](size_t a, size_t b) {
+        if (a == NE_NAYDENO) return b;
+        if (b == NE_NAYDENO) return a;
+        if (srednie[a] < srednie[b]) return a;
+        if (srednie[b] < srednie[a]) return b;
+        return std::min(a, b);
+    };
+
+    // Дерево отрезков снизу вверх: листья derevo[count + i] = poryadok[i]
+    std::vector<size_t> derevo(2 * count);
+    for (size_t i = 0; i < count; i++) {
+        derevo[count + i] = poryadok[i];
+    }
+    for (size_t v = count - 1; v > 0; v--) {
+        derevo[v] = luchshiy(derevo[2 * v], derevo[2 * v + 1]);
+    }
+
+    for (size_t q = 0; q < diapazoni.size(); q++) {
+        size_t l = std::lower_bound(dati.begin(), dati.end(), diapazoni[q].first) - dati.begin();
+        size_t r = std::upper_bound(dati.begin(), dati.end(), diapazoni[q].second) - dati.begin();
+
+        size_t otvet = NE_NAYDENO;
+        for (l += count, r += count; l < r; l /= 2, r /= 2) {
+            if (l & 1) otvet = luchshiy(otvet, derevo[l++]);
+            if (r & 1) otvet = luchshiy(otvet, derevo[--r]);
+        }
+        otveti[q] = otvet;
+    }
+
+    return otveti;
+}
+
+std::vector<size_t> SlozhniyPrognoz::getNextSunnyDays(const std::vector<long long>& dates) const {
+    std::vector<size_t> otveti(dates.size(), NE_NAYDENO);
+
+    std::vector<size_t> solnechnie;
+    for (size_t i : poryadokPoDate()) {
+        if (prognozi[i].getStatus() == "Sunny") {
+            solnechnie.push_back(i);
+        }
+    }
+
+    for (size_t q = 0; q < dates.size(); q++) {
+        auto it = std::lower_bound(solnechnie.begin(), solnechnie.end(), dates[q], [this](size_t i, long long date) {
+            return prognozi[i].getDate() < date;
+        });
+        if (it != solnechnie.end()) {
+            otveti[q] = *it;
+        }
+    }
+
+    return otveti;
+}
+
+std::vector<SlozhniyPrognoz> SlozhniyPrognoz::getMonths(const std::vector<long long>& dates, long long smeshenie, std::pmr::memory_resource* resurs) const {
+    std::vector<SlozhniyPrognoz> otveti;
+    otveti.reserve(dates.size());
+    std::vector<size_t> poryadok = poryadokPoDate();
+
+    auto poDate = [this](size_t i, long long date) {
+        return prognozi[i].getDate() < date;
+    };
+
+    for (size_t q = 0; q < dates.size(); q++) {
+        long long startMonth, endMonth;
+        Kalendar::granitsiMesyatsa(dates[q], smeshenie, startMonth, endMonth);
+
+        auto l = std::lower_bound(poryadok.begin(), poryadok.end(), startMonth, poDate);
+        auto r = std::lower_bound(l, poryadok.end(), endMonth, poDate);
+
+        SlozhniyPrognoz& otvet = otveti.emplace_back(resurs);
+        otvet.reserve(r - l);
+        for (auto it = l; it != r; ++it) {
+            otvet += prognozi[*it];
+        }
+        otvet.sortedStatus = true;
+    }
+
+    return otveti;
+}
+
+//Корутины. Все работают порциями по porciya элементов, между порциями отдают управление планировщику
+Zadacha<ProstoyPrognoz> SlozhniyPrognoz::getColdestDayAsync(long long dateStart, long long dateEnd, Planirovshik& planirovshik, size_t porciya) const {
+    if (count == 0) throw std::logic_error("Class is empty");
+    if (porciya == 0) porciya = 1;
+
+    size_t coldest = 0;
+    bool found = false;
+    double minimum = 0.0;
+
+    for (size_t nachalo = 0; nachalo < count; nachalo += porciya) {
+        size_t konets = std::min(count, nachalo + porciya);
+
+        for (size_t i = nachalo; i < konets; i++) {
+            long long date = prognozi[i].getDate();
+
+            if (date >= dateStart && date <= dateEnd) {
+                double average = prognozi[i].getAverageTemp();
+
+                if (!found || (average < minimum)) {
+                    minimum = average;
+                    coldest = i;
+                    found = true;
+                }
+            }
+        }
+
+        if (konets < count) {
+            co_await planirovshik.ustupit();
+        }
+    }
+
+    if (!found) {
+        throw std::logic_error("No forecasts found in your date range");
+    }
+
+    co_return prognozi[coldest];
+}
+
+Zadacha<ProstoyPrognoz> SlozhniyPrognoz::getNextSunnyDayAsync(long long currentDate, Planirovshik& planirovshik, size_t porciya) const {
+    if (porciya == 0) porciya = 1;
+
+    size_t next = 0;
+    bool found = false;
+
+    for (size_t nachalo = 0; nachalo < count; nachalo += porciya) {
+        size_t konets = std::min(count, nachalo + porciya);
+
+        for (size_t i = nachalo; i < konets; i++) {
+            if (prognozi[i].getDate() >= currentDate && prognozi[i].getStatus() == "Sunny") {
+                if (!found || ((prognozi[i] <=> prognozi[next]) < 0)) {
+                    next = i;
+                    found = true;
+                }
+            }
+        }
+
+        if (konets < count) {
+            co_await planirovshik.ustupit();
+        }
+    }
+
+    if (!found) throw std::logic_error("No sunny days found");
+    co_return prognozi[next];
+}
+
+Zadacha<SlozhniyPrognoz> SlozhniyPrognoz::getMonthAsync(long long date, Planirovshik& planirovshik, size_t porciya, long long smeshenie) const {
+    if (porciya == 0) porciya = 1;
+
+    SlozhniyPrognoz podmnozh;
+
+    long long startMonth, endMonth;
+    Kalendar::granitsiMesyatsa(date, smeshenie, startMonth, endMonth);
+
+    for (size_t nachalo = 0; nachalo < count; nachalo += porciya) {
+        size_t konets = std::min(count, nachalo + porciya);
+
+        for (size_t i = nachalo; i < konets; i++) {
+            long long datePrognoz = prognozi[i].getDate();
+
+            if (datePrognoz >= startMonth && datePrognoz < endMonth) {
+                podmnozh += prognozi[i];
+            }
+        }
+
+        if (konets < count) {
+            co_await planirovshik.ustupit();
         }
     }
 
     podmnozh.sortDates();
-    return podmnozh;
-}
\ No newline at end of file
+    co_return podmnozh;
+}
+
+Zadacha<void> SlozhniyPrognoz::mergePovtorkiAsync(Planirovshik& planirovshik, size_t porciya) {
+    if (count < 2) co_return;
+    if (porciya == 0) porciya = 1;
+
+    sortDates();
+    sbrosIndeksov();
+    co_await planirovshik.ustupit();
+
+    // Сжатие на месте: zapis - куда пишем очередной уникальный день, i - что читаем
+    size_t zapis = 0;
+    for (size_t nachalo = 1; nachalo < count; nachalo += porciya) {
+        size_t konets = std::min(count, nachalo + porciya);
+
+        for (size_t i = nachalo; i < konets; i++) {
+            if (prognozi[zapis] == prognozi[i]) {
+                prognozi[zapis] += prognozi[i];
+            }
+            else {
+                zapis++;
+                if (zapis != i) {
+                    prognozi[zapis] = std::move(prognozi[i]);
+                }
+            }
+        }
+
+        if (konets < count) {
+            co_await planirovshik.ustupit();
+        }
+    }
+
+    count = zapis + 1;
+    perestroitSvodki();
+}
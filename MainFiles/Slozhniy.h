@@ -1,18 +1,45 @@
 ﻿#pragma once
 #include "Prostoy.h"
+#include "Zadacha.h"
+#include "Kalendar.h"
+#include "ChasovoyPoyas.h"
+#include "Kvantili.h"
+#include "Filtr.h"
+#include "BitovayaKarta.h"
+#include "ZonnayaKarta.h"
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Класс-контейнер для управления массивом прогнозов погоды.
  * * Представляет собой динамический массив (аналог std::vector), который хранит
  * объекты класса ProstoyPrognoz. Реализует логику добавления, удаления,
  * сортировки, поиска и фильтрации прогнозов.
- * Управляет динамической памятью (Правило 5).
+ * Управляет динамической памятью (Правило 5). Память берется из std::pmr::memory_resource
+ * (по умолчанию - общий), поэтому результаты запросов (getMonth, nayti) и их временные
+ * буферы можно выделять в арене запроса (например std::pmr::monotonic_buffer_resource)
+ * и освобождать все разом, когда запрос обработан.
+ * До VSTROENNAYA_EMKOST прогнозов (недельный прогноз станции, выборка за короткий период)
+ * хранятся прямо в объекте, без выделения памяти; в кучу массив переносится только при росте сверх этого.
+ * Поэтому, в отличие от std::vector, перемещение такого объекта переносит сами прогнозы:
+ * span из getMonthView и указатели из vibrat на элементы источника становятся недействительными.
  */
 class SlozhniyPrognoz
 {
+public:
+
+    /// @brief Сколько прогнозов хранится в самом объекте без выделения памяти.
+    static constexpr size_t VSTROENNAYA_EMKOST = 16;
+
 private:
 
-    /// @brief Указатель на динамический массив прогнозов.
+    /// @brief Указатель на массив прогнозов (во встроенном буфере vstroenniy или в памяти resurs).
     ProstoyPrognoz* prognozi;
 
     /// @brief Текущее количество элементов в массиве.
@@ -24,6 +51,263 @@ private:
     /// @brief Флаг, указывающий, отсортирован ли массив по дате (для оптимизации).
     bool sortedStatus;
 
+    /// @brief Источник памяти для массива прогнозов (не владеет им).
+    std::pmr::memory_resource* resurs = std::pmr::get_default_resource();
+
+    /// @brief Встроенный буфер: массив из не более VSTROENNAYA_EMKOST прогнозов размещается здесь.
+    alignas(ProstoyPrognoz) unsigned char vstroenniy[VSTROENNAYA_EMKOST * sizeof(ProstoyPrognoz)];
+
+    /// @brief Начало встроенного буфера как массива прогнозов.
+    ProstoyPrognoz* vstroenniyMassiv() {
+        return std::launder(reinterpret_cast<ProstoyPrognoz*>(vstroenniy));
+    }
+
+    /// @brief Лежит ли массив во встроенном буфере.
+    bool vstroen() const {
+        return prognozi == reinterpret_cast<const ProstoyPrognoz*>(vstroenniy);
+    }
+
+    /**
+     * @brief Забирает массив другого объекта (для перемещения). Массив из встроенного буфера
+     * переносится поэлементно, из кучи или арены - вместе с указателем. Источник памяти не меняет:
+     * массив other должен лежать во встроенном буфере или быть выделен из того же resurs.
+     * count и индексы не трогает; other остается без массива.
+     * @param other Объект, у которого забирается массив.
+     */
+    void zabratMassiv(SlozhniyPrognoz& other) noexcept;
+
+    /**
+     * @brief Создает массив из n прогнозов по умолчанию: во встроенном буфере, если n не больше
+     * VSTROENNAYA_EMKOST (буфер должен быть свободен), иначе в resurs.
+     * @param n Количество элементов (больше 0).
+     * @return Указатель на массив.
+     */
+    ProstoyPrognoz* vydelit(size_t n);
+
+    /**
+     * @brief Разрушает массив из n прогнозов и возвращает память в resurs (кроме встроенного буфера).
+     * @param p Массив (nullptr - ничего не делает).
+     * @param n Количество элементов.
+     */
+    void osvobodit(ProstoyPrognoz* p, size_t n);
+
+    /**
+     * @brief Индекс "месяц -> [начало, конец)" по отсортированному массиву.
+     * * nachala[k] - позиция первого прогноза месяца pervyyMesyats + k (ключ Kalendar::klyuchMesyatsa),
+     * последний элемент nachala равен count. Действителен только пока массив отсортирован
+     * и не изменялся (см. sbrosIndeksov). При добавлении в конец по порядку дат дополняется.
+     */
+    struct IndeksMesyatsev {
+        /// @brief Начала месяцев (плотно, по одному на каждый месяц диапазона) и count в конце.
+        std::vector<size_t> nachala;
+        /// @brief Ключ первого месяца индекса.
+        long long pervyyMesyats = 0;
+        /// @brief Смещение часового пояса, для которого построен индекс.
+        long long smeshenie = 0;
+        /// @brief Флаг, что индекс соответствует текущему содержимому массива.
+        bool valid = false;
+    };
+
+    /// @brief Индекс месяцев для getMonthView.
+    IndeksMesyatsev indeksMesyatsev;
+
+public:
+
+    /**
+     * @brief Накопленная сводка за месяц (см. vklyuchitSvodki).
+     */
+    struct SvodkaMesyatsa {
+        /// @brief Количество прогнозов за месяц.
+        size_t kolvo = 0;
+        /// @brief Сумма средних дневных температур (getAverageTemp).
+        double summaTemp = 0.0;
+        /// @brief Сумма осадков.
+        double summaOsadkov = 0.0;
+        /// @brief Количество прогнозов с каждым статусом (по номеру ProstoyPrognoz::kodStatusa).
+        size_t poStatusam[ProstoyPrognoz::KOLVO_STATUSOV] = {};
+        /// @brief Количество ошибочных прогнозов (oshibka()).
+        size_t oshibok = 0;
+
+        /// @brief Средняя температура за месяц (0, если прогнозов нет).
+        double srednyayaTemp() const {
+            return kolvo > 0 ? summaTemp / (double)kolvo : 0.0;
+        }
+    };
+
+private:
+
+    /**
+     * @brief Поддерживаемые помесячные сводки.
+     * * Обновляются за O(1) при +=, remove() и записи через operator[].
+     * operator[] не может знать, что запишут по ссылке, поэтому при выдаче ссылки вклад
+     * прогноза вычитается, а индекс запоминается в izmenennie. Вклад возвращается
+     * (уже с новыми значениями) в primenitIzmeneniya() перед следующим запросом или изменением порядка.
+     * После этого индекс снова попадает в izmenennie только при новом обращении к operator[].
+     */
+    struct Svodki {
+        /// @brief Включено ли ведение сводок.
+        bool vklyucheni = false;
+        /// @brief Смещение часового пояса для определения месяца.
+        long long smeshenie = 0;
+        /// @brief Сводки по ключу месяца (Kalendar::klyuchMesyatsa).
+        std::unordered_map<long long, SvodkaMesyatsa> poMesyatsam;
+        /// @brief Индексы, выданные через неконстантный operator[], вклад которых сейчас вычтен.
+        std::unordered_set<size_t> izmenennie;
+    };
+
+    /// @brief Помесячные сводки.
+    Svodki svodki;
+
+    /**
+     * @brief Добавляет (znak = 1) или вычитает (znak = -1) вклад прогноза в сводку его месяца.
+     * @param p Прогноз.
+     * @param znak 1 или -1.
+     */
+    void uchestVSvodke(const ProstoyPrognoz& p, int znak);
+
+    /// @brief Возвращает в сводки вклад прогнозов, измененных через operator[].
+    void primenitIzmeneniya();
+
+    /// @brief Пересчитывает сводки с нуля за O(n) (после массовых изменений, например mergePovtorki).
+    void perestroitSvodki();
+
+public:
+
+    /**
+     * @brief Условие, которому должны удовлетворять дни серии (getSerii, getSamayaDlinnayaSeriya).
+     */
+    struct UslovieSerii {
+        /// @brief Вид условия.
+        enum class Vid {
+            /// @brief Статус прогноза равен status.
+            Status,
+            /// @brief Хотя бы одна из температур ниже porog (заморозки).
+            NizhePoroga,
+            /// @brief Хотя бы одна из температур выше porog (жара).
+            VishePoroga
+        };
+
+        /// @brief Вид условия.
+        Vid vid = Vid::Status;
+        /// @brief Статус для Vid::Status.
+        std::string status = "Sunny";
+        /// @brief Порог температуры для NizhePoroga и VishePoroga (°C).
+        double porog = 0.0;
+
+        /// @brief Серия дней с заданным статусом (например "Sunny" - сухие дни).
+        static UslovieSerii poStatusu(const std::string& status) {
+            return UslovieSerii{ Vid::Status, status, 0.0 };
+        }
+
+        /// @brief Серия морозных дней (хотя бы одна температура ниже porog).
+        static UslovieSerii moroz(double porog = 0.0) {
+            return UslovieSerii{ Vid::NizhePoroga, "", porog };
+        }
+
+        /// @brief Серия жарких дней (хотя бы одна температура выше porog).
+        static UslovieSerii zhara(double porog = 30.0) {
+            return UslovieSerii{ Vid::VishePoroga, "", porog };
+        }
+
+        /// @brief Проверяет, удовлетворяет ли прогноз условию.
+        bool vipolneno(const ProstoyPrognoz& p) const;
+
+        bool operator == (const UslovieSerii& other) const = default;
+    };
+
+    /**
+     * @brief Серия подряд идущих календарных дней, удовлетворяющих условию.
+     * Пропущенный день (без прогноза) прерывает серию.
+     */
+    struct Seriya {
+        /// @brief Дата первого прогноза серии.
+        long long nachalo = 0;
+        /// @brief Дата последнего прогноза серии.
+        long long konets = 0;
+        /// @brief Позиция первого прогноза серии (для operator[], до изменения массива).
+        size_t pervyy = 0;
+        /// @brief Позиция последнего прогноза серии.
+        size_t posledniy = 0;
+        /// @brief Длина серии в днях.
+        long long dney = 0;
+    };
+
+    /// @brief Вид индекса сумм (getSummi).
+    enum class TipIndeksaSumm {
+        /// @brief Префиксные суммы: запрос O(log n) на поиск границ и O(1) на суммы, запись через [] сбрасывает индекс.
+        Prefiksniy,
+        /// @brief Дерево Фенвика: запрос O(log n), запись через [] учитывается точечным обновлением O(log n).
+        Fenwick
+    };
+
+    /// @brief Суммы за период (результат getSummi).
+    struct SummiZaPeriod {
+        /// @brief Количество прогнозов за период.
+        size_t kolvo = 0;
+        /// @brief Сумма осадков.
+        double osadki = 0.0;
+        /// @brief Градусо-дни отопительного периода: сумма max(0, база - средняя температура).
+        double gradusoDniOtopleniya = 0.0;
+        /// @brief Градусо-дни охлаждения: сумма max(0, средняя температура - база).
+        double gradusoDniOhlazhdeniya = 0.0;
+    };
+
+    /// @brief Базовая температура для градусо-дней по умолчанию (°C).
+    static constexpr double BAZOVAYA_TEMP = 18.0;
+
+private:
+
+    /**
+     * @brief Индекс нарастающих сумм осадков и градусо-дней по отсортированному массиву.
+     * * Для Prefiksniy столбцы - обычные префиксные суммы (stolbets[i] - сумма первых i прогнозов),
+     * для Fenwick - деревья Фенвика (нумерация с 1). Действителен, пока массив отсортирован
+     * и не менялся (см. sbrosIndeksov), при добавлении в конец по порядку дат дополняется.
+     * Дерево Фенвика переживает запись через operator[]: позиция запоминается в izmenennie
+     * и обновляется перед следующим запросом.
+     */
+    struct IndeksSumm {
+        /// @brief Вид индекса.
+        TipIndeksaSumm tip = TipIndeksaSumm::Prefiksniy;
+        /// @brief Базовая температура для градусо-дней.
+        double bazaTemp = BAZOVAYA_TEMP;
+        /// @brief Нарастающие суммы осадков.
+        std::vector<double> osadki;
+        /// @brief Нарастающие суммы градусо-дней отопления.
+        std::vector<double> otoplenie;
+        /// @brief Нарастающие суммы градусо-дней охлаждения.
+        std::vector<double> ohlazhdenie;
+        /// @brief Позиции, выданные через неконстантный operator[] (только для Fenwick).
+        std::vector<size_t> izmenennie;
+        /// @brief Флаг, что индекс соответствует текущему содержимому массива.
+        bool valid = false;
+    };
+
+    /// @brief Индекс сумм для getSummi.
+    IndeksSumm indeksSumm;
+
+    /// @brief Строит индекс сумм по отсортированному массиву за O(n).
+    void postroitIndeksSumm();
+
+    /**
+     * @brief Дописывает в индекс сумм прогноз, добавленный в конец массива.
+     * @param index Позиция прогноза (равна размеру индекса).
+     */
+    void dopisatVIndeksSumm(size_t index);
+
+    /**
+     * @brief Сумма первых i элементов столбца индекса сумм.
+     * @param stolbets Столбец (osadki, otoplenie или ohlazhdenie).
+     * @param i Количество элементов.
+     * @return Сумма.
+     */
+    double summaPervih(const std::vector<double>& stolbets, size_t i) const;
+
+    /**
+     * @brief Учитывает в дереве Фенвика записи через operator[].
+     * Если запись нарушила порядок дат, индекс сбрасывается, иначе массив снова считается отсортированным.
+     */
+    void primenitIzmeneniyaSumm();
+
 
     /**
      * @brief Внутренний метод для перевыделения памяти.
@@ -33,8 +317,301 @@ private:
      */
     void reserve(size_t newCapacity);
 
+    /**
+     * @brief Параллельная устойчивая сортировка по дате.
+     * * Массив делится на куски по числу потоков, каждый кусок сортируется в своем потоке,
+     * затем куски попарно сливаются. Каждое слияние тоже делится между потоками
+     * (разбиение по выходным позициям двоичным поиском).
+     * @param potokov Количество потоков (не меньше 2).
+     * @param vremennaya Источник памяти для буфера слияния.
+     */
+    void sortDatesParallel(size_t potokov, std::pmr::memory_resource* vremennaya);
+
+    /**
+     * @brief Параллельное объединение повторов без предварительной сортировки.
+     * * Индексы прогнозов раскладываются по разделам по хэшу даты, каждый раздел
+     * объединяется в своем потоке (в исходном порядке прогнозов), затем результаты
+     * собираются обратно и сортируются по дате.
+     * Рабочие потоки выделяют свои разделы из общей памяти: арена обычно не потокобезопасна.
+     * @param potokov Количество потоков (не меньше 2).
+     * @param vremennaya Источник памяти для буферов, выделяемых в вызывающем потоке.
+     */
+    void mergePovtorkiParallel(size_t potokov, std::pmr::memory_resource* vremennaya);
+
+    /**
+     * @brief Возвращает индексы прогнозов, упорядоченные по дате.
+     * При равных датах индексы идут по возрастанию. Если массив отсортирован, это просто 0..count-1.
+     * @return Перестановка индексов массива.
+     */
+    std::vector<size_t> poryadokPoDate() const;
+
+    /**
+     * @brief Записывает индексы прогнозов, упорядоченные по дате, в переданный массив (см. poryadokPoDate()).
+     * @param poryadok Сюда записывается перестановка (память переиспользуется).
+     */
+    void poryadokPoDate(std::vector<size_t>& poryadok) const;
+
+    /**
+     * @brief Помечает все вспомогательные индексы как устаревшие.
+     * Вызывается из каждого метода, который меняет прогнозы или их порядок.
+     * Новый индекс достаточно сбросить здесь - все пути изменения проходят через этот метод.
+     * @param kromeSumm true - дерево Фенвика индекса сумм сохраняется (оно учитывает
+     * изменения точечно через indeksSumm.izmenennie), остальные индексы сбрасываются.
+     */
+    void sbrosIndeksov(bool kromeSumm = false);
+
+    /**
+     * @brief Строит индекс месяцев по отсортированному массиву за O(n + число месяцев).
+     * @param smeshenie Смещение часового пояса в секундах.
+     */
+    void postroitIndeksMesyatsev(long long smeshenie);
+
+    /**
+     * @brief Отрезок отсортированного массива с датами в [dateStart, dateEnd). Двоичный поиск.
+     * @param dateStart Начало (включительно).
+     * @param dateEnd Конец (не включительно).
+     * @return Представление на часть массива.
+     */
+    std::span<const ProstoyPrognoz> otrezokDat(long long dateStart, long long dateEnd) const;
+
+    /**
+     * @brief Копирует прогнозы с датами в [startMonth, endMonth), упорядоченные по дате.
+     * @param startMonth Начало (включительно).
+     * @param endMonth Конец (не включительно).
+     * @param resurs Источник памяти для результата (nullptr - общий).
+     * @return Новый объект с выборкой.
+     */
+    SlozhniyPrognoz vyborka(long long startMonth, long long endMonth, std::pmr::memory_resource* resurs) const;
+
+    /**
+     * @brief Границы просмотра для запроса по диапазону дат.
+     * Для отсортированного массива - точный отрезок (двоичный поиск), иначе весь массив.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param nachalo Сюда записывается первый индекс для просмотра.
+     * @param konets Сюда записывается индекс за последним для просмотра.
+     */
+    void granitsiDiapazona(long long dateStart, long long dateEnd, size_t& nachalo, size_t& konets) const;
+
+    /**
+     * @brief Индекс серий для одного условия по отсортированному массиву.
+     * * Хранит границы всех серий и разреженную таблицу максимумов их длин: самая длинная
+     * серия среди любых подряд идущих серий находится за O(1). При добавлении в конец
+     * по порядку дат индекс дополняется за O(log числа серий).
+     */
+    struct IndeksSeriy {
+        /// @brief Условие серий.
+        UslovieSerii uslovie;
+        /// @brief Смещение часового пояса, по которому определяются сутки.
+        long long smeshenie = 0;
+        /// @brief Серии в порядке дат.
+        std::vector<Seriya> serii;
+        /// @brief tablitsa[k][i] - номер самой длинной серии среди serii[i .. i + 2^k).
+        std::vector<std::vector<size_t>> tablitsa;
+    };
+
+    /// @brief Индексы серий для недавно запрошенных условий (сбрасываются в sbrosIndeksov).
+    std::vector<IndeksSeriy> indeksiSeriy;
+
+    /// @brief Сколько индексов серий хранится одновременно.
+    static constexpr size_t MAKS_INDEKSOV_SERIY = 8;
+
+    /**
+     * @brief Находит индекс серий для условия или строит его по отсортированному массиву за O(n).
+     * @param uslovie Условие.
+     * @param smeshenie Смещение часового пояса в секундах.
+     * @return Ссылка на индекс (действительна до следующего изменения массива).
+     */
+    const IndeksSeriy& indeksSeriy(const UslovieSerii& uslovie, long long smeshenie);
+
+    /**
+     * @brief Учитывает прогноз в конце массива: продлевает последнюю серию или начинает новую.
+     * @param indeks Индекс серий.
+     * @param index Позиция прогноза (последняя в массиве).
+     */
+    void dopisatVIndeksSeriy(IndeksSeriy& indeks, size_t index) const;
+
+    /**
+     * @brief Пересчитывает ячейки разреженной таблицы, которые заканчиваются последней серией.
+     * @param indeks Индекс серий.
+     * @param novaya true, если последняя серия только что добавлена (ячейки дописываются).
+     */
+    static void obnovitKonetsTablitsy(IndeksSeriy& indeks, bool novaya);
+
+    /**
+     * @brief Битовые карты позиций отсортированного массива: по одной на известный статус и одна для ошибочных.
+     * При добавлении в конец по порядку дат дополняются, при remove сдвигаются вслед за массивом.
+     */
+    struct IndeksKart {
+        /// @brief Позиции прогнозов с каждым статусом (номер = ProstoyPrognoz::kodStatusa).
+        BitovayaKarta poStatusam[ProstoyPrognoz::KOLVO_STATUSOV];
+        /// @brief Позиции ошибочных прогнозов (oshibka()).
+        BitovayaKarta oshibki;
+        /// @brief Соответствуют ли карты массиву.
+        bool valid = false;
+    };
+
+    /// @brief Битовые карты статусов и ошибок.
+    IndeksKart indeksKart;
+
+    /// @brief Строит битовые карты по отсортированному массиву (ошибки - пакетным ядром Yadra), если они устарели.
+    void postroitIndeksKart();
+
+    /**
+     * @brief Учитывает прогноз в конце массива в битовых картах.
+     * @param index Позиция прогноза (последняя в массиве).
+     */
+    void dopisatVIndeksKart(size_t index);
+
+    /**
+     * @brief Зоны блоков массива по позициям (не требуют сортировки).
+     * При любом добавлении в конец дополняются, при изменении, удалении и сортировке сбрасываются.
+     */
+    struct IndeksZon {
+        /// @brief Зональная карта массива.
+        ZonnayaKarta karta;
+        /// @brief Соответствует ли карта массиву.
+        bool valid = false;
+    };
+
+    /// @brief Зоны блоков для пропуска при фильтрации.
+    IndeksZon indeksZon;
+
+    /**
+     * @brief Проверяет прогнозы фильтром блоками по Filtr::RAZMER_BLOKA.
+     * Для отсортированного массива просматриваются только даты в границах фильтра.
+     * Если зоны построены (postroitZoni), блоки, в которых условие заведомо не выполняется, пропускаются.
+     * @param filtr Фильтр.
+     * @tparam Vektor std::vector<size_t> или std::pmr::vector<size_t>.
+     * @param indeksi Сюда дописываются индексы подходящих прогнозов (nullptr - только подсчет).
+     * @param vremennaya Источник памяти для буферов фильтра.
+     * @return Количество подходящих прогнозов.
+     */
+    template <class Vektor>
+    size_t primenitFiltr(const Filtr& filtr, Vektor* indeksi, std::pmr::memory_resource* vremennaya) const;
+
 public:
 
+    /// @brief Размер массива, начиная с которого sortDates() сортирует в несколько потоков.
+    static constexpr size_t POROG_PARALLELNOY_SORTIROVKI = 50000;
+
+    /// @brief Размер неотсортированного массива, начиная с которого mergePovtorki() работает в несколько потоков.
+    static constexpr size_t POROG_PARALLELNOGO_SLIYANIYA = 50000;
+
+    /// @brief Максимальный охват индекса месяцев (10000 лет). Для более широкого разброса дат используется двоичный поиск.
+    static constexpr long long MAKS_MESYATSEV_INDEKSA = 12 * 10000;
+
+    /// @brief Тип временного окна для группировки (gruppirovat).
+    enum class TipOkna {
+        /// @brief Неделя с понедельника по воскресенье.
+        Nedelya,
+        /// @brief Декада: 1-10, 11-20, 21-конец месяца.
+        Dekada,
+        /// @brief Календарный месяц.
+        Mesyats,
+        /// @brief Метеорологический сезон (декабрь-февраль, март-май, июнь-август, сентябрь-ноябрь).
+        Sezon,
+        /// @brief Календарный год.
+        God
+    };
+
+    /// @brief Величина, по которой упорядочиваются прогнозы в topK.
+    enum class Klyuch {
+        /// @brief Средняя температура (getAverageTemp).
+        SrednyayaTemp,
+        /// @brief Утренняя температура.
+        Utro,
+        /// @brief Дневная температура.
+        Den,
+        /// @brief Вечерняя температура.
+        Vecher,
+        /// @brief Осадки.
+        Osadki
+    };
+
+    /**
+     * @brief Значение величины для прогноза.
+     * @param p Прогноз.
+     * @param klyuch Величина.
+     * @return Значение.
+     */
+    static double znachenieKlyucha(const ProstoyPrognoz& p, Klyuch klyuch);
+
+    /// @brief Направление отбора в topK.
+    enum class Poryadok {
+        /// @brief k наименьших (самые холодные / сухие).
+        Naimenshie,
+        /// @brief k наибольших (самые теплые / влажные).
+        Naibolshie
+    };
+
+    /**
+     * @brief Результат группировки по окнам в виде столбцов (одна строка - одно непустое окно).
+     * Окна идут по возрастанию даты.
+     */
+    struct SvodkaOkon {
+        /// @brief Начало окна (включительно).
+        std::vector<long long> nachalo;
+        /// @brief Конец окна (не включительно).
+        std::vector<long long> konets;
+        /// @brief Количество прогнозов в окне.
+        std::vector<size_t> kolvo;
+        /// @brief Минимальная, максимальная и средняя утренняя температура.
+        std::vector<double> minUtro, maxUtro, srednUtro;
+        /// @brief Минимальная, максимальная и средняя дневная температура.
+        std::vector<double> minDen, maxDen, srednDen;
+        /// @brief Минимальная, максимальная и средняя вечерняя температура.
+        std::vector<double> minVecher, maxVecher, srednVecher;
+        /// @brief Сумма осадков.
+        std::vector<double> summaOsadkov;
+        /// @brief Худший статус окна (номер ProstoyPrognoz::kodStatusa, неизвестный считается "Sunny").
+        std::vector<int> hudshiyStatus;
+
+        /// @brief Количество окон.
+        size_t size() const {
+            return nachalo.size();
+        }
+    };
+
+    /**
+     * @brief Скользящие окна по дням (результат skolzyashieOkna) в виде столбцов.
+     * * Элемент k относится к k-му прогнозу в порядке дат. Окно прогноза - все прогнозы
+     * за его день и за (dney - 1) предыдущих календарных дней (пропущенные дни просто не дают вклада).
+     */
+    struct SkolzyashieOkna {
+        /// @brief Дата прогноза, для которого посчитано окно.
+        std::vector<long long> date;
+        /// @brief Количество прогнозов в окне.
+        std::vector<size_t> kolvo;
+        /// @brief Скользящее среднее, минимум и максимум средней температуры (getAverageTemp).
+        std::vector<double> srednTemp, minTemp, maxTemp;
+        /// @brief Скользящая сумма осадков.
+        std::vector<double> summaOsadkov;
+
+        /// @brief Количество окон (равно количеству прогнозов).
+        size_t size() const {
+            return date.size();
+        }
+
+    private:
+        friend class SlozhniyPrognoz;
+
+        /// @brief Рабочие массивы расчета: хранятся вместе с результатом, чтобы повторный вызов не выделял память.
+        struct Rabochie {
+            /// @brief Порядок прогнозов по дате (если массив не отсортирован).
+            std::vector<size_t> poryadok;
+            /// @brief Монотонные очереди индексов для минимума и максимума.
+            std::vector<size_t> ocheredMin, ocheredMax;
+            /// @brief Номера дней прогнозов в порядке дат.
+            std::vector<long long> dni;
+            /// @brief Средние температуры в порядке дат.
+            std::vector<double> temp;
+        } rabochie;
+    };
+
+    /// @brief Значение индекса в пакетных запросах, если для запроса ничего не найдено.
+    static constexpr size_t NE_NAYDENO = static_cast<size_t>(-1);
+
     /// @brief Конструктор по умолчанию. Создает пустой массив с нулевой вместимостью.
     SlozhniyPrognoz();
 
@@ -43,11 +620,20 @@ public:
      * Копирует данные из переданного массива в новый объект.
      * @param arr Указатель на исходный массив ProstoyPrognoz.
      * @param size Количество элементов в исходном массиве.
+     * @param resurs Источник памяти (nullptr - общий).
+     */
+    SlozhniyPrognoz(const ProstoyPrognoz* arr, size_t size, std::pmr::memory_resource* resurs = nullptr);
+
+    /**
+     * @brief Создает пустой массив, память которого берется из resurs.
+     * Источник должен жить дольше объекта (и всех объектов, которым он передан перемещением).
+     * @param resurs Источник памяти (nullptr - общий).
      */
-    SlozhniyPrognoz(const ProstoyPrognoz* arr, size_t size);
+    explicit SlozhniyPrognoz(std::pmr::memory_resource* resurs);
 
     /**
      * @brief Инициализирующий конструктор создания списка из одного прогноза.
+     * Прогноз размещается во встроенном буфере, память не выделяется.
      * @param prognoz Прогноз, который станет первым элементом списка.
      */
     SlozhniyPrognoz(const ProstoyPrognoz& prognoz);
@@ -55,13 +641,16 @@ public:
     /**
      * @brief Конструктор копирования.
      * Создает копию объекта (выделяет новую память и копирует все элементы).
+     * Емкость копии равна числу элементов, поэтому короткое содержимое ложится во встроенный буфер.
+     * Копия, как и в контейнерах std::pmr, получает общий источник памяти, а не источник оригинала.
      * @param other Объект, который нужно скопировать.
      */
     SlozhniyPrognoz(const SlozhniyPrognoz& other);
 
     /**
      * @brief Конструктор перемещения.
-     * Забирает ресурсы (указатель на память) у другого объекта, оставляя его пустым.
+     * Забирает ресурсы (указатель на память и ее источник) у другого объекта, оставляя его пустым.
+     * Массив из встроенного буфера переносится поэлементно (не больше VSTROENNAYA_EMKOST перемещений).
      * @param other r-value ссылка на временный объект.
      */
     SlozhniyPrognoz(SlozhniyPrognoz&& other) noexcept;
@@ -69,6 +658,11 @@ public:
     /// @brief Деструктор. Освобождает выделенную динамическую память.
     ~SlozhniyPrognoz();
 
+    /// @brief Возвращает источник памяти массива.
+    std::pmr::memory_resource* resursPamyati() const {
+        return resurs;
+    }
+
 
 
 
@@ -86,7 +680,8 @@ public:
     /**
      * @brief Оператор добавления элемента (аналог push_back).
      * Добавляет новый прогноз в конец списка. При необходимости увеличивает capacity.
-     * Сбрасывает флаг sortedStatus в false.
+     * Если дата нового прогноза меньше даты последнего, сбрасывает флаг sortedStatus в false.
+     * Добавление по порядку дат сохраняет индекс месяцев (он дополняется за O(1)).
      * @param newPrognoz Прогноз для добавления.
      * @return Ссылка на текущий объект.
      */
@@ -94,8 +689,12 @@ public:
 
     /**
      * @brief Оператор доступа по индексу (для чтения и записи).
+     * Индексы и сводки считают элемент измененным в момент выдачи ссылки, а учитывают новые значения
+     * при следующем запросе или изменении массива. Поэтому писать по ссылке можно только до следующего
+     * вызова любого другого метода: запись по сохраненной дольше ссылке не попадет в сводки и индексы.
+     * Для новой записи ссылку нужно взять заново.
      * @param index Индекс элемента (от 0 до count-1).
-     * @return Ссылка на элемент массива.
+     * @return Ссылка на элемент массива (для записи - до следующего вызова другого метода).
      * @throws std::out_of_range Если индекс выходит за пределы массива.
      */
     ProstoyPrognoz& operator [] (size_t index);
@@ -110,7 +709,7 @@ public:
 
     /**
      * @brief Оператор присваивания копированием.
-     * Удаляет старые данные и копирует данные из other.
+     * Удаляет старые данные и копирует данные из other (емкость - по числу элементов, как у копии).
      * @param other Объект-источник.
      * @return Ссылка на текущий объект.
      */
@@ -118,11 +717,13 @@ public:
 
     /**
      * @brief Оператор присваивания перемещением.
-     * Забирает память у other и очищает его.
+     * Забирает память у other и очищает его. Источник памяти остается своим (как у std::pmr::vector):
+     * если у other он другой, прогнозы перемещаются поэлементно в новый массив из своего источника.
      * @param other Объект-источник (r-value).
      * @return Ссылка на текущий объект.
+     * @throws std::bad_alloc Если источники памяти разные и свой не может выделить массив.
      */
-    SlozhniyPrognoz& operator = (SlozhniyPrognoz&& other) noexcept;
+    SlozhniyPrognoz& operator = (SlozhniyPrognoz&& other);
 
     /**
      * @brief Вывод всех прогнозов в поток.
@@ -157,7 +758,10 @@ public:
 
     /**
      * @brief Ищет самый холодный день в заданном диапазоне дат.
-     * Сравнивает прогнозы по средней температуре (getAverageTemp).
+     * Сравнивает прогнозы по средней температуре (getAverageTemp). Минимум ищется
+     * пакетным ядром по столбцам (Yadra::minimumSrednego), при равной температуре
+     * выбирается прогноз с меньшим индексом. Для отсортированного массива диапазон
+     * находится двоичным поиском.
      * @param dateStart Начало периода (включительно).
      * @param dateEnd Конец периода (включительно).
      * @return Копия найденного прогноза с минимальной температурой.
@@ -165,6 +769,192 @@ public:
      */
     ProstoyPrognoz getColdestDay(long long dateStart, long long dateEnd) const;
 
+    /**
+     * @brief Находит k прогнозов с наименьшим или наибольшим значением величины в диапазоне дат.
+     * * Отбор идет через ограниченную кучу из k индексов: O(m log k) для m прогнозов в диапазоне,
+     * прогнозы не копируются. Для отсортированного массива диапазон находится двоичным поиском.
+     * При равных значениях выше ставится прогноз с меньшим индексом.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param klyuch Величина для сравнения.
+     * @param k Сколько прогнозов вернуть.
+     * @param poryadok Наименьшие или наибольшие.
+     * @return Индексы прогнозов (для operator[]), от лучшего к худшему; меньше k, если прогнозов в диапазоне мало.
+     */
+    std::vector<size_t> topK(long long dateStart, long long dateEnd, Klyuch klyuch, size_t k, Poryadok poryadok) const;
+
+    /**
+     * @brief Строит скетч квантилей величины за диапазон дат за один проход.
+     * Процентили (например p5 / p50 / p95) затем берутся из скетча без сортировки данных.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param klyuch Величина (температура или осадки).
+     * @param k Параметр точности скетча.
+     * @return Скетч (пустой, если прогнозов в диапазоне нет).
+     */
+    EskizKvantiley eskizKvantiley(long long dateStart, long long dateEnd, Klyuch klyuch, size_t k = EskizKvantiley::K_PO_UMOLCHANIYU) const;
+
+    /**
+     * @brief Строит скетчи квантилей величины для каждого месяца за один проход.
+     * Скетчи можно дополнять новыми прогнозами (dobavit) и объединять по годам или станциям (obedinit).
+     * @param klyuch Величина (температура или осадки).
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @param k Параметр точности скетчей.
+     * @return Скетчи по ключу месяца (Kalendar::klyuchMesyatsa).
+     */
+    std::map<long long, EskizKvantiley> eskiziPoMesyatsam(Klyuch klyuch, long long smeshenie = 0, size_t k = EskizKvantiley::K_PO_UMOLCHANIYU) const;
+
+    /**
+     * @brief Выбирает вид индекса сумм и базовую температуру градусо-дней.
+     * Индекс строится заново при следующем вызове getSummi.
+     * @param tip Префиксные суммы или дерево Фенвика.
+     * @param bazaTemp Базовая температура (°C).
+     */
+    void nastroitIndeksSumm(TipIndeksaSumm tip, double bazaTemp = BAZOVAYA_TEMP);
+
+    /**
+     * @brief Суммы осадков и градусо-дней за период без просмотра прогнозов.
+     * * При первом вызове (или после изменений массива) упорядочивает массив и строит индекс за O(n),
+     * дальше каждый запрос - два двоичных поиска и разность нарастающих сумм.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @return Суммы за период.
+     */
+    SummiZaPeriod getSummi(long long dateStart, long long dateEnd);
+
+    /**
+     * @brief Возвращает все серии дней, удовлетворяющих условию, которые пересекаются с периодом.
+     * * Индекс серий строится один раз для условия (массив упорядочивается по дате),
+     * запрос - двоичный поиск по сериям. Серии возвращаются целиком, в том числе выходящие за период.
+     * @param uslovie Условие (например UslovieSerii::moroz()).
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Серии в порядке дат.
+     */
+    std::vector<Seriya> getSerii(const UslovieSerii& uslovie, long long dateStart, long long dateEnd, long long smeshenie = 0);
+
+    /**
+     * @brief Находит самую длинную серию дней, удовлетворяющих условию, внутри периода. O(log n).
+     * Серии на границах периода обрезаются по периоду. При равной длине выбирается более ранняя серия.
+     * @param uslovie Условие (например UslovieSerii::poStatusu("Sunny")).
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Серия (обрезанная по периоду).
+     * @throws std::logic_error Если в периоде нет ни одного подходящего дня.
+     */
+    Seriya getSamayaDlinnayaSeriya(const UslovieSerii& uslovie, long long dateStart, long long dateEnd, long long smeshenie = 0);
+
+    /**
+     * @brief Битовая карта позиций (в порядке дат) прогнозов со статусом.
+     * Карты строятся один раз (массив упорядочивается по дате) и поддерживаются при добавлении и удалении.
+     * Вместе с poziciiDiapazona позволяет считать сочетания условий: BitovayaKarta::kolvoI / kolvoIli.
+     * @param status Статус ("Sunny", "Cloudy", "Rain", "Snow").
+     * @return Ссылка на карту (действительна до следующего изменения массива).
+     * @throws std::out_of_range Если статус неизвестен.
+     */
+    const BitovayaKarta& kartaStatusa(const std::string& status);
+
+    /**
+     * @brief Битовая карта позиций (в порядке дат) ошибочных прогнозов (oshibka()).
+     * @return Ссылка на карту (действительна до следующего изменения массива).
+     */
+    const BitovayaKarta& kartaOshibok();
+
+    /**
+     * @brief Позиции отсортированного по дате массива с датами в [dateStart, dateEnd].
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param nachalo Сюда записывается первая позиция.
+     * @param konets Сюда записывается позиция за последней.
+     */
+    void poziciiDiapazona(long long dateStart, long long dateEnd, size_t& nachalo, size_t& konets);
+
+    /**
+     * @brief Количество прогнозов со статусом за период: двоичный поиск границ и popcount по карте.
+     * @param status Статус.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @return Количество.
+     * @throws std::out_of_range Если статус неизвестен.
+     */
+    size_t poschitatStatus(const std::string& status, long long dateStart, long long dateEnd);
+
+    /**
+     * @brief Количество ошибочных прогнозов за период.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @return Количество.
+     */
+    size_t poschitatOshibki(long long dateStart, long long dateEnd);
+
+    /**
+     * @brief Количество прогнозов со статусом по месяцам.
+     * @param status Статус.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Ключ месяца (Kalendar::klyuchMesyatsa) -> количество (только месяцы, где есть прогнозы).
+     * @throws std::out_of_range Если статус неизвестен.
+     */
+    std::map<long long, size_t> poschitatStatusPoMesyatsam(const std::string& status, long long smeshenie = 0);
+
+    /**
+     * @brief Находит прогнозы, удовлетворяющие фильтру.
+     * Пример: (Filtr::statusi({"Rain"}) && Filtr::sravnenie(Filtr::Pole::Vecher, Filtr::Operaciya::Menshe, 5.0)).
+     * Прогнозы читаются напрямую, без operator[], поэтому порядок и индексы массива не сбрасываются.
+     * @param filtr Фильтр.
+     * @return Индексы подходящих прогнозов по возрастанию.
+     */
+    std::vector<size_t> nayti(const Filtr& filtr) const;
+
+    /**
+     * @brief Считает прогнозы, удовлетворяющие фильтру (без выделения памяти под результат).
+     * @param filtr Фильтр.
+     * @param vremennaya Источник памяти для буферов фильтра (nullptr - общий).
+     * @return Количество подходящих прогнозов.
+     */
+    size_t poschitat(const Filtr& filtr, std::pmr::memory_resource* vremennaya = nullptr) const;
+
+    /**
+     * @brief Возвращает указатели на прогнозы, удовлетворяющие фильтру (без копирования прогнозов).
+     * Указатели действительны до следующего изменения массива.
+     * @param filtr Фильтр.
+     * @return Указатели в порядке индексов.
+     */
+    std::vector<const ProstoyPrognoz*> vibrat(const Filtr& filtr) const;
+
+    /**
+     * @brief Находит прогнозы, удовлетворяющие фильтру; результат и буферы фильтра выделяются в resurs.
+     * @param filtr Фильтр.
+     * @param resurs Источник памяти (например арена запроса).
+     * @return Индексы подходящих прогнозов по возрастанию.
+     */
+    std::pmr::vector<size_t> nayti(const Filtr& filtr, std::pmr::memory_resource* resurs) const;
+
+    /**
+     * @brief Возвращает указатели на прогнозы, удовлетворяющие фильтру; память берется из resurs.
+     * @param filtr Фильтр.
+     * @param resurs Источник памяти (например арена запроса).
+     * @return Указатели в порядке индексов.
+     */
+    std::pmr::vector<const ProstoyPrognoz*> vibrat(const Filtr& filtr, std::pmr::memory_resource* resurs) const;
+
+    /**
+     * @brief Строит зоны блоков (наименьшие и наибольшие значения полей), если они устарели. O(n).
+     * После этого nayti, poschitat и vibrat пропускают блоки, в которых условие заведомо
+     * не выполняется. Зоны дополняются при добавлении прогнозов и строятся заново после
+     * изменения через operator[], remove, сортировки и объединения.
+     */
+    void postroitZoni();
+
+    /**
+     * @brief Проверяет, есть ли хотя бы один прогноз, удовлетворяющий фильтру.
+     * Строит зоны блоков и останавливается на первом подходящем блоке.
+     * @param filtr Фильтр.
+     * @return true, если подходящий прогноз есть.
+     */
+    bool estLi(const Filtr& filtr);
+
     /**
      * @brief Находит первый солнечный день после указанной даты.
      * Ищет прогноз со статусом "Sunny" с датой > currentDate.
@@ -176,31 +966,192 @@ public:
 
     /**
      * @brief Удаляет ошибочные прогнозы из списка.
-     * Проходит по всему массиву и вызывает метод oshibka() для каждого элемента.
-     * Если прогноз ошибочный, он удаляется.
+     * Проверяет массив блоками пакетным ядром (Yadra::maskaOshibok, те же правила, что oshibka())
+     * и удаляет ошибочные прогнозы за один проход с сохранением порядка остальных.
      */
     void removeOshibki();
 
     /**
      * @brief Объединяет прогнозы с одинаковой датой.
      * Если найдены два прогноза с одной датой, они складываются (operator+= класса ProstoyPrognoz),
-     * результат сохраняется, а дубликат удаляется.
+     * результат сохраняется, а дубликат удаляется. Прогнозы одной даты складываются в порядке
+     * их следования в массиве. Большие неотсортированные массивы (от POROG_PARALLELNOGO_SLIYANIYA)
+     * объединяются в несколько потоков. После вызова массив отсортирован по дате.
+     * @param vremennaya Источник памяти для временных буферов (nullptr - общий), например арена запроса.
      */
-    void mergePovtorki();
+    void mergePovtorki(std::pmr::memory_resource* vremennaya = nullptr);
 
     /**
      * @brief Сортирует прогнозы по дате (по возрастанию).
-     * Использует алгоритм сортировки (bubble sort).
+     * Сортировка устойчивая: прогнозы с одинаковой датой сохраняют исходный порядок,
+     * поэтому mergePovtorki() объединяет их всегда в одной и той же последовательности.
+     * Для массивов от POROG_PARALLELNOY_SORTIROVKI элементов сортирует в несколько потоков.
      * Устанавливает флаг sortedStatus = true.
+     * @param vremennaya Источник памяти для буфера параллельного слияния (nullptr - общий).
      */
-    void sortDates();
+    void sortDates(std::pmr::memory_resource* vremennaya = nullptr);
 
     /**
      * @brief Создает выборку прогнозов за определенный месяц.
+     * Границы месяца вычисляются целочисленно (класс Kalendar), без localtime/mktime,
+     * поэтому метод можно безопасно вызывать из нескольких потоков.
      * @param date Любая дата, входящая в интересующий месяц и год.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @param resurs Источник памяти для результата (nullptr - общий), например арена запроса.
      * @return Новый объект SlozhniyPrognoz, содержащий только прогнозы того же месяца и года.
      */
-    SlozhniyPrognoz getMonth(long long date) const;
+    SlozhniyPrognoz getMonth(long long date, long long smeshenie = 0, std::pmr::memory_resource* resurs = nullptr) const;
+
+    /**
+     * @brief Возвращает прогнозы за месяц без копирования (представление на часть массива).
+     * * При необходимости сортирует массив и строит индекс месяцев, после чего каждый
+     * запрос месяца - O(1) без выделения памяти.
+     * Представление действительно до следующего изменения объекта.
+     * @param date Любая дата, входящая в интересующий месяц и год.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Непрерывный отрезок отсортированного массива (может быть пустым).
+     */
+    std::span<const ProstoyPrognoz> getMonthView(long long date, long long smeshenie = 0);
+
+    /**
+     * @brief Создает выборку прогнозов за местный месяц в заданном часовом поясе.
+     * Границы месяца берутся из таблицы переходов пояса (без вызова функций libc).
+     * @param date Любая дата, входящая в интересующий месяц и год.
+     * @param poyas Часовой пояс (например, загруженный из zoneinfo).
+     * @param resurs Источник памяти для результата (nullptr - общий).
+     * @return Новый объект SlozhniyPrognoz, содержащий только прогнозы того же местного месяца.
+     */
+    SlozhniyPrognoz getMonth(long long date, const ChasovoyPoyas& poyas, std::pmr::memory_resource* resurs = nullptr) const;
+
+    /**
+     * @brief Возвращает прогнозы за местный месяц в заданном часовом поясе без копирования.
+     * При необходимости сортирует массив, затем находит месяц двоичным поиском.
+     * Представление действительно до следующего изменения объекта.
+     * @param date Любая дата, входящая в интересующий месяц и год.
+     * @param poyas Часовой пояс.
+     * @return Непрерывный отрезок отсортированного массива (может быть пустым).
+     */
+    std::span<const ProstoyPrognoz> getMonthView(long long date, const ChasovoyPoyas& poyas);
+
+    /**
+     * @brief Группирует прогнозы по временным окнам за один проход по датам.
+     * * Для каждого непустого окна считает минимум, максимум и среднее трех температур,
+     * сумму осадков и худший статус (в порядке worstStatus). Если массив не отсортирован,
+     * порядок по дате строится во временном массиве индексов (сам объект не меняется).
+     * @param okno Тип окна (неделя, декада, месяц, сезон, год).
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Сводка по окнам в виде столбцов.
+     */
+    SvodkaOkon gruppirovat(TipOkna okno, long long smeshenie = 0) const;
+
+    /**
+     * @brief Считает скользящие окна длиной dney суток для каждого прогноза за O(n).
+     * * Суммы для среднего и осадков ведутся нарастающим итогом, минимум и максимум -
+     * монотонными очередями. Результат и рабочие массивы хранятся в переданном объекте: при
+     * повторном вызове с тем же объектом они не выделяются заново (если прогнозов не стало больше).
+     * Если массив не отсортирован, порядок по дате строится в рабочем массиве okna
+     * (std::stable_sort при этом может взять временный буфер).
+     * @param dney Длина окна в сутках (например 7 или 30).
+     * @param okna Сюда записывается результат.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @throws std::invalid_argument Если dney меньше 1.
+     */
+    void skolzyashieOkna(long long dney, SkolzyashieOkna& okna, long long smeshenie = 0) const;
+
+    /**
+     * @brief Включает ведение помесячных сводок.
+     * Сводки строятся за O(n), после чего обновляются за O(1) при каждом изменении.
+     * Суммы ведутся добавлением и вычитанием, поэтому возможна погрешность округления.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     */
+    void vklyuchitSvodki(long long smeshenie = 0);
+
+    /// @brief Выключает ведение помесячных сводок и освобождает память.
+    void viklyuchitSvodki();
+
+    /**
+     * @brief Возвращает сводку за месяц без просмотра прогнозов.
+     * @param date Любая дата, входящая в интересующий месяц и год.
+     * @return Сводка за месяц (пустая, если прогнозов за месяц нет).
+     * @throws std::logic_error Если сводки не включены (vklyuchitSvodki).
+     */
+    SvodkaMesyatsa getSvodkaMesyatsa(long long date);
+
+    /**
+     * @brief Пакетная версия getColdestDay для множества промежутков.
+     * * Один раз строит общий индекс (порядок по дате и дерево отрезков по средней температуре),
+     * после чего каждый промежуток обрабатывается за O(log n).
+     * При равной температуре выбирается прогноз с меньшим индексом, как и в getColdestDay.
+     * @param diapazoni Промежутки дат {начало, конец} (оба включительно).
+     * @return Для каждого промежутка индекс самого холодного прогноза или NE_NAYDENO.
+     */
+    std::vector<size_t> getColdestDays(const std::vector<std::pair<long long, long long>>& diapazoni) const;
+
+    /**
+     * @brief Пакетная версия getNextSunnyDay.
+     * Солнечные дни упорядочиваются один раз, каждый запрос - двоичный поиск.
+     * @param dates Текущие даты для каждого запроса.
+     * @return Для каждой даты индекс ближайшего солнечного прогноза или NE_NAYDENO.
+     */
+    std::vector<size_t> getNextSunnyDays(const std::vector<long long>& dates) const;
+
+    /**
+     * @brief Пакетная версия getMonth.
+     * Массив упорядочивается по дате один раз, каждый месяц находится двоичным поиском.
+     * @param dates Любая дата интересующего месяца для каждого запроса.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @param resurs Источник памяти для выборок (nullptr - общий).
+     * @return Выборки за каждый запрошенный месяц (в порядке запросов).
+     */
+    std::vector<SlozhniyPrognoz> getMonths(const std::vector<long long>& dates, long long smeshenie = 0, std::pmr::memory_resource* resurs = nullptr) const;
+
+
+
+
+
+
+    /**
+     * @brief Асинхронная версия getColdestDay (корутина).
+     * Просматривает массив порциями и после каждой порции уступает управление планировщику.
+     * Объект должен существовать до завершения задачи.
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @param planirovshik Планировщик, в котором выполняется запрос.
+     * @param porciya Количество элементов, обрабатываемых без уступки управления.
+     * @return Задача, результатом которой будет копия самого холодного прогноза.
+     * @throws std::logic_error (через задачу) Если подходящих дней нет, или массив пуст.
+     */
+    Zadacha<ProstoyPrognoz> getColdestDayAsync(long long dateStart, long long dateEnd, Planirovshik& planirovshik, size_t porciya = 4096) const;
+
+    /**
+     * @brief Асинхронная версия getNextSunnyDay (корутина).
+     * @param currentDate Дата, после которой начинать поиск.
+     * @param planirovshik Планировщик, в котором выполняется запрос.
+     * @param porciya Количество элементов, обрабатываемых без уступки управления.
+     * @return Задача, результатом которой будет найденный прогноз.
+     * @throws std::logic_error (через задачу) Если подходящих дней нет.
+     */
+    Zadacha<ProstoyPrognoz> getNextSunnyDayAsync(long long currentDate, Planirovshik& planirovshik, size_t porciya = 4096) const;
+
+    /**
+     * @brief Асинхронная версия getMonth (корутина).
+     * @param date Любая дата, входящая в интересующий месяц и год.
+     * @param planirovshik Планировщик, в котором выполняется запрос.
+     * @param porciya Количество элементов, обрабатываемых без уступки управления.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Задача, результатом которой будет выборка за месяц.
+     */
+    Zadacha<SlozhniyPrognoz> getMonthAsync(long long date, Planirovshik& planirovshik, size_t porciya = 4096, long long smeshenie = 0) const;
+
+    /**
+     * @brief Асинхронная версия mergePovtorki (корутина).
+     * Сортирует массив, затем объединяет повторы порциями, уступая управление между ними.
+     * До завершения задачи объект нельзя изменять или читать.
+     * @param planirovshik Планировщик, в котором выполняется операция.
+     * @param porciya Количество элементов, обрабатываемых без уступки управления.
+     * @return Задача без результата.
+     */
+    Zadacha<void> mergePovtorkiAsync(Planirovshik& planirovshik, size_t porciya = 4096);
 
 };
 
@@ -0,0 +1,533 @@
+﻿#include "Stancii.h"
+#include "Yadra.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+const std::string& HranilisheStanciy::idStancii(size_t nomer) const {
+    if (nomer >= stancii.size()) throw std::out_of_range("Index out of range");
+    return stancii[nomer].id;
+}
+
+size_t HranilisheStanciy::nomerStancii(const std::string& id) const {
+    auto it = poId.find(id);
+    return (it == poId.end()) ? SlozhniyPrognoz::NE_NAYDENO : it->second;
+}
+
+size_t HranilisheStanciy::nomerIliOshibka(const std::string& id) const {
+    size_t nomer = nomerStancii(id);
+    if (nomer == SlozhniyPrognoz::NE_NAYDENO) throw std::out_of_range("Unknown station: " + id);
+    return nomer;
+}
+
+std::vector<size_t> HranilisheStanciy::nomera(const std::vector<std::string>& ids) const {
+    std::vector<size_t> rezultat;
+    if (ids.empty()) {
+        rezultat.resize(stancii.size());
+        for (size_t i = 0; i < stancii.size(); i++) {
+            rezultat[i] = i;
+        }
+        return rezultat;
+    }
+
+    rezultat.reserve(ids.size());
+    for (const std::string& id : ids) {
+        rezultat.push_back(nomerIliOshibka(id));
+    }
+    return rezultat;
+}
+
+std::vector<std::string> HranilisheStanciy::idStanciy(const std::vector<size_t>& nomera) const {
+    std::vector<std::string> rezultat;
+    rezultat.reserve(nomera.size());
+    for (size_t nomer : nomera) {
+        rezultat.push_back(idStancii(nomer));
+    }
+    return rezultat;
+}
+
+size_t HranilisheStanciy::dobavitStanciyu(const std::string& id) {
+    auto it = poId.find(id);
+    if (it != poId.end()) return it->second;
+
+    Stanciya s;
+    s.id = id;
+    s.nachalo = zapisi.size();
+    stancii.push_back(s);
+    poId[id] = stancii.size() - 1;
+    return stancii.size() - 1;
+}
+
+void HranilisheStanciy::dobavit(const std::string& id, const ProstoyPrognoz& prognoz) {
+    size_t nomer = dobavitStanciyu(id);
+    novye.emplace_back(nomer, prognoz);
+}
+
+void HranilisheStanciy::dobavit(const std::string& id, const SlozhniyPrognoz& prognozi) {
+    size_t nomer = dobavitStanciyu(id);
+    novye.reserve(novye.size() + prognozi.size());
+    for (size_t i = 0; i < prognozi.size(); i++) {
+        novye.emplace_back(nomer, prognozi[i]);
+    }
+}
+
+void HranilisheStanciy::ustanovitKoordinati(const std::string& id, double shirota, double dolgota) {
+    if (!(shirota >= -90.0 && shirota <= 90.0 && dolgota >= -180.0 && dolgota <= 180.0)) {
+        throw std::invalid_argument("Coordinates out of range");
+    }
+    Stanciya& s = stancii[dobavitStanciyu(id)];
+    s.estKoordinati = true;
+    s.shirota = shirota;
+    s.dolgota = dolgota;
+    derevoGotovo = false;
+}
+
+bool HranilisheStanciy::getKoordinati(const std::string& id, double& shirota, double& dolgota) const {
+    const Stanciya& s = stancii[nomerIliOshibka(id)];
+    if (!s.estKoordinati) return false;
+    shirota = s.shirota;
+    dolgota = s.dolgota;
+    return true;
+}
+
+void HranilisheStanciy::postroitDerevo() {
+    if (derevoGotovo) return;
+
+    std::vector<KDDerevo::Tochka> tochki;
+    for (size_t i = 0; i < stancii.size(); i++) {
+        if (stancii[i].estKoordinati) {
+            tochki.push_back(KDDerevo::Tochka{ stancii[i].shirota, stancii[i].dolgota, i });
+        }
+    }
+    derevo = KDDerevo(tochki);
+    derevoGotovo = true;
+}
+
+std::vector<KDDerevo::Sosed> HranilisheStanciy::blizhayshieStancii(double shirota, double dolgota, size_t k) {
+    postroitDerevo();
+    return derevo.blizhayshie(shirota, dolgota, k);
+}
+
+std::vector<size_t> HranilisheStanciy::stanciiVPryamougolnike(double minShirota, double maxShirota, double minDolgota, double maxDolgota) {
+    postroitDerevo();
+    std::vector<size_t> rezultat = derevo.vPryamougolnike(minShirota, maxShirota, minDolgota, maxDolgota);
+    std::sort(rezultat.begin(), rezultat.end());
+    return rezultat;
+}
+
+void HranilisheStanciy::uplotnit() {
+    if (novye.empty()) return;
+
+    // Подсчет новых прогнозов по станциям и новые границы блоков
+    std::vector<size_t> dobavleno(stancii.size(), 0);
+    for (const auto& para : novye) {
+        dobavleno[para.first]++;
+    }
+
+    std::vector<ProstoyPrognoz> noviyMassiv(zapisi.size() + novye.size());
+    std::vector<size_t> vstavka(stancii.size());
+    size_t poziciya = 0;
+    for (size_t s = 0; s < stancii.size(); s++) {
+        std::copy_n(zapisi.begin() + stancii[s].nachalo, stancii[s].kolvo, noviyMassiv.begin() + poziciya);
+        vstavka[s] = poziciya + stancii[s].kolvo;
+        stancii[s].nachalo = poziciya;
+        poziciya += stancii[s].kolvo + dobavleno[s];
+    }
+
+    // Новые прогнозы дописываются в конец блоков в порядке добавления
+    for (auto& para : novye) {
+        noviyMassiv[vstavka[para.first]++] = std::move(para.second);
+    }
+
+    // Старая часть блока уже упорядочена: сортируется только новая часть и сливается со старой
+    auto poDate = [](const ProstoyPrognoz& a, const ProstoyPrognoz& b) {
+        return a.getDate() < b.getDate();
+    };
+    for (size_t s = 0; s < stancii.size(); s++) {
+        if (dobavleno[s] == 0) continue;
+
+        auto nachalo = noviyMassiv.begin() + stancii[s].nachalo;
+        auto seredina = nachalo + stancii[s].kolvo;
+        auto konets = seredina + dobavleno[s];
+        if (!std::is_sorted(seredina, konets, poDate)) {
+            std::stable_sort(seredina, konets, poDate);
+        }
+        if (seredina != nachalo && poDate(*seredina, *(seredina - 1))) {
+            std::inplace_merge(nachalo, seredina, konets, poDate);
+        }
+        stancii[s].kolvo += dobavleno[s];
+        stancii[s].zoni.postroit(&*nachalo, stancii[s].kolvo);
+    }
+
+    zapisi = std::move(noviyMassiv);
+    novye.clear();
+}
+
+std::span<const ProstoyPrognoz> HranilisheStanciy::getStanciya(const std::string& id) {
+    uplotnit();
+    const Stanciya& s = stancii[nomerIliOshibka(id)];
+    return std::span<const ProstoyPrognoz>(zapisi.data() + s.nachalo, s.kolvo);
+}
+
+SlozhniyPrognoz HranilisheStanciy::toSlozhniy(const std::string& id) {
+    std::span<const ProstoyPrognoz> blok = getStanciya(id);
+    SlozhniyPrognoz kopiya(blok.data(), blok.size());
+    kopiya.sortDates();  // Блок уже упорядочен - проверка за O(n)
+    return kopiya;
+}
+
+std::span<const ProstoyPrognoz> HranilisheStanciy::otrezok(size_t nomer, long long dateStart, long long dateEnd) const {
+    const ProstoyPrognoz* nachalo = zapisi.data() + stancii[nomer].nachalo;
+    const ProstoyPrognoz* konets = nachalo + stancii[nomer].kolvo;
+    if (dateStart > dateEnd) return {};
+
+    const ProstoyPrognoz* l = std::lower_bound(nachalo, konets, dateStart,
+        [](const ProstoyPrognoz& p, long long d) {
+            return p.getDate() < d;
+        });
+    const ProstoyPrognoz* r = std::upper_bound(l, konets, dateEnd,
+        [](long long d, const ProstoyPrognoz& p) {
+            return d < p.getDate();
+        });
+    return std::span<const ProstoyPrognoz>(l, r);
+}
+
+std::span<const ProstoyPrognoz> HranilisheStanciy::getMonthView(const std::string& id, long long date, long long smeshenie) {
+    uplotnit();
+    size_t nomer = nomerIliOshibka(id);
+
+    long long startMonth, endMonth;
+    Kalendar::granitsiMesyatsa(date, smeshenie, startMonth, endMonth);
+    return otrezok(nomer, startMonth, endMonth - 1);
+}
+
+const ProstoyPrognoz& HranilisheStanciy::prognoz(const Nahodka& nahodka) const {
+    if (nahodka.stanciya >= stancii.size() || nahodka.poziciya >= stancii[nahodka.stanciya].kolvo) {
+        throw std::out_of_range("Index out of range");
+    }
+    return zapisi[stancii[nahodka.stanciya].nachalo + nahodka.poziciya];
+}
+
+HranilisheStanciy::Nahodka HranilisheStanciy::getColdestDay(const std::vector<std::string>& ids, long long dateStart, long long dateEnd) {
+    uplotnit();
+
+    Nahodka luchshaya;
+    bool found = false;
+    double minimum = 0.0;
+
+    for (size_t nomer : nomera(ids)) {
+        std::span<const ProstoyPrognoz> blok = otrezok(nomer, dateStart, dateEnd);
+        size_t index = Yadra::minimumSrednego(blok.data(), blok.size(), dateStart, dateEnd, found, minimum);
+        if (index != Yadra::NET) {
+            luchshaya.stanciya = nomer;
+            luchshaya.poziciya = (blok.data() + index - zapisi.data()) - stancii[nomer].nachalo;
+        }
+    }
+
+    if (!found) {
+        throw std::logic_error("No forecasts found in your date range");
+    }
+    return luchshaya;
+}
+
+HranilisheStanciy::Nahodka HranilisheStanciy::getNextSunnyDay(const std::vector<std::string>& ids, long long currentDate) {
+    uplotnit();
+
+    Nahodka luchshaya;
+    bool found = false;
+    long long luchshayaData = 0;
+
+    for (size_t nomer : nomera(ids)) {
+        // Блок упорядочен: первый солнечный день после двоичного поиска - самый ранний на станции
+        std::span<const ProstoyPrognoz> blok = otrezok(nomer, currentDate, std::numeric_limits<long long>::max());
+        for (const ProstoyPrognoz& p : blok) {
+            if (found && p.getDate() >= luchshayaData) break;
+            if (p.getStatus() == "Sunny") {
+                luchshayaData = p.getDate();
+                luchshaya.stanciya = nomer;
+                luchshaya.poziciya = (&p - zapisi.data()) - stancii[nomer].nachalo;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    if (!found) {
+        throw std::logic_error("No sunny days found");
+    }
+    return luchshaya;
+}
+
+size_t HranilisheStanciy::primenitFiltr(size_t nomer, const Filtr& filtr, std::vector<Nahodka>* rezultat,
+    std::vector<uint32_t>& vibor, std::pmr::vector<std::pmr::vector<uint32_t>>& bufer) const {
+
+    std::span<const ProstoyPrognoz> blok = otrezok(nomer, filtr.nizhnyaya(), filtr.verhnyaya());
+    if (blok.empty()) return 0;
+    const ProstoyPrognoz* nachaloStancii = zapisi.data() + stancii[nomer].nachalo;
+    const ZonnayaKarta& zoni = stancii[nomer].zoni;
+    size_t l = blok.data() - nachaloStancii;
+    size_t r = l + blok.size();
+
+    // Части выровнены от начала блока станции, чтобы каждой соответствовала одна зона
+    size_t kolvo = 0;
+    for (size_t z = l / ZonnayaKarta::RAZMER_BLOKA; z * ZonnayaKarta::RAZMER_BLOKA < r; z++) {
+        if (!filtr.mozhetPodoyti(zoni[z])) continue;
+        size_t ot = std::max(l, z * ZonnayaKarta::RAZMER_BLOKA);
+        size_t razmer = std::min((z + 1) * ZonnayaKarta::RAZMER_BLOKA, r) - ot;
+        size_t n = filtr.otobratBlok(nachaloStancii + ot, razmer, vibor.data(), bufer);
+        kolvo += n;
+        if (rezultat != nullptr) {
+            for (size_t i = 0; i < n; i++) {
+                rezultat->push_back(Nahodka{ nomer, ot + vibor[i] });
+            }
+        }
+    }
+    return kolvo;
+}
+
+std::vector<HranilisheStanciy::Nahodka> HranilisheStanciy::nayti(const std::vector<std::string>& ids, const Filtr& filtr) {
+    uplotnit();
+
+    std::vector<Nahodka> rezultat;
+    std::vector<uint32_t> vibor(Filtr::RAZMER_BLOKA);
+    std::pmr::vector<std::pmr::vector<uint32_t>> bufer;
+
+    for (size_t nomer : nomera(ids)) {
+        primenitFiltr(nomer, filtr, &rezultat, vibor, bufer);
+    }
+    return rezultat;
+}
+
+size_t HranilisheStanciy::poschitat(const std::vector<std::string>& ids, const Filtr& filtr) {
+    uplotnit();
+
+    size_t kolvo = 0;
+    std::vector<uint32_t> vibor(Filtr::RAZMER_BLOKA);
+    std::pmr::vector<std::pmr::vector<uint32_t>> bufer;
+
+    for (size_t nomer : nomera(ids)) {
+        kolvo += primenitFiltr(nomer, filtr, nullptr, vibor, bufer);
+    }
+    return kolvo;
+}
+
+//Двоичный формат: числа в little-endian независимо от платформы
+static const char ZAGOLOVOK[4] = { 'F', 'C', 'S', 'T' };
+static constexpr uint32_t VERSIYA_FORMATA = 3;
+
+//Длина записи прогноза: дата, четыре числа double, номер статуса
+static constexpr uint64_t RAZMER_ZAPISI = 8 + 4 * 8 + 1;
+
+static void zapisatChislo(std::string& bufer, uint64_t x, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        bufer.push_back((char)((x >> (8 * i)) & 0xFF));
+    }
+}
+
+static void zapisatStroku(std::string& bufer, const std::string& s) {
+    zapisatChislo(bufer, s.size(), 4);
+    bufer += s;
+}
+
+static uint64_t chitatChislo(std::istream& input, size_t bytes) {
+    unsigned char b[8];
+    if (!input.read((char*)b, bytes)) throw std::runtime_error("Bad forecast store data");
+    uint64_t x = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        x |= (uint64_t)b[i] << (8 * i);
+    }
+    return x;
+}
+
+//Сколько байт осталось в потоке; false, если поток не поддерживает перемещение
+static bool ostatokPotoka(std::istream& input, uint64_t& ostatok) {
+    std::streampos tekushaya = input.tellg();
+    if (tekushaya == std::streampos(-1)) return false;
+    input.seekg(0, std::ios::end);
+    std::streampos konets = input.tellg();
+    if (!input || konets == std::streampos(-1) || konets < tekushaya) {
+        input.clear();
+        input.seekg(tekushaya);
+        return false;
+    }
+    input.seekg(tekushaya);
+    ostatok = (uint64_t)(konets - tekushaya);
+    return true;
+}
+
+static std::string chitatStroku(std::istream& input) {
+    uint64_t dlina = chitatChislo(input, 4);
+    if (dlina > (1u << 20)) throw std::runtime_error("Bad forecast store data");
+    std::string s(dlina, '\0');
+    if (dlina > 0 && !input.read(&s[0], dlina)) throw std::runtime_error("Bad forecast store data");
+    return s;
+}
+
+void HranilisheStanciy::sohranit(std::ostream& output) {
+    uplotnit();
+
+    std::string bufer(ZAGOLOVOK, 4);
+    zapisatChislo(bufer, VERSIYA_FORMATA, 4);
+
+    zapisatChislo(bufer, stancii.size(), 8);
+    for (const Stanciya& s : stancii) {
+        zapisatStroku(bufer, s.id);
+        zapisatChislo(bufer, s.nachalo, 8);
+        zapisatChislo(bufer, s.kolvo, 8);
+        zapisatChislo(bufer, s.estKoordinati ? 1 : 0, 1);
+        zapisatChislo(bufer, std::bit_cast<uint64_t>(s.shirota), 8);
+        zapisatChislo(bufer, std::bit_cast<uint64_t>(s.dolgota), 8);
+    }
+
+    // Таблица статусов: сначала известные (номер = kodStatusa), затем прочие встреченные строки
+    std::vector<std::string> statusi;
+    for (int i = 0; i < ProstoyPrognoz::KOLVO_STATUSOV; i++) {
+        statusi.push_back(ProstoyPrognoz::imyaStatusa(i));
+    }
+    std::unordered_map<std::string, size_t> prochie;
+    for (const ProstoyPrognoz& p : zapisi) {
+        if (ProstoyPrognoz::kodStatusa(p.getStatus()) < 0 && prochie.find(p.getStatus()) == prochie.end()) {
+            prochie[p.getStatus()] = statusi.size();
+            statusi.push_back(p.getStatus());
+        }
+    }
+    if (statusi.size() > 256) throw std::runtime_error("Too many distinct statuses");
+    zapisatChislo(bufer, statusi.size(), 4);
+    for (const std::string& s : statusi) {
+        zapisatStroku(bufer, s);
+    }
+
+    zapisatChislo(bufer, zapisi.size(), 8);
+    output.write(bufer.data(), bufer.size());
+
+    // Прогнозы пишутся порциями, чтобы не держать в памяти копию всего файла
+    const size_t PORCIYA = 4096;
+    for (size_t i = 0; i < zapisi.size(); i += PORCIYA) {
+        bufer.clear();
+        for (size_t j = i; j < std::min(zapisi.size(), i + PORCIYA); j++) {
+            const ProstoyPrognoz& p = zapisi[j];
+            int kod = ProstoyPrognoz::kodStatusa(p.getStatus());
+            zapisatChislo(bufer, (uint64_t)p.getDate(), 8);
+            zapisatChislo(bufer, std::bit_cast<uint64_t>(p.getMorningTemp()), 8);
+            zapisatChislo(bufer, std::bit_cast<uint64_t>(p.getDayTemp()), 8);
+            zapisatChislo(bufer, std::bit_cast<uint64_t>(p.getEveningTemp()), 8);
+            zapisatChislo(bufer, std::bit_cast<uint64_t>(p.getOsadki()), 8);
+            zapisatChislo(bufer, (kod >= 0) ? (uint64_t)kod : prochie[p.getStatus()], 1);
+        }
+        output.write(bufer.data(), bufer.size());
+    }
+
+    // Зоны блоков станций (количество прогнозов в зоне следует из длины блока)
+    bufer.clear();
+    for (const Stanciya& s : stancii) {
+        zapisatChislo(bufer, s.zoni.size(), 8);
+        for (size_t z = 0; z < s.zoni.size(); z++) {
+            const ZonnayaKarta::Zona& zona = s.zoni[z];
+            zapisatChislo(bufer, (uint64_t)zona.minDate, 8);
+            zapisatChislo(bufer, (uint64_t)zona.maxDate, 8);
+            for (int i = 0; i < ZonnayaKarta::KOLVO_POLEY; i++) {
+                zapisatChislo(bufer, std::bit_cast<uint64_t>(zona.min[i]), 8);
+                zapisatChislo(bufer, std::bit_cast<uint64_t>(zona.max[i]), 8);
+            }
+        }
+    }
+    output.write(bufer.data(), bufer.size());
+
+    if (!output) throw std::runtime_error("Cannot write forecast store");
+}
+
+HranilisheStanciy HranilisheStanciy::zagruzit(std::istream& input) {
+    char zagolovok[4];
+    if (!input.read(zagolovok, 4) || !std::equal(zagolovok, zagolovok + 4, ZAGOLOVOK)) {
+        throw std::runtime_error("Bad forecast store data");
+    }
+    uint64_t versiya = chitatChislo(input, 4);
+    if (versiya < 1 || versiya > VERSIYA_FORMATA) throw std::runtime_error("Unsupported forecast store version");
+
+    HranilisheStanciy hranilishe;
+    uint64_t kolvoStanciy = chitatChislo(input, 8);
+    size_t ozhidaemoeNachalo = 0;
+    for (uint64_t i = 0; i < kolvoStanciy; i++) {
+        Stanciya s;
+        s.id = chitatStroku(input);
+        s.nachalo = chitatChislo(input, 8);
+        s.kolvo = chitatChislo(input, 8);
+        if (versiya >= 2) {
+            s.estKoordinati = chitatChislo(input, 1) != 0;
+            s.shirota = std::bit_cast<double>(chitatChislo(input, 8));
+            s.dolgota = std::bit_cast<double>(chitatChislo(input, 8));
+            if (s.estKoordinati && !(s.shirota >= -90.0 && s.shirota <= 90.0 && s.dolgota >= -180.0 && s.dolgota <= 180.0)) {
+                throw std::runtime_error("Bad forecast store data");
+            }
+        }
+        // Блоки идут подряд без пропусков, идентификаторы не повторяются, сумма длин не переполняется
+        if (s.nachalo != ozhidaemoeNachalo || hranilishe.poId.count(s.id) > 0
+            || s.kolvo > std::numeric_limits<size_t>::max() - ozhidaemoeNachalo) {
+            throw std::runtime_error("Bad forecast store data");
+        }
+        ozhidaemoeNachalo += s.kolvo;
+        hranilishe.poId[s.id] = hranilishe.stancii.size();
+        hranilishe.stancii.push_back(std::move(s));
+    }
+
+    uint64_t kolvoStatusov = chitatChislo(input, 4);
+    if (kolvoStatusov > 256) throw std::runtime_error("Bad forecast store data");
+    std::vector<std::string> statusi;
+    for (uint64_t i = 0; i < kolvoStatusov; i++) {
+        statusi.push_back(chitatStroku(input));
+    }
+
+    uint64_t kolvoZapisey = chitatChislo(input, 8);
+    if (kolvoZapisey != ozhidaemoeNachalo) throw std::runtime_error("Bad forecast store data");
+
+    // Если длина потока известна, заявленное число записей должно в нем уместиться
+    uint64_t ostatok = 0;
+    if (ostatokPotoka(input, ostatok)) {
+        if (kolvoZapisey > ostatok / RAZMER_ZAPISI) throw std::runtime_error("Bad forecast store data");
+        hranilishe.zapisi.reserve(kolvoZapisey);
+    }
+
+    for (uint64_t i = 0; i < kolvoZapisey; i++) {
+        long long date = (long long)chitatChislo(input, 8);
+        double utro = std::bit_cast<double>(chitatChislo(input, 8));
+        double den = std::bit_cast<double>(chitatChislo(input, 8));
+        double vecher = std::bit_cast<double>(chitatChislo(input, 8));
+        double osadki = std::bit_cast<double>(chitatChislo(input, 8));
+        uint64_t status = chitatChislo(input, 1);
+        if (status >= statusi.size()) throw std::runtime_error("Bad forecast store data");
+        hranilishe.zapisi.emplace_back(date, utro, den, vecher, osadki, statusi[status]);
+    }
+
+    // Запросы рассчитывают на упорядоченность блоков по дате
+    for (const Stanciya& s : hranilishe.stancii) {
+        auto nachalo = hranilishe.zapisi.begin() + s.nachalo;
+        if (!std::is_sorted(nachalo, nachalo + s.kolvo)) {
+            throw std::runtime_error("Bad forecast store data");
+        }
+    }
+
+    // Зоны строятся заново по прочитанным прогнозам: неверная зона в файле скрыла бы подходящие записи.
+    // Зоны из файла версии 3 должны совпасть с построенными
+    for (Stanciya& s : hranilishe.stancii) {
+        s.zoni.postroit(hranilishe.zapisi.data() + s.nachalo, s.kolvo);
+        if (versiya < 3) continue;
+
+        uint64_t kolvoZon = chitatChislo(input, 8);
+        if (kolvoZon != s.zoni.size()) throw std::runtime_error("Bad forecast store data");
+        for (uint64_t z = 0; z < kolvoZon; z++) {
+            ZonnayaKarta::Zona zona;
+            zona.kolvo = s.zoni[z].kolvo;
+            zona.minDate = (long long)chitatChislo(input, 8);
+            zona.maxDate = (long long)chitatChislo(input, 8);
+            for (int i = 0; i < ZonnayaKarta::KOLVO_POLEY; i++) {
+                zona.min[i] = std::bit_cast<double>(chitatChislo(input, 8));
+                zona.max[i] = std::bit_cast<double>(chitatChislo(input, 8));
+            }
+            if (!(zona == s.zoni[z])) throw std::runtime_error("Bad forecast store data");
+        }
+    }
+
+    return hranilishe;
+}
@@ -0,0 +1,323 @@
+﻿#pragma once
+#include "Slozhniy.h"
+#include "Filtr.h"
+#include "KDDerevo.h"
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Хранилище прогнозов многих станций в одном массиве.
+ * * Прогнозы каждой станции лежат непрерывным блоком, упорядоченным по дате,
+ * а справочник станций хранит начало и длину блока. Поэтому запрос по одной станции -
+ * это срез массива, а запрос по набору станций (или по всем) - один проход
+ * по их блокам без копирования в отдельные SlozhniyPrognoz.
+ * Новые прогнозы сначала копятся отдельно и раскладываются по блокам
+ * одним проходом (uplotnit) перед следующим запросом.
+ * Станциям можно задать координаты: по ним строится k-d дерево (KDDerevo),
+ * которое отвечает на запросы "k ближайших станций" и "станции в прямоугольнике";
+ * найденные номера станций передаются в остальные запросы через idStanciy.
+ * Для блока каждой станции ведется зональная карта (ZonnayaKarta): nayti и poschitat
+ * пропускают части блока, в которых условие фильтра заведомо не выполняется.
+ * Хранилище сохраняется в двоичный формат (sohranit / zagruzit) вместе с зонами.
+ */
+class HranilisheStanciy
+{
+private:
+
+    /// @brief Запись справочника станций.
+    struct Stanciya {
+        /// @brief Идентификатор станции.
+        std::string id;
+        /// @brief Позиция первого прогноза станции в zapisi.
+        size_t nachalo = 0;
+        /// @brief Количество прогнозов станции (уже разложенных по блокам).
+        size_t kolvo = 0;
+        /// @brief Заданы ли координаты станции.
+        bool estKoordinati = false;
+        /// @brief Широта в градусах.
+        double shirota = 0.0;
+        /// @brief Долгота в градусах.
+        double dolgota = 0.0;
+        /// @brief Зоны блока станции (позиции от начала блока).
+        ZonnayaKarta zoni;
+    };
+
+    /// @brief Справочник станций в порядке их добавления.
+    std::vector<Stanciya> stancii;
+
+    /// @brief Номер станции по идентификатору.
+    std::unordered_map<std::string, size_t> poId;
+
+    /// @brief Прогнозы всех станций: блок станции i - [stancii[i].nachalo, + stancii[i].kolvo).
+    std::vector<ProstoyPrognoz> zapisi;
+
+    /// @brief Добавленные, но еще не разложенные по блокам прогнозы (номер станции, прогноз).
+    std::vector<std::pair<size_t, ProstoyPrognoz>> novye;
+
+    /// @brief Пространственный индекс станций с координатами (номер точки = номер станции).
+    KDDerevo derevo;
+
+    /// @brief Соответствует ли derevo текущим координатам станций.
+    bool derevoGotovo = false;
+
+    /// @brief Перестраивает derevo, если координаты менялись.
+    void postroitDerevo();
+
+    /**
+     * @brief Номера станций для запроса.
+     * @param ids Идентификаторы (пустой вектор - все станции).
+     * @return Номера станций.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    std::vector<size_t> nomera(const std::vector<std::string>& ids) const;
+
+    /**
+     * @brief Находит номер станции.
+     * @param id Идентификатор.
+     * @return Номер станции.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    size_t nomerIliOshibka(const std::string& id) const;
+
+    /**
+     * @brief Отрезок блока станции с датами в [dateStart, dateEnd] (двоичный поиск).
+     * @param nomer Номер станции.
+     * @param dateStart Начало (включительно).
+     * @param dateEnd Конец (включительно).
+     * @return Срез блока.
+     */
+    std::span<const ProstoyPrognoz> otrezok(size_t nomer, long long dateStart, long long dateEnd) const;
+
+public:
+
+    /// @brief Найденный прогноз: номер станции и позиция внутри ее блока.
+    struct Nahodka {
+        /// @brief Номер станции (см. idStancii).
+        size_t stanciya = 0;
+        /// @brief Позиция прогноза среди прогнозов станции (в порядке дат).
+        size_t poziciya = 0;
+    };
+
+    /// @brief Конструктор пустого хранилища.
+    HranilisheStanciy() = default;
+
+    /// @brief Возвращает количество станций.
+    size_t kolvoStanciy() const {
+        return stancii.size();
+    }
+
+    /// @brief Возвращает общее количество прогнозов (вместе с еще не разложенными).
+    size_t size() const {
+        return zapisi.size() + novye.size();
+    }
+
+    /**
+     * @brief Возвращает идентификатор станции по номеру.
+     * @param nomer Номер станции.
+     * @return Идентификатор.
+     * @throws std::out_of_range Если номер неверный.
+     */
+    const std::string& idStancii(size_t nomer) const;
+
+    /**
+     * @brief Находит номер станции по идентификатору.
+     * @param id Идентификатор.
+     * @return Номер станции или SlozhniyPrognoz::NE_NAYDENO.
+     */
+    size_t nomerStancii(const std::string& id) const;
+
+    /**
+     * @brief Идентификаторы станций по номерам (например результата blizhayshieStancii)
+     * для передачи в запросы по набору станций.
+     * @param nomera Номера станций.
+     * @return Идентификаторы в том же порядке.
+     * @throws std::out_of_range Если номер неверный.
+     */
+    std::vector<std::string> idStanciy(const std::vector<size_t>& nomera) const;
+
+    /**
+     * @brief Добавляет станцию без прогнозов (если ее еще нет).
+     * @param id Идентификатор.
+     * @return Номер станции.
+     */
+    size_t dobavitStanciyu(const std::string& id);
+
+    /**
+     * @brief Добавляет прогноз станции. Станция создается, если ее еще нет.
+     * @param id Идентификатор станции.
+     * @param prognoz Прогноз.
+     */
+    void dobavit(const std::string& id, const ProstoyPrognoz& prognoz);
+
+    /**
+     * @brief Добавляет все прогнозы массива к станции.
+     * @param id Идентификатор станции.
+     * @param prognozi Прогнозы.
+     */
+    void dobavit(const std::string& id, const SlozhniyPrognoz& prognozi);
+
+    /**
+     * @brief Задает координаты станции. Станция создается, если ее еще нет.
+     * @param id Идентификатор станции.
+     * @param shirota Широта в градусах [-90, 90].
+     * @param dolgota Долгота в градусах [-180, 180].
+     * @throws std::invalid_argument Если координаты вне допустимых пределов.
+     */
+    void ustanovitKoordinati(const std::string& id, double shirota, double dolgota);
+
+    /**
+     * @brief Возвращает координаты станции.
+     * @param id Идентификатор станции.
+     * @param shirota Сюда записывается широта.
+     * @param dolgota Сюда записывается долгота.
+     * @return false, если координаты станции не заданы.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    bool getKoordinati(const std::string& id, double& shirota, double& dolgota) const;
+
+    /**
+     * @brief Находит k ближайших к точке станций (среди станций с координатами).
+     * @param shirota Широта точки.
+     * @param dolgota Долгота точки.
+     * @param k Сколько станций найти.
+     * @return Номера станций и расстояния в километрах, по возрастанию расстояния.
+     */
+    std::vector<KDDerevo::Sosed> blizhayshieStancii(double shirota, double dolgota, size_t k);
+
+    /**
+     * @brief Находит станции в прямоугольнике широт и долгот (границы включительно).
+     * Если minDolgota > maxDolgota, прямоугольник проходит через 180-й меридиан.
+     * @param minShirota Южная граница.
+     * @param maxShirota Северная граница.
+     * @param minDolgota Западная граница.
+     * @param maxDolgota Восточная граница.
+     * @return Номера станций по возрастанию.
+     */
+    std::vector<size_t> stanciiVPryamougolnike(double minShirota, double maxShirota, double minDolgota, double maxDolgota);
+
+    /**
+     * @brief Раскладывает добавленные прогнозы по блокам станций за один проход.
+     * Блоки остаются упорядоченными по дате (устойчиво: прогнозы с равной датой - в порядке добавления).
+     * Вызывается автоматически перед запросами.
+     */
+    void uplotnit();
+
+    /**
+     * @brief Прогнозы станции, упорядоченные по дате, без копирования.
+     * Представление действительно до следующего изменения хранилища.
+     * @param id Идентификатор станции.
+     * @return Срез массива.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    std::span<const ProstoyPrognoz> getStanciya(const std::string& id);
+
+    /**
+     * @brief Копирует прогнозы станции в SlozhniyPrognoz (для любых запросов этого класса).
+     * @param id Идентификатор станции.
+     * @return Массив прогнозов станции, упорядоченный по дате.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    SlozhniyPrognoz toSlozhniy(const std::string& id);
+
+    /**
+     * @brief Прогнозы станции за месяц без копирования.
+     * @param id Идентификатор станции.
+     * @param date Любая дата месяца.
+     * @param smeshenie Смещение часового пояса в секундах (по умолчанию 0 - UTC).
+     * @return Срез массива.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    std::span<const ProstoyPrognoz> getMonthView(const std::string& id, long long date, long long smeshenie = 0);
+
+    /**
+     * @brief Возвращает найденный прогноз.
+     * @param nahodka Результат запроса.
+     * @return Ссылка на прогноз (действительна до следующего изменения хранилища).
+     */
+    const ProstoyPrognoz& prognoz(const Nahodka& nahodka) const;
+
+    /**
+     * @brief Самый холодный день (по средней температуре) на наборе станций за один проход.
+     * При равной температуре выбирается станция с меньшим номером и более ранний прогноз.
+     * @param ids Идентификаторы станций (пустой вектор - все станции).
+     * @param dateStart Начало периода (включительно).
+     * @param dateEnd Конец периода (включительно).
+     * @return Найденный прогноз.
+     * @throws std::logic_error Если подходящих дней нет.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    Nahodka getColdestDay(const std::vector<std::string>& ids, long long dateStart, long long dateEnd);
+
+    /**
+     * @brief Ближайший солнечный день с датой не раньше currentDate на наборе станций.
+     * @param ids Идентификаторы станций (пустой вектор - все станции).
+     * @param currentDate Дата, с которой начинать поиск.
+     * @return Найденный прогноз (самый ранний; при равенстве - станция с меньшим номером).
+     * @throws std::logic_error Если подходящих дней нет.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    Nahodka getNextSunnyDay(const std::vector<std::string>& ids, long long currentDate);
+
+    /**
+     * @brief Находит прогнозы набора станций, удовлетворяющие фильтру.
+     * Блок каждой станции сужается по границам дат фильтра двоичным поиском,
+     * части блока с неподходящими зонами пропускаются.
+     * @param ids Идентификаторы станций (пустой вектор - все станции).
+     * @param filtr Фильтр.
+     * @return Найденные прогнозы по станциям и датам.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    std::vector<Nahodka> nayti(const std::vector<std::string>& ids, const Filtr& filtr);
+
+    /**
+     * @brief Считает прогнозы набора станций, удовлетворяющие фильтру.
+     * @param ids Идентификаторы станций (пустой вектор - все станции).
+     * @param filtr Фильтр.
+     * @return Количество.
+     * @throws std::out_of_range Если станция не найдена.
+     */
+    size_t poschitat(const std::vector<std::string>& ids, const Filtr& filtr);
+
+    /**
+     * @brief Сохраняет хранилище в двоичном виде.
+     * * Формат (little-endian): заголовок "FCST", версия, справочник станций
+     * (идентификатор, начало и длина блока, координаты), таблица статусов, затем прогнозы
+     * записями фиксированной длины (дата, три температуры, осадки, номер статуса),
+     * поэтому прогноз можно найти по смещению без разбора предыдущих. После прогнозов
+     * (с версии 3) идут зоны блоков станций: количество и для каждой зоны промежуток дат
+     * и наименьшие / наибольшие значения полей (для проверки файла при загрузке).
+     * @param output Поток (открытый в двоичном режиме).
+     * @throws std::runtime_error Если запись не удалась.
+     */
+    void sohranit(std::ostream& output);
+
+    /**
+     * @brief Загружает хранилище из двоичного вида (см. sohranit).
+     * Зоны строятся заново по прочитанным прогнозам; зоны из файла версии 3 должны с ними совпасть.
+     * Читаются и версии 1 (без координат станций) и 2 (без зон).
+     * @param input Поток (открытый в двоичном режиме).
+     * @return Хранилище.
+     * @throws std::runtime_error Если данные имеют неверный формат или зона не совпадает с прогнозами.
+     */
+    static HranilisheStanciy zagruzit(std::istream& input);
+
+private:
+
+    /**
+     * @brief Проверяет фильтром блок станции по частям ZonnayaKarta::RAZMER_BLOKA,
+     * пропуская части, зона которых не может подойти.
+     * @param nomer Номер станции.
+     * @param filtr Фильтр.
+     * @param rezultat Сюда дописываются находки (nullptr - только подсчет).
+     * @param vibor Вектор выбора на Filtr::RAZMER_BLOKA элементов.
+     * @param bufer Временная память фильтра.
+     * @return Количество подходящих прогнозов.
+     */
+    size_t primenitFiltr(size_t nomer, const Filtr& filtr, std::vector<Nahodka>* rezultat,
+        std::vector<uint32_t>& vibor, std::pmr::vector<std::pmr::vector<uint32_t>>& bufer) const;
+};
@@ -0,0 +1,523 @@
+﻿#include "Yadra.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define YADRA_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define YADRA_X86 0
+#endif
+
+//Ядро для набора команд, которого может не быть в настройках сборки: GCC и Clang собирают
+//такую функцию отдельно, MSVC разрешает любые intrinsics без флагов
+#if YADRA_X86 && !(defined(_MSC_VER) && !defined(__clang__))
+#define NABOR_KOMAND(nabor) __attribute__((target(nabor)))
+#else
+#define NABOR_KOMAND(nabor)
+#endif
+
+void Yadra::Kolonki::zapolnit(const ProstoyPrognoz* prognozi, size_t n) {
+    if (n > RAZMER_BLOKA) throw std::invalid_argument("Block is too large");
+    for (size_t i = 0; i < n; i++) {
+        const ProstoyPrognoz& p = prognozi[i];
+        date[i] = p.getDate();
+        utro[i] = p.getMorningTemp();
+        den[i] = p.getDayTemp();
+        vecher[i] = p.getEveningTemp();
+        osadki[i] = p.getOsadki();
+        status[i] = (int8_t)ProstoyPrognoz::kodStatusa(p.getStatus());
+    }
+    razmer = n;
+}
+
+void Yadra::Kolonki::zapolnit(const ProstoyPrognoz* blok, const uint32_t* vibor, size_t n) {
+    if (n > RAZMER_BLOKA) throw std::invalid_argument("Block is too large");
+    for (size_t i = 0; i < n; i++) {
+        const ProstoyPrognoz& p = blok[vibor[i]];
+        date[i] = p.getDate();
+        utro[i] = p.getMorningTemp();
+        den[i] = p.getDayTemp();
+        vecher[i] = p.getEveningTemp();
+        osadki[i] = p.getOsadki();
+        status[i] = (int8_t)ProstoyPrognoz::kodStatusa(p.getStatus());
+    }
+    razmer = n;
+}
+
+void Yadra::Kolonki::zapolnitTemperaturi(const ProstoyPrognoz* prognozi, size_t n) {
+    if (n > RAZMER_BLOKA) throw std::invalid_argument("Block is too large");
+    for (size_t i = 0; i < n; i++) {
+        const ProstoyPrognoz& p = prognozi[i];
+        date[i] = p.getDate();
+        utro[i] = p.getMorningTemp();
+        den[i] = p.getDayTemp();
+        vecher[i] = p.getEveningTemp();
+    }
+    razmer = n;
+}
+
+//Проверка одного прогноза без ветвлений (те же сравнения, что в ProstoyPrognoz::oshibka, в том числе для NaN)
+static inline uint64_t oshibkaOdnogo(double m, double d, double e, double o, int8_t s) {
+    bool yasno = (s == 0) | (s == 1);
+    bool osadkiEst = (s == 2) | (s == 3);
+    bool oshibka = (yasno & (o != 0.0)) | (osadkiEst & (o == 0.0));
+    oshibka |= (s == 3) & (m > 0.0) & (d > 0.0) & (e > 0.0);
+    oshibka |= (s == 2) & ((m < 0.0) | (d < 0.0) | (e < 0.0));
+    oshibka |= (m < -100.0) | (m > 60.0) | (d < -100.0) | (d > 60.0) | (e < -100.0) | (e > 60.0);
+    oshibka |= o > 1500.0;
+    return oshibka ? 1 : 0;
+}
+
+//Скалярные ядра с позиции i: целиком для уровня Skalyarniy и для хвостов векторных ядер
+static void srednieOt(size_t i, const double* utro, const double* den, const double* vecher, size_t n, double* rezultat) {
+    for (; i < n; i++) {
+        rezultat[i] = (utro[i] + den[i] + vecher[i]) / 3.0;
+    }
+}
+
+static void maskaOt(size_t i, const Yadra::Kolonki& k, uint64_t* maska) {
+    for (; i < k.razmer; i++) {
+        maska[i / 64] |= oshibkaOdnogo(k.utro[i], k.den[i], k.vecher[i], k.osadki[i], k.status[i]) << (i % 64);
+    }
+}
+
+static size_t mensheOt(size_t i, const Yadra::Kolonki& k, long long dateStart, long long dateEnd, double& minimum, size_t luchshiy) {
+    for (; i < k.razmer; i++) {
+        double average = (k.utro[i] + k.den[i] + k.vecher[i]) / 3.0;
+        bool podhodit = (k.date[i] >= dateStart) & (k.date[i] <= dateEnd) & (average < minimum);
+        if (podhodit) {
+            minimum = average;
+            luchshiy = i;
+        }
+    }
+    return luchshiy;
+}
+
+//Сведение полос вектора: наименьшее значение, при равенстве - наименьший номер (полосы без находки - номер < 0)
+static size_t svestiPolosy(const double* mins, const long long* nomera, int polos, double& minimum) {
+    size_t luchshiy = Yadra::NET;
+    for (int l = 0; l < polos; l++) {
+        if (nomera[l] < 0) continue;
+        if (mins[l] < minimum || (mins[l] == minimum && (size_t)nomera[l] < luchshiy)) {
+            minimum = mins[l];
+            luchshiy = (size_t)nomera[l];
+        }
+    }
+    return luchshiy;
+}
+
+static void srednieSkalyarno(const double* utro, const double* den, const double* vecher, size_t n, double* rezultat) {
+    srednieOt(0, utro, den, vecher, n, rezultat);
+}
+
+static void maskaSkalyarno(const Yadra::Kolonki& k, uint64_t* maska) {
+    maskaOt(0, k, maska);
+}
+
+static size_t mensheSkalyarno(const Yadra::Kolonki& k, long long dateStart, long long dateEnd, double& minimum) {
+    return mensheOt(0, k, dateStart, dateEnd, minimum, Yadra::NET);
+}
+
+#if YADRA_X86
+
+//SSE2: по 2 прогноза за шаг. Сравнений 64-битных целых в SSE2 нет, поэтому статус переводится в double,
+//а маска дат строится скалярно
+NABOR_KOMAND("sse2")
+static void srednieSSE2(const double* utro, const double* den, const double* vecher, size_t n, double* rezultat) {
+    size_t i = 0;
+    const __m128d tri = _mm_set1_pd(3.0);
+    for (; i + 2 <= n; i += 2) {
+        __m128d s = _mm_add_pd(_mm_add_pd(_mm_loadu_pd(utro + i), _mm_loadu_pd(den + i)), _mm_loadu_pd(vecher + i));
+        _mm_storeu_pd(rezultat + i, _mm_div_pd(s, tri));
+    }
+    srednieOt(i, utro, den, vecher, n, rezultat);
+}
+
+NABOR_KOMAND("sse2")
+static void maskaSSE2(const Yadra::Kolonki& k, uint64_t* maska) {
+    size_t i = 0;
+    const __m128d nol = _mm_setzero_pd();
+    const __m128d minT = _mm_set1_pd(-100.0);
+    const __m128d maxT = _mm_set1_pd(60.0);
+    const __m128d maxO = _mm_set1_pd(1500.0);
+    for (; i + 2 <= k.razmer; i += 2) {
+        __m128d m = _mm_loadu_pd(k.utro + i);
+        __m128d d = _mm_loadu_pd(k.den + i);
+        __m128d e = _mm_loadu_pd(k.vecher + i);
+        __m128d o = _mm_loadu_pd(k.osadki + i);
+
+        __m128d s = _mm_setr_pd(k.status[i], k.status[i + 1]);
+        __m128d sunny = _mm_cmpeq_pd(s, _mm_set1_pd(0.0));
+        __m128d cloudy = _mm_cmpeq_pd(s, _mm_set1_pd(1.0));
+        __m128d rain = _mm_cmpeq_pd(s, _mm_set1_pd(2.0));
+        __m128d snow = _mm_cmpeq_pd(s, _mm_set1_pd(3.0));
+
+        __m128d oshibka = _mm_and_pd(_mm_or_pd(sunny, cloudy), _mm_cmpneq_pd(o, nol));
+        oshibka = _mm_or_pd(oshibka, _mm_and_pd(_mm_or_pd(rain, snow), _mm_cmpeq_pd(o, nol)));
+
+        __m128d vseTeplo = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(m, nol), _mm_cmpgt_pd(d, nol)), _mm_cmpgt_pd(e, nol));
+        oshibka = _mm_or_pd(oshibka, _mm_and_pd(snow, vseTeplo));
+
+        __m128d gdeToMoroz = _mm_or_pd(_mm_or_pd(_mm_cmplt_pd(m, nol), _mm_cmplt_pd(d, nol)), _mm_cmplt_pd(e, nol));
+        oshibka = _mm_or_pd(oshibka, _mm_and_pd(rain, gdeToMoroz));
+
+        __m128d vneDiapazona = _mm_or_pd(_mm_cmplt_pd(m, minT), _mm_cmpgt_pd(m, maxT));
+        vneDiapazona = _mm_or_pd(vneDiapazona, _mm_or_pd(_mm_cmplt_pd(d, minT), _mm_cmpgt_pd(d, maxT)));
+        vneDiapazona = _mm_or_pd(vneDiapazona, _mm_or_pd(_mm_cmplt_pd(e, minT), _mm_cmpgt_pd(e, maxT)));
+        oshibka = _mm_or_pd(oshibka, vneDiapazona);
+        oshibka = _mm_or_pd(oshibka, _mm_cmpgt_pd(o, maxO));
+
+        maska[i / 64] |= (uint64_t)_mm_movemask_pd(oshibka) << (i % 64);
+    }
+    maskaOt(i, k, maska);
+}
+
+NABOR_KOMAND("sse2")
+static size_t mensheSSE2(const Yadra::Kolonki& k, long long dateStart, long long dateEnd, double& minimum) {
+    size_t i = 0;
+    const __m128d tri = _mm_set1_pd(3.0);
+    __m128d min2 = _mm_set1_pd(minimum);
+    __m128d nomer2 = _mm_set1_pd(-1.0);
+    __m128d tekushiy = _mm_setr_pd(0.0, 1.0);
+    const __m128d shag = _mm_set1_pd(2.0);
+    for (; i + 2 <= k.razmer; i += 2) {
+        long long v0 = (k.date[i] >= dateStart) & (k.date[i] <= dateEnd);
+        long long v1 = (k.date[i + 1] >= dateStart) & (k.date[i + 1] <= dateEnd);
+        __m128d vnutri = _mm_castsi128_pd(_mm_set_epi64x(-v1, -v0));
+        __m128d s = _mm_add_pd(_mm_add_pd(_mm_loadu_pd(k.utro + i), _mm_loadu_pd(k.den + i)), _mm_loadu_pd(k.vecher + i));
+        s = _mm_div_pd(s, tri);
+        __m128d menshe = _mm_and_pd(vnutri, _mm_cmplt_pd(s, min2));
+        min2 = _mm_or_pd(_mm_and_pd(menshe, s), _mm_andnot_pd(menshe, min2));
+        nomer2 = _mm_or_pd(_mm_and_pd(menshe, tekushiy), _mm_andnot_pd(menshe, nomer2));
+        tekushiy = _mm_add_pd(tekushiy, shag);
+    }
+
+    double mins[2], nomeraD[2];
+    _mm_storeu_pd(mins, min2);
+    _mm_storeu_pd(nomeraD, nomer2);
+    long long nomera[2] = { (long long)nomeraD[0], (long long)nomeraD[1] };
+    size_t luchshiy = svestiPolosy(mins, nomera, 2, minimum);
+    return mensheOt(i, k, dateStart, dateEnd, minimum, luchshiy);
+}
+
+//AVX2: по 4 прогноза за шаг
+NABOR_KOMAND("avx2")
+static void srednieAVX2(const double* utro, const double* den, const double* vecher, size_t n, double* rezultat) {
+    size_t i = 0;
+    const __m256d tri = _mm256_set1_pd(3.0);
+    for (; i + 4 <= n; i += 4) {
+        __m256d s = _mm256_add_pd(_mm256_add_pd(_mm256_loadu_pd(utro + i), _mm256_loadu_pd(den + i)), _mm256_loadu_pd(vecher + i));
+        _mm256_storeu_pd(rezultat + i, _mm256_div_pd(s, tri));
+    }
+    srednieOt(i, utro, den, vecher, n, rezultat);
+}
+
+NABOR_KOMAND("avx2")
+static void maskaAVX2(const Yadra::Kolonki& k, uint64_t* maska) {
+    size_t i = 0;
+    const __m256d nol = _mm256_setzero_pd();
+    const __m256d minT = _mm256_set1_pd(-100.0);
+    const __m256d maxT = _mm256_set1_pd(60.0);
+    const __m256d maxO = _mm256_set1_pd(1500.0);
+    for (; i + 4 <= k.razmer; i += 4) {
+        __m256d m = _mm256_loadu_pd(k.utro + i);
+        __m256d d = _mm256_loadu_pd(k.den + i);
+        __m256d e = _mm256_loadu_pd(k.vecher + i);
+        __m256d o = _mm256_loadu_pd(k.osadki + i);
+
+        int32_t s4;
+        std::memcpy(&s4, k.status + i, 4);
+        __m256i s = _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(s4));
+        __m256d sunny = _mm256_castsi256_pd(_mm256_cmpeq_epi64(s, _mm256_set1_epi64x(0)));
+        __m256d cloudy = _mm256_castsi256_pd(_mm256_cmpeq_epi64(s, _mm256_set1_epi64x(1)));
+        __m256d rain = _mm256_castsi256_pd(_mm256_cmpeq_epi64(s, _mm256_set1_epi64x(2)));
+        __m256d snow = _mm256_castsi256_pd(_mm256_cmpeq_epi64(s, _mm256_set1_epi64x(3)));
+
+        __m256d oshibka = _mm256_and_pd(_mm256_or_pd(sunny, cloudy), _mm256_cmp_pd(o, nol, _CMP_NEQ_UQ));
+        oshibka = _mm256_or_pd(oshibka, _mm256_and_pd(_mm256_or_pd(rain, snow), _mm256_cmp_pd(o, nol, _CMP_EQ_OQ)));
+
+        __m256d vseTeplo = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(m, nol, _CMP_GT_OQ), _mm256_cmp_pd(d, nol, _CMP_GT_OQ)),
+            _mm256_cmp_pd(e, nol, _CMP_GT_OQ));
+        oshibka = _mm256_or_pd(oshibka, _mm256_and_pd(snow, vseTeplo));
+
+        __m256d gdeToMoroz = _mm256_or_pd(_mm256_or_pd(_mm256_cmp_pd(m, nol, _CMP_LT_OQ), _mm256_cmp_pd(d, nol, _CMP_LT_OQ)),
+            _mm256_cmp_pd(e, nol, _CMP_LT_OQ));
+        oshibka = _mm256_or_pd(oshibka, _mm256_and_pd(rain, gdeToMoroz));
+
+        __m256d vneDiapazona = _mm256_or_pd(_mm256_cmp_pd(m, minT, _CMP_LT_OQ), _mm256_cmp_pd(m, maxT, _CMP_GT_OQ));
+        vneDiapazona = _mm256_or_pd(vneDiapazona, _mm256_or_pd(_mm256_cmp_pd(d, minT, _CMP_LT_OQ), _mm256_cmp_pd(d, maxT, _CMP_GT_OQ)));
+        vneDiapazona = _mm256_or_pd(vneDiapazona, _mm256_or_pd(_mm256_cmp_pd(e, minT, _CMP_LT_OQ), _mm256_cmp_pd(e, maxT, _CMP_GT_OQ)));
+        oshibka = _mm256_or_pd(oshibka, vneDiapazona);
+        oshibka = _mm256_or_pd(oshibka, _mm256_cmp_pd(o, maxO, _CMP_GT_OQ));
+
+        maska[i / 64] |= (uint64_t)_mm256_movemask_pd(oshibka) << (i % 64);
+    }
+    maskaOt(i, k, maska);
+}
+
+NABOR_KOMAND("avx2")
+static size_t mensheAVX2(const Yadra::Kolonki& k, long long dateStart, long long dateEnd, double& minimum) {
+    size_t i = 0;
+    const __m256d tri = _mm256_set1_pd(3.0);
+    const __m256i nizh = _mm256_set1_epi64x(dateStart);
+    const __m256i verh = _mm256_set1_epi64x(dateEnd);
+    __m256d min4 = _mm256_set1_pd(minimum);
+    __m256i nomer4 = _mm256_set1_epi64x(-1);
+    __m256i tekushiy = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i shag = _mm256_set1_epi64x(4);
+    for (; i + 4 <= k.razmer; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(k.date + i));
+        __m256i vne = _mm256_or_si256(_mm256_cmpgt_epi64(nizh, d), _mm256_cmpgt_epi64(d, verh));
+        __m256d s = _mm256_add_pd(_mm256_add_pd(_mm256_loadu_pd(k.utro + i), _mm256_loadu_pd(k.den + i)), _mm256_loadu_pd(k.vecher + i));
+        s = _mm256_div_pd(s, tri);
+        __m256d menshe = _mm256_andnot_pd(_mm256_castsi256_pd(vne), _mm256_cmp_pd(s, min4, _CMP_LT_OQ));
+        min4 = _mm256_blendv_pd(min4, s, menshe);
+        nomer4 = _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(nomer4), _mm256_castsi256_pd(tekushiy), menshe));
+        tekushiy = _mm256_add_epi64(tekushiy, shag);
+    }
+
+    double mins[4];
+    long long nomera[4];
+    _mm256_storeu_pd(mins, min4);
+    _mm256_storeu_si256((__m256i*)nomera, nomer4);
+    size_t luchshiy = svestiPolosy(mins, nomera, 4, minimum);
+    return mensheOt(i, k, dateStart, dateEnd, minimum, luchshiy);
+}
+
+//AVX-512: по 8 прогнозов за шаг, результаты сравнений - в масках __mmask8
+NABOR_KOMAND("avx512f")
+static void srednieAVX512(const double* utro, const double* den, const double* vecher, size_t n, double* rezultat) {
+    size_t i = 0;
+    const __m512d tri = _mm512_set1_pd(3.0);
+    for (; i + 8 <= n; i += 8) {
+        __m512d s = _mm512_add_pd(_mm512_add_pd(_mm512_loadu_pd(utro + i), _mm512_loadu_pd(den + i)), _mm512_loadu_pd(vecher + i));
+        _mm512_storeu_pd(rezultat + i, _mm512_div_pd(s, tri));
+    }
+    srednieOt(i, utro, den, vecher, n, rezultat);
+}
+
+NABOR_KOMAND("avx512f")
+static void maskaAVX512(const Yadra::Kolonki& k, uint64_t* maska) {
+    size_t i = 0;
+    const __m512d nol = _mm512_setzero_pd();
+    const __m512d minT = _mm512_set1_pd(-100.0);
+    const __m512d maxT = _mm512_set1_pd(60.0);
+    const __m512d maxO = _mm512_set1_pd(1500.0);
+    for (; i + 8 <= k.razmer; i += 8) {
+        __m512d m = _mm512_loadu_pd(k.utro + i);
+        __m512d d = _mm512_loadu_pd(k.den + i);
+        __m512d e = _mm512_loadu_pd(k.vecher + i);
+        __m512d o = _mm512_loadu_pd(k.osadki + i);
+
+        // Форма с нулевой маской: у обычной _mm512_cvtepi8_epi64 в GCC 12 неопределенный
+        // исходный регистр дает ложное предупреждение -Wmaybe-uninitialized
+        long long s8;
+        std::memcpy(&s8, k.status + i, 8);
+        __m512i s = _mm512_maskz_cvtepi8_epi64(0xFF, _mm_cvtsi64_si128(s8));
+        __mmask8 sunny = _mm512_cmpeq_epi64_mask(s, _mm512_set1_epi64(0));
+        __mmask8 cloudy = _mm512_cmpeq_epi64_mask(s, _mm512_set1_epi64(1));
+        __mmask8 rain = _mm512_cmpeq_epi64_mask(s, _mm512_set1_epi64(2));
+        __mmask8 snow = _mm512_cmpeq_epi64_mask(s, _mm512_set1_epi64(3));
+
+        unsigned oshibka = (sunny | cloudy) & _mm512_cmp_pd_mask(o, nol, _CMP_NEQ_UQ);
+        oshibka |= (rain | snow) & _mm512_cmp_pd_mask(o, nol, _CMP_EQ_OQ);
+        oshibka |= snow & _mm512_cmp_pd_mask(m, nol, _CMP_GT_OQ) & _mm512_cmp_pd_mask(d, nol, _CMP_GT_OQ) & _mm512_cmp_pd_mask(e, nol, _CMP_GT_OQ);
+        oshibka |= rain & (_mm512_cmp_pd_mask(m, nol, _CMP_LT_OQ) | _mm512_cmp_pd_mask(d, nol, _CMP_LT_OQ) | _mm512_cmp_pd_mask(e, nol, _CMP_LT_OQ));
+        oshibka |= _mm512_cmp_pd_mask(m, minT, _CMP_LT_OQ) | _mm512_cmp_pd_mask(m, maxT, _CMP_GT_OQ);
+        oshibka |= _mm512_cmp_pd_mask(d, minT, _CMP_LT_OQ) | _mm512_cmp_pd_mask(d, maxT, _CMP_GT_OQ);
+        oshibka |= _mm512_cmp_pd_mask(e, minT, _CMP_LT_OQ) | _mm512_cmp_pd_mask(e, maxT, _CMP_GT_OQ);
+        oshibka |= _mm512_cmp_pd_mask(o, maxO, _CMP_GT_OQ);
+
+        maska[i / 64] |= (uint64_t)(oshibka & 0xFF) << (i % 64);
+    }
+    maskaOt(i, k, maska);
+}
+
+NABOR_KOMAND("avx512f")
+static size_t mensheAVX512(const Yadra::Kolonki& k, long long dateStart, long long dateEnd, double& minimum) {
+    size_t i = 0;
+    const __m512d tri = _mm512_set1_pd(3.0);
+    const __m512i nizh = _mm512_set1_epi64(dateStart);
+    const __m512i verh = _mm512_set1_epi64(dateEnd);
+    __m512d min8 = _mm512_set1_pd(minimum);
+    __m512i nomer8 = _mm512_set1_epi64(-1);
+    __m512i tekushiy = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i shag = _mm512_set1_epi64(8);
+    for (; i + 8 <= k.razmer; i += 8) {
+        __m512i d = _mm512_loadu_si512((const void*)(k.date + i));
+        __mmask8 vnutri = _mm512_cmpge_epi64_mask(d, nizh) & _mm512_cmple_epi64_mask(d, verh);
+        __m512d s = _mm512_add_pd(_mm512_add_pd(_mm512_loadu_pd(k.utro + i), _mm512_loadu_pd(k.den + i)), _mm512_loadu_pd(k.vecher + i));
+        s = _mm512_div_pd(s, tri);
+        __mmask8 menshe = vnutri & _mm512_cmp_pd_mask(s, min8, _CMP_LT_OQ);
+        min8 = _mm512_mask_blend_pd(menshe, min8, s);
+        nomer8 = _mm512_mask_blend_epi64(menshe, nomer8, tekushiy);
+        tekushiy = _mm512_add_epi64(tekushiy, shag);
+    }
+
+    double mins[8];
+    long long nomera[8];
+    _mm512_storeu_pd(mins, min8);
+    _mm512_storeu_si512((void*)nomera, nomer8);
+    size_t luchshiy = svestiPolosy(mins, nomera, 8, minimum);
+    return mensheOt(i, k, dateStart, dateEnd, minimum, luchshiy);
+}
+
+#endif
+
+//Таблица ядер одного уровня
+struct TablicaYader {
+    Yadra::Uroven uroven;
+    void (*srednie)(const double*, const double*, const double*, size_t, double*);
+    void (*maska)(const Yadra::Kolonki&, uint64_t*);
+    size_t (*menshe)(const Yadra::Kolonki&, long long, long long, double&);
+};
+
+static const TablicaYader TABLICI[] = {
+    { Yadra::Uroven::Skalyarniy, srednieSkalyarno, maskaSkalyarno, mensheSkalyarno },
+#if YADRA_X86
+    { Yadra::Uroven::SSE2, srednieSSE2, maskaSSE2, mensheSSE2 },
+    { Yadra::Uroven::AVX2, srednieAVX2, maskaAVX2, mensheAVX2 },
+    { Yadra::Uroven::AVX512, srednieAVX512, maskaAVX512, mensheAVX512 },
+#endif
+};
+
+Yadra::Uroven Yadra::apparatniyUroven() {
+#if YADRA_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    int maksListov = r[0];
+    __cpuid(r, 1);
+    bool sse2 = (r[3] >> 26) & 1;
+    bool osxsave = (r[2] >> 27) & 1;
+    bool avx = (r[2] >> 28) & 1;
+    // Регистры YMM / ZMM должна сохранять и ОС (XCR0), иначе инструкции недоступны
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool avx2 = false, avx512 = false;
+    if (maksListov >= 7 && avx && (xcr0 & 0x6) == 0x6) {
+        __cpuidex(r, 7, 0);
+        avx2 = (r[1] >> 5) & 1;
+        avx512 = ((r[1] >> 16) & 1) && (xcr0 & 0xE6) == 0xE6;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+#endif
+    if (avx512) return Uroven::AVX512;
+    if (avx2) return Uroven::AVX2;
+    if (sse2) return Uroven::SSE2;
+#endif
+    return Uroven::Skalyarniy;
+}
+
+const char* Yadra::imyaUrovnya(Uroven uroven) {
+    switch (uroven) {
+    case Uroven::SSE2: return "sse2";
+    case Uroven::AVX2: return "avx2";
+    case Uroven::AVX512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+//Уровень по умолчанию: наибольший поддерживаемый или заданный переменной окружения (не выше поддерживаемого)
+static Yadra::Uroven nachalniyUroven() {
+    Yadra::Uroven uroven = Yadra::apparatniyUroven();
+
+    std::string zadano;
+#if defined(_MSC_VER)
+    char* znachenie = nullptr;
+    size_t dlina = 0;
+    if (_dupenv_s(&znachenie, &dlina, Yadra::PEREMENNAYA_OKRUZHENIYA) == 0 && znachenie != nullptr) {
+        zadano = znachenie;
+        free(znachenie);
+    }
+#else
+    const char* znachenie = std::getenv(Yadra::PEREMENNAYA_OKRUZHENIYA);
+    if (znachenie != nullptr) zadano = znachenie;
+#endif
+    for (char& c : zadano) {
+        c = (char)std::tolower((unsigned char)c);
+    }
+
+    for (int i = 0; i <= (int)Yadra::Uroven::AVX512; i++) {
+        Yadra::Uroven u = (Yadra::Uroven)i;
+        if (zadano == Yadra::imyaUrovnya(u)) return std::min(u, uroven);
+    }
+    return uroven;
+}
+
+static std::atomic<const TablicaYader*>& tekushayaTablica() {
+    // Выбор делается один раз при первом обращении
+    static std::atomic<const TablicaYader*> tablica(&TABLICI[(int)nachalniyUroven()]);
+    return tablica;
+}
+
+Yadra::Uroven Yadra::uroven() {
+    return tekushayaTablica().load(std::memory_order_relaxed)->uroven;
+}
+
+Yadra::Uroven Yadra::ustanovitUroven(Uroven uroven) {
+    uroven = std::min(uroven, apparatniyUroven());
+    tekushayaTablica().store(&TABLICI[(int)uroven], std::memory_order_relaxed);
+    return uroven;
+}
+
+void Yadra::srednie(const double* utro, const double* den, const double* vecher, size_t n, double* rezultat) {
+    tekushayaTablica().load(std::memory_order_relaxed)->srednie(utro, den, vecher, n, rezultat);
+}
+
+size_t Yadra::maskaOshibok(const Kolonki& k, uint64_t* maska) {
+    size_t n = k.razmer;
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+        maska[w] = 0;
+    }
+    tekushayaTablica().load(std::memory_order_relaxed)->maska(k, maska);
+
+    size_t kolvo = 0;
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+        kolvo += (size_t)std::popcount(maska[w]);
+    }
+    return kolvo;
+}
+
+size_t Yadra::minimumSrednego(const Kolonki& k, long long dateStart, long long dateEnd, bool& nayden, double& minimum) {
+    size_t luchshiy = NET;
+
+    if (!nayden) {
+        // Первый прогноз из промежутка становится минимумом при любом значении (как в поштучном цикле)
+        size_t i = 0;
+        while (i < k.razmer && (k.date[i] < dateStart || k.date[i] > dateEnd)) i++;
+        if (i == k.razmer) return NET;
+        nayden = true;
+        minimum = (k.utro[i] + k.den[i] + k.vecher[i]) / 3.0;
+        luchshiy = i;
+    }
+    if (minimum != minimum) return luchshiy;  // NaN: строгое "меньше" больше не выполнится
+
+    size_t nomer = tekushayaTablica().load(std::memory_order_relaxed)->menshe(k, dateStart, dateEnd, minimum);
+    return (nomer != NET) ? nomer : luchshiy;
+}
+
+size_t Yadra::minimumSrednego(const ProstoyPrognoz* prognozi, size_t n, long long dateStart, long long dateEnd, bool& nayden, double& minimum) {
+    Kolonki kolonki;
+    size_t luchshiy = NET;
+    for (size_t nachalo = 0; nachalo < n; nachalo += RAZMER_BLOKA) {
+        size_t razmer = std::min(RAZMER_BLOKA, n - nachalo);
+        kolonki.zapolnitTemperaturi(prognozi + nachalo, razmer);
+        size_t nomer = minimumSrednego(kolonki, dateStart, dateEnd, nayden, minimum);
+        if (nomer != NET) luchshiy = nachalo + nomer;
+    }
+    return luchshiy;
+}
@@ -0,0 +1,162 @@
+﻿#pragma once
+#include "Prostoy.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Пакетные вычислительные ядра над блоком прогнозов в виде столбцов.
+ * * Прогнозы блока раскладываются по столбцам (Kolonki): дата, три температуры,
+ * осадки и номер статуса (ProstoyPrognoz::kodStatusa). Над столбцами ядра
+ * работают без ветвлений внутри цикла. Каждое ядро собрано для нескольких наборов
+ * команд (Uroven), нужный выбирается один раз при первом вызове по CPUID,
+ * поэтому один и тот же исполняемый файл работает и на процессорах без AVX-512.
+ * Уровень можно понизить переменной окружения FORECAST_SIMD (scalar, sse2, avx2, avx512).
+ * Результаты совпадают с поштучными getAverageTemp() и oshibka() бит в бит на любом уровне.
+ */
+class Yadra
+{
+public:
+
+    /// @brief Набор команд, для которого собраны ядра.
+    enum class Uroven {
+        /// @brief Обычный код без векторных инструкций.
+        Skalyarniy,
+        /// @brief SSE2: 2 прогноза за шаг.
+        SSE2,
+        /// @brief AVX2: 4 прогноза за шаг.
+        AVX2,
+        /// @brief AVX-512F: 8 прогнозов за шаг.
+        AVX512
+    };
+
+    /// @brief Переменная окружения для выбора уровня (например для замеров).
+    static constexpr const char* PEREMENNAYA_OKRUZHENIYA = "FORECAST_SIMD";
+
+    /// @brief Наибольший размер блока (столько же, сколько Filtr::RAZMER_BLOKA).
+    static constexpr size_t RAZMER_BLOKA = 1024;
+
+    /// @brief Количество 64-битных слов маски на блок.
+    static constexpr size_t SLOV_MASKI = RAZMER_BLOKA / 64;
+
+    /// @brief Блок прогнозов по столбцам. Около 41 КБ, можно держать на стеке.
+    struct Kolonki {
+        /// @brief Даты.
+        alignas(32) long long date[RAZMER_BLOKA];
+        /// @brief Утренние температуры.
+        alignas(32) double utro[RAZMER_BLOKA];
+        /// @brief Дневные температуры.
+        alignas(32) double den[RAZMER_BLOKA];
+        /// @brief Вечерние температуры.
+        alignas(32) double vecher[RAZMER_BLOKA];
+        /// @brief Осадки.
+        alignas(32) double osadki[RAZMER_BLOKA];
+        /// @brief Номера статусов (-1 - неизвестный статус).
+        alignas(32) int8_t status[RAZMER_BLOKA];
+        /// @brief Количество прогнозов в блоке.
+        size_t razmer = 0;
+
+        /**
+         * @brief Раскладывает подряд идущие прогнозы по столбцам.
+         * @param prognozi Прогнозы.
+         * @param n Количество (не больше RAZMER_BLOKA).
+         * @throws std::invalid_argument Если n > RAZMER_BLOKA.
+         */
+        void zapolnit(const ProstoyPrognoz* prognozi, size_t n);
+
+        /**
+         * @brief Раскладывает по столбцам выбранные прогнозы блока.
+         * @param blok Блок прогнозов.
+         * @param vibor Номера выбранных прогнозов в блоке.
+         * @param n Количество выбранных (не больше RAZMER_BLOKA).
+         * @throws std::invalid_argument Если n > RAZMER_BLOKA.
+         */
+        void zapolnit(const ProstoyPrognoz* blok, const uint32_t* vibor, size_t n);
+
+        /**
+         * @brief Раскладывает по столбцам только даты и температуры (без статусов и осадков).
+         * @param prognozi Прогнозы.
+         * @param n Количество (не больше RAZMER_BLOKA).
+         * @throws std::invalid_argument Если n > RAZMER_BLOKA.
+         */
+        void zapolnitTemperaturi(const ProstoyPrognoz* prognozi, size_t n);
+    };
+
+    /// @brief "Не найдено" для функций поиска.
+    static constexpr size_t NET = SIZE_MAX;
+
+    /**
+     * @brief Наибольший уровень, поддерживаемый процессором и операционной системой (CPUID, XCR0).
+     * @return Уровень.
+     */
+    static Uroven apparatniyUroven();
+
+    /**
+     * @brief Уровень, ядра которого сейчас используются.
+     * При первом обращении выбирается apparatniyUroven() или уровень из FORECAST_SIMD, если он не выше.
+     * @return Уровень.
+     */
+    static Uroven uroven();
+
+    /**
+     * @brief Переключает ядра на другой уровень (не выше apparatniyUroven()).
+     * @param uroven Желаемый уровень.
+     * @return Установленный уровень.
+     */
+    static Uroven ustanovitUroven(Uroven uroven);
+
+    /**
+     * @brief Имя уровня в том виде, в котором оно задается в FORECAST_SIMD.
+     * @param uroven Уровень.
+     * @return "scalar", "sse2", "avx2" или "avx512".
+     */
+    static const char* imyaUrovnya(Uroven uroven);
+
+    /**
+     * @brief Средние температуры: rezultat[i] = (utro[i] + den[i] + vecher[i]) / 3.
+     * @param utro Утренние температуры.
+     * @param den Дневные температуры.
+     * @param vecher Вечерние температуры.
+     * @param n Количество.
+     * @param rezultat Сюда записываются средние (n значений).
+     */
+    static void srednie(const double* utro, const double* den, const double* vecher, size_t n, double* rezultat);
+
+    /**
+     * @brief Маска ошибочных прогнозов по всем правилам ProstoyPrognoz::oshibka().
+     * * Бит i установлен, если прогноз i ошибочный: статус не согласован с осадками,
+     * снег при всех температурах выше 0, дождь при любой температуре ниже 0,
+     * температура вне [-100, 60] или осадки больше 1500 мм.
+     * @param k Блок по столбцам.
+     * @param maska Сюда записывается маска ((k.razmer + 63) / 64 слов).
+     * @return Количество ошибочных прогнозов.
+     */
+    static size_t maskaOshibok(const Kolonki& k, uint64_t* maska);
+
+    /**
+     * @brief Минимум средней температуры среди прогнозов блока с датой в [dateStart, dateEnd].
+     * * Продолжает поиск по предыдущим блокам с тем же правилом, что и поштучный цикл
+     * "if (!nayden || average < minimum)": при равенстве остается более ранний прогноз,
+     * а первым найденным считается первый прогноз из промежутка.
+     * Внутри блока индекс минимума ведется по каждой полосе вектора, прогнозы не копируются.
+     * @param k Блок по столбцам (заполнены date, utro, den, vecher).
+     * @param dateStart Начало промежутка (включительно).
+     * @param dateEnd Конец промежутка (включительно).
+     * @param nayden Найден ли уже хоть один прогноз (обновляется).
+     * @param minimum Текущий минимум (обновляется).
+     * @return Номер нового минимума в блоке или NET, если минимум не изменился.
+     */
+    static size_t minimumSrednego(const Kolonki& k, long long dateStart, long long dateEnd, bool& nayden, double& minimum);
+
+    /**
+     * @brief Номер прогноза с наименьшей средней температурой среди подряд идущих прогнозов.
+     * Прогнозы раскладываются по столбцам блоками и проверяются minimumSrednego.
+     * @param prognozi Прогнозы.
+     * @param n Количество.
+     * @param dateStart Начало промежутка (включительно).
+     * @param dateEnd Конец промежутка (включительно).
+     * @param nayden Найден ли уже хоть один прогноз (обновляется).
+     * @param minimum Текущий минимум (обновляется).
+     * @return Номер нового минимума среди prognozi или NET, если минимум не изменился.
+     */
+    static size_t minimumSrednego(const ProstoyPrognoz* prognozi, size_t n, long long dateStart, long long dateEnd, bool& nayden, double& minimum);
+};
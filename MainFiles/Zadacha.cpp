@@ -0,0 +1,19 @@
+#include "Zadacha.h"
+
+void Planirovshik::zaplanirovat(std::coroutine_handle<> handle) {
+    ochered.push_back(handle);
+}
+
+bool Planirovshik::shag() {
+    if (ochered.empty()) return false;
+
+    std::coroutine_handle<> handle = ochered.front();
+    ochered.pop_front();
+    handle.resume();
+    return true;
+}
+
+void Planirovshik::vipolnit() {
+    while (shag()) {
+    }
+}
@@ -0,0 +1,232 @@
+﻿#pragma once
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Простой планировщик корутин (событийный цикл).
+ * * Хранит очередь приостановленных корутин и по очереди возобновляет их.
+ * Позволяет нескольким долгим запросам к SlozhniyPrognoz выполняться
+ * "вперемешку" в одном потоке, без отдельного потока на каждый запрос.
+ */
+class Planirovshik
+{
+private:
+    /// @brief Очередь корутин, готовых к продолжению.
+    std::deque<std::coroutine_handle<>> ochered;
+
+public:
+
+    /**
+     * @brief Ожидаемый объект, который возвращает управление планировщику.
+     * Корутина, выполнившая co_await над ним, ставится в конец очереди.
+     */
+    struct Ustupka {
+        /// @brief Планировщик, в очередь которого встанет корутина.
+        Planirovshik& planirovshik;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            planirovshik.zaplanirovat(handle);
+        }
+
+        void await_resume() const noexcept {
+        }
+    };
+
+    /**
+     * @brief Ставит корутину в конец очереди.
+     * @param handle Корутина, которую нужно продолжить позже.
+     */
+    void zaplanirovat(std::coroutine_handle<> handle);
+
+    /**
+     * @brief Возвращает ожидаемый объект для уступки управления.
+     * Использование: co_await planirovshik.ustupit();
+     * @return Объект Ustupka.
+     */
+    Ustupka ustupit() {
+        return Ustupka{ *this };
+    }
+
+    /**
+     * @brief Возобновляет одну корутину из начала очереди.
+     * @return true, если корутина была возобновлена, false если очередь пуста.
+     */
+    bool shag();
+
+    /// @brief Выполняет корутины, пока очередь не опустеет.
+    void vipolnit();
+
+    /// @brief Проверяет, пуста ли очередь.
+    bool pust() const {
+        return ochered.empty();
+    }
+};
+
+
+/**
+ * @brief Ленивая корутина-задача, возвращающая значение типа T.
+ * * Начинает выполняться только когда её ожидают (co_await) или ставят
+ * в планировщик. По завершении передает управление ожидающей корутине.
+ * Исключения из тела корутины пробрасываются в rezultat() или в co_await.
+ * @tparam T Тип результата (может быть void).
+ */
+template <typename T>
+class Zadacha
+{
+public:
+
+    /// @brief Общая часть promise_type для T и void.
+    struct PromiseBase {
+        /// @brief Корутина, которая ждет результат (продолжение).
+        std::coroutine_handle<> prodolzhenie;
+        /// @brief Исключение, выброшенное телом корутины.
+        std::exception_ptr oshibka;
+
+        /// @brief Возвращает управление ожидающей корутине при завершении.
+        struct Final {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            template <typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) const noexcept {
+                std::coroutine_handle<> next = handle.promise().prodolzhenie;
+                return next ? next : std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {
+            }
+        };
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        Final final_suspend() const noexcept {
+            return {};
+        }
+
+        void unhandled_exception() {
+            oshibka = std::current_exception();
+        }
+    };
+
+    /// @brief promise_type для задач с результатом.
+    struct PromiseZnach : PromiseBase {
+        /// @brief Результат корутины.
+        std::optional<T> znachenie;
+
+        Zadacha get_return_object() {
+            return Zadacha(std::coroutine_handle<promise_type>::from_promise(static_cast<promise_type&>(*this)));
+        }
+
+        template <typename U>
+        void return_value(U&& value) {
+            znachenie.emplace(std::forward<U>(value));
+        }
+    };
+
+    /// @brief promise_type для задач без результата.
+    struct PromisePustoy : PromiseBase {
+        Zadacha get_return_object() {
+            return Zadacha(std::coroutine_handle<promise_type>::from_promise(static_cast<promise_type&>(*this)));
+        }
+
+        void return_void() {
+        }
+    };
+
+    struct promise_type : std::conditional_t<std::is_void_v<T>, PromisePustoy, PromiseZnach> {
+    };
+
+private:
+    /// @brief Хэндл корутины (владеет кадром корутины).
+    std::coroutine_handle<promise_type> handle;
+
+public:
+
+    /// @brief Конструктор из хэндла (вызывается из get_return_object).
+    explicit Zadacha(std::coroutine_handle<promise_type> h) :
+        handle(h) {
+    }
+
+    /// @brief Копирование запрещено: кадром корутины владеет одна задача.
+    Zadacha(const Zadacha&) = delete;
+    Zadacha& operator = (const Zadacha&) = delete;
+
+    /// @brief Конструктор перемещения.
+    Zadacha(Zadacha&& other) noexcept :
+        handle(std::exchange(other.handle, nullptr)) {
+    }
+
+    /// @brief Оператор присваивания перемещением.
+    Zadacha& operator = (Zadacha&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    /// @brief Деструктор. Уничтожает кадр корутины.
+    ~Zadacha() {
+        if (handle) handle.destroy();
+    }
+
+    /// @brief Проверяет, завершилась ли корутина (пустая задача, например перемещенная, считается готовой).
+    bool gotova() const {
+        return !handle || handle.done();
+    }
+
+    /**
+     * @brief Ставит задачу в очередь планировщика (для запуска из обычного кода).
+     * @param planirovshik Планировщик, который будет выполнять задачу.
+     * @throws std::logic_error Если задача пустая (перемещена или создана без корутины).
+     */
+    void zapustit(Planirovshik& planirovshik) {
+        if (!handle) throw std::logic_error("Task is empty");
+        planirovshik.zaplanirovat(handle);
+    }
+
+    /**
+     * @brief Забирает результат завершенной задачи.
+     * Результат перемещается из задачи, поэтому забрать его можно только один раз.
+     * @return Результат корутины.
+     * @throws std::logic_error Если задача пустая, еще не завершена или результат уже забран.
+     * @throws Любое исключение, выброшенное телом корутины.
+     */
+    T rezultat() {
+        if (!handle) throw std::logic_error("Task is empty");
+        if (!handle.done()) throw std::logic_error("Task is not finished");
+        promise_type& promise = handle.promise();
+        if (promise.oshibka) std::rethrow_exception(promise.oshibka);
+        if constexpr (!std::is_void_v<T>) {
+            if (!promise.znachenie) throw std::logic_error("Task result is already taken");
+            T znachenie = std::move(*promise.znachenie);
+            promise.znachenie.reset();
+            return znachenie;
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return gotova();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> ozhidayushaya) noexcept {
+        handle.promise().prodolzhenie = ozhidayushaya;
+        return handle;
+    }
+
+    T await_resume() {
+        return rezultat();
+    }
+};
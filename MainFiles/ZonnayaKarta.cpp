@@ -0,0 +1,49 @@
+#include "ZonnayaKarta.h"
+#include <algorithm>
+#include <limits>
+
+void ZonnayaKarta::Zona::uchest(const ProstoyPrognoz& p) {
+    double znacheniya[KOLVO_POLEY] = { p.getMorningTemp(), p.getDayTemp(), p.getEveningTemp(), p.getAverageTemp(), p.getOsadki() };
+    if (kolvo == 0) {
+        minDate = maxDate = p.getDate();
+        for (int i = 0; i < KOLVO_POLEY; i++) {
+            min[i] = std::numeric_limits<double>::infinity();
+            max[i] = -std::numeric_limits<double>::infinity();
+        }
+    }
+    minDate = std::min(minDate, p.getDate());
+    maxDate = std::max(maxDate, p.getDate());
+    for (int i = 0; i < KOLVO_POLEY; i++) {
+        double x = znacheniya[i];
+        if (x != x) {
+            min[i] = -std::numeric_limits<double>::infinity();
+            max[i] = std::numeric_limits<double>::infinity();
+        }
+        else {
+            min[i] = std::min(min[i], x);
+            max[i] = std::max(max[i], x);
+        }
+    }
+    kolvo++;
+}
+
+void ZonnayaKarta::postroit(const ProstoyPrognoz* prognozi, size_t n) {
+    clear();
+    zoni.reserve((n + RAZMER_BLOKA - 1) / RAZMER_BLOKA);
+    for (size_t i = 0; i < n; i++) {
+        dopisat(prognozi[i]);
+    }
+}
+
+void ZonnayaKarta::dopisat(const ProstoyPrognoz& p) {
+    if (kolvoZapisey % RAZMER_BLOKA == 0) {
+        zoni.emplace_back();
+    }
+    zoni.back().uchest(p);
+    kolvoZapisey++;
+}
+
+void ZonnayaKarta::clear() {
+    zoni.clear();
+    kolvoZapisey = 0;
+}
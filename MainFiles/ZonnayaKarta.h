@@ -0,0 +1,94 @@
+﻿#pragma once
+#include "Prostoy.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Зональная карта: наименьшие и наибольшие значения полей по блокам прогнозов.
+ * * Массив делится на блоки по RAZMER_BLOKA позиций (с нуля). Для каждого блока хранится
+ * промежуток дат и промежуток значений каждого поля. Запрос, условие которого
+ * заведомо не выполняется на промежутке (например "ниже -30" при минимуме блока -12),
+ * пропускает блок целиком, не читая прогнозы (см. Filtr::mozhetPodoyti).
+ * Значение NaN расширяет промежуток поля до (-inf, +inf), чтобы пропуск оставался верным.
+ */
+class ZonnayaKarta
+{
+public:
+
+    /// @brief Количество позиций в блоке (совпадает с Filtr::RAZMER_BLOKA).
+    static constexpr size_t RAZMER_BLOKA = 1024;
+
+    /// @brief Количество числовых полей (в порядке Filtr::Pole: утро, день, вечер, средняя, осадки).
+    static constexpr int KOLVO_POLEY = 5;
+
+    /// @brief Промежутки значений одного блока.
+    struct Zona {
+        /// @brief Наименьшая дата.
+        long long minDate = 0;
+        /// @brief Наибольшая дата.
+        long long maxDate = 0;
+        /// @brief Наименьшие значения полей (номер - Filtr::Pole).
+        double min[KOLVO_POLEY] = {};
+        /// @brief Наибольшие значения полей (номер - Filtr::Pole).
+        double max[KOLVO_POLEY] = {};
+        /// @brief Количество прогнозов в блоке.
+        size_t kolvo = 0;
+
+        /**
+         * @brief Расширяет промежутки значениями прогноза.
+         * @param p Прогноз.
+         */
+        void uchest(const ProstoyPrognoz& p);
+
+        /// @brief Совпадают ли все промежутки и количество (например зона из файла с построенной).
+        bool operator == (const Zona& other) const = default;
+    };
+
+private:
+
+    /// @brief Зоны блоков по порядку.
+    std::vector<Zona> zoni;
+
+    /// @brief Количество учтенных позиций.
+    size_t kolvoZapisey = 0;
+
+public:
+
+    /// @brief Конструктор пустой карты.
+    ZonnayaKarta() = default;
+
+    /**
+     * @brief Строит карту по массиву за O(n).
+     * @param prognozi Прогнозы.
+     * @param n Количество.
+     */
+    void postroit(const ProstoyPrognoz* prognozi, size_t n);
+
+    /**
+     * @brief Учитывает прогноз на следующей позиции (дописывание в конец массива). O(1).
+     * @param p Прогноз.
+     */
+    void dopisat(const ProstoyPrognoz& p);
+
+    /// @brief Удаляет все зоны.
+    void clear();
+
+    /// @brief Возвращает количество блоков.
+    size_t size() const {
+        return zoni.size();
+    }
+
+    /// @brief Возвращает количество учтенных позиций.
+    size_t kolvo() const {
+        return kolvoZapisey;
+    }
+
+    /**
+     * @brief Возвращает зону блока.
+     * @param blok Номер блока (позиции [blok * RAZMER_BLOKA, (blok + 1) * RAZMER_BLOKA)).
+     * @return Зона.
+     */
+    const Zona& operator [] (size_t blok) const {
+        return zoni[blok];
+    }
+};
@@ -3,11 +3,16 @@
 
 #include "..\MainFiles\Prostoy.h"
 #include "..\MainFiles\Slozhniy.h"
+#include "..\MainFiles\Dnevnoy.h"
+#include "..\MainFiles\Stancii.h"
+#include "..\MainFiles\Yadra.h"
 #include <random>
 #include <string>
 #include <vector>
 #include <iostream>
 #include <sstream>
+#include <map>
+#include <memory_resource>
 
 
 /**
@@ -86,6 +91,40 @@ TEST_CASE("Stress Test sortirovki vectora", "[stress][sort]") {
 }
 
 
+TEST_CASE("Parallel sort of a big vector is stable", "[stress][sort]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    // Больше порога, чтобы сработала параллельная сортировка, и много одинаковых дат
+    size_t N = SlozhniyPrognoz::POROG_PARALLELNOY_SORTIROVKI * 2 + 17;
+    for (size_t i = 0; i < N; i++) {
+        ProstoyPrognoz p = gen.getForecast();
+        p.setDate(gen.getDate(0, 999));
+        p.setOsadki((double)i); // Запоминаем исходный порядок
+        vector += p;
+    }
+
+    vector.sortDates();
+
+    REQUIRE(vector.size() == N);
+    bool stable = true;
+    for (size_t i = 0; i < N - 1; i++) {
+        const SlozhniyPrognoz& c = vector;
+        if (c[i].getDate() > c[i + 1].getDate()) {
+            stable = false;
+            INFO("Not sorted at index " << i);
+            break;
+        }
+        if (c[i].getDate() == c[i + 1].getDate() && c[i].getOsadki() > c[i + 1].getOsadki()) {
+            stable = false;
+            INFO("Not stable at index " << i);
+            break;
+        }
+    }
+    REQUIRE(stable == true);
+}
+
+
 TEST_CASE("Test about finding the coldest day", "[search]") {
     RandomGen gen;
     SlozhniyPrognoz vector;
@@ -178,6 +217,1843 @@ TEST_CASE("Benchmark: Merge Povtorki", "[performance][stress]") {
 }
 
 
+TEST_CASE("Merge Povtorki of a big unsorted vector", "[stress][merge]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+    std::map<long long, ProstoyPrognoz> expected;
+
+    // Ожидаемый результат считаем "в лоб": += в порядке добавления
+    size_t N = SlozhniyPrognoz::POROG_PARALLELNOGO_SLIYANIYA + 1000;
+    for (size_t i = 0; i < N; i++) {
+        ProstoyPrognoz p = gen.getForecast();
+        p.setDate(86400 * gen.getDate(0, 4999));
+        vector += p;
+
+        auto it = expected.find(p.getDate());
+        if (it == expected.end()) {
+            expected.emplace(p.getDate(), p);
+        }
+        else {
+            it->second += p;
+        }
+    }
+
+    vector.mergePovtorki();
+
+    REQUIRE(vector.size() == expected.size());
+    const SlozhniyPrognoz& c = vector;
+    size_t i = 0;
+    for (const auto& [date, p] : expected) {
+        REQUIRE(c[i].getDate() == date);
+        REQUIRE(c[i].getMorningTemp() == p.getMorningTemp());
+        REQUIRE(c[i].getDayTemp() == p.getDayTemp());
+        REQUIRE(c[i].getEveningTemp() == p.getEveningTemp());
+        REQUIRE(c[i].getOsadki() == p.getOsadki());
+        REQUIRE(c[i].getStatus() == p.getStatus());
+        i++;
+    }
+}
+
+
+TEST_CASE("Batch queries give the same answers as single queries", "[search][batch]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    for (int i = 0; i < 2000; i++) {
+        vector += gen.getForecast();
+    }
+
+    std::vector<std::pair<long long, long long>> diapazoni;
+    std::vector<long long> dates;
+    for (int q = 0; q < 300; q++) {
+        long long a = gen.getDate(1570000000, 1900000000);
+        diapazoni.push_back({ a, a + gen.getDate(0, 5000000) });
+        dates.push_back(a);
+    }
+
+    std::vector<size_t> cold = vector.getColdestDays(diapazoni);
+    std::vector<size_t> sunny = vector.getNextSunnyDays(dates);
+    std::vector<SlozhniyPrognoz> months = vector.getMonths(dates);
+
+    const SlozhniyPrognoz& c = vector;
+    for (size_t q = 0; q < diapazoni.size(); q++) {
+        if (cold[q] == SlozhniyPrognoz::NE_NAYDENO) {
+            REQUIRE_THROWS_AS(c.getColdestDay(diapazoni[q].first, diapazoni[q].second), std::logic_error);
+        }
+        else {
+            ProstoyPrognoz expected = c.getColdestDay(diapazoni[q].first, diapazoni[q].second);
+            REQUIRE(c[cold[q]].getDate() == expected.getDate());
+            REQUIRE(c[cold[q]].getAverageTemp() == expected.getAverageTemp());
+        }
+
+        if (sunny[q] == SlozhniyPrognoz::NE_NAYDENO) {
+            REQUIRE_THROWS_AS(c.getNextSunnyDay(dates[q]), std::logic_error);
+        }
+        else {
+            REQUIRE(c[sunny[q]].getDate() == c.getNextSunnyDay(dates[q]).getDate());
+        }
+
+        SlozhniyPrognoz month = c.getMonth(dates[q]);
+        REQUIRE(months[q].size() == month.size());
+        for (size_t i = 0; i < month.size(); i++) {
+            REQUIRE(months[q][i].getDate() == month[i].getDate());
+        }
+    }
+}
+
+
+TEST_CASE("Asynchronous queries (coroutines)", "[async]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    for (int i = 0; i < 1000; i++) {
+        vector += gen.getForecast();
+    }
+
+    SECTION("Results are the same as in synchronous versions") {
+        Planirovshik planirovshik;
+
+        Zadacha<ProstoyPrognoz> cold = vector.getColdestDayAsync(1600000000, 1800000000, planirovshik, 64);
+        Zadacha<ProstoyPrognoz> sunny = vector.getNextSunnyDayAsync(1700000000, planirovshik, 64);
+        cold.zapustit(planirovshik);
+        sunny.zapustit(planirovshik);
+
+        // Две задачи должны чередоваться, а не выполняться целиком по очереди
+        planirovshik.shag();
+        planirovshik.shag();
+        REQUIRE_FALSE(cold.gotova());
+        REQUIRE_FALSE(sunny.gotova());
+
+        planirovshik.vipolnit();
+        REQUIRE(cold.gotova());
+        REQUIRE(sunny.gotova());
+
+        ProstoyPrognoz syncCold = vector.getColdestDay(1600000000, 1800000000);
+        ProstoyPrognoz syncSunny = vector.getNextSunnyDay(1700000000);
+        ProstoyPrognoz asyncCold = cold.rezultat();
+        ProstoyPrognoz asyncSunny = sunny.rezultat();
+
+        REQUIRE(asyncCold.getDate() == syncCold.getDate());
+        REQUIRE(asyncCold.getAverageTemp() == syncCold.getAverageTemp());
+        REQUIRE(asyncSunny.getDate() == syncSunny.getDate());
+    }
+
+    SECTION("Awaiting handler is resumed after completion") {
+        Planirovshik planirovshik;
+        double result = 0.0;
+
+        auto handler = [&]() -> Zadacha<void> {
+            ProstoyPrognoz p = co_await vector.getColdestDayAsync(0, 2000000000, planirovshik, 100);
+            result = p.getAverageTemp();
+        };
+
+        Zadacha<void> zadacha = handler();
+        zadacha.zapustit(planirovshik);
+        planirovshik.vipolnit();
+
+        REQUIRE(zadacha.gotova());
+        REQUIRE(result == vector.getColdestDay(0, 2000000000).getAverageTemp());
+    }
+
+    SECTION("Errors are passed through the task") {
+        Planirovshik planirovshik;
+        Zadacha<ProstoyPrognoz> zadacha = vector.getColdestDayAsync(0, 10, planirovshik);
+        zadacha.zapustit(planirovshik);
+        planirovshik.vipolnit();
+
+        REQUIRE_THROWS_AS(zadacha.rezultat(), std::logic_error);
+    }
+
+    SECTION("Empty task and a taken result are reported as errors") {
+        Planirovshik planirovshik;
+        Zadacha<ProstoyPrognoz> zadacha = vector.getColdestDayAsync(0, 2000000000, planirovshik);
+        zadacha.zapustit(planirovshik);
+        planirovshik.vipolnit();
+
+        Zadacha<ProstoyPrognoz> zabrala = std::move(zadacha);
+        REQUIRE_THROWS_AS(zadacha.rezultat(), std::logic_error);
+        REQUIRE_THROWS_AS(zadacha.zapustit(planirovshik), std::logic_error);
+
+        // Результат забирается один раз
+        REQUIRE(zabrala.rezultat().getDate() == vector.getColdestDay(0, 2000000000).getDate());
+        REQUIRE_THROWS_AS(zabrala.rezultat(), std::logic_error);
+    }
+
+    SECTION("Async merge gives the same result as mergePovtorki") {
+        SlozhniyPrognoz povtorki;
+        for (int i = 0; i < 1000; i++) {
+            ProstoyPrognoz p = gen.getForecast();
+            p.setDate(1000 + (i % 37));
+            povtorki += p;
+        }
+        SlozhniyPrognoz copy(povtorki);
+
+        Planirovshik planirovshik;
+        Zadacha<void> zadacha = povtorki.mergePovtorkiAsync(planirovshik, 50);
+        zadacha.zapustit(planirovshik);
+        planirovshik.vipolnit();
+        zadacha.rezultat();
+
+        copy.mergePovtorki();
+
+        REQUIRE(povtorki.size() == 37);
+        REQUIRE(copy.size() == 37);
+        for (size_t i = 0; i < povtorki.size(); i++) {
+            REQUIRE(povtorki[i].getDate() == copy[i].getDate());
+            REQUIRE(povtorki[i].getAverageTemp() == Approx(copy[i].getAverageTemp()));
+            REQUIRE(povtorki[i].getStatus() == copy[i].getStatus());
+        }
+    }
+}
+
+
+TEST_CASE("Calendar arithmetic and getMonth boundaries", "[calendar]") {
+
+    SECTION("Round trip days <-> civil date") {
+        for (long long dni = -800000; dni <= 800000; dni += 97) {
+            Kalendar::Data d = Kalendar::civilFromDays(dni);
+            REQUIRE(Kalendar::daysFromCivil(d.god, d.mesyats, d.den) == dni);
+        }
+    }
+
+    SECTION("Known dates") {
+        REQUIRE(Kalendar::daysFromCivil(2024, 2, 29) * Kalendar::SEKUND_V_SUTKAH == 1709164800);
+        Kalendar::Data d = Kalendar::dataIzDati(1700000000); // 2023-11-14 22:13:20 UTC
+        REQUIRE(d.god == 2023);
+        REQUIRE(d.mesyats == 11);
+        REQUIRE(d.den == 14);
+        REQUIRE(Kalendar::dataIzDati(-1).god == 1969);
+        // Со смещением +3 часа это уже 15 ноября
+        REQUIRE(Kalendar::dataIzDati(1700000000, 3 * 3600).den == 15);
+    }
+
+    SECTION("getMonth takes exactly the days of the month") {
+        SlozhniyPrognoz vector;
+        long long march = 1709251200; // 2024-03-01 00:00 UTC
+        vector += ProstoyPrognoz(march - 1, 1.0, 1.0, 1.0, 0.0, "Sunny");
+        vector += ProstoyPrognoz(march + 31 * 86400 - 1, 1.0, 1.0, 1.0, 0.0, "Sunny");
+        vector += ProstoyPrognoz(march, 1.0, 1.0, 1.0, 0.0, "Sunny");
+        vector += ProstoyPrognoz(march + 31 * 86400, 1.0, 1.0, 1.0, 0.0, "Sunny");
+
+        SlozhniyPrognoz month = vector.getMonth(march + 15 * 86400);
+        REQUIRE(month.size() == 2);
+        REQUIRE(month[0].getDate() == march);
+        REQUIRE(month[1].getDate() == march + 31 * 86400 - 1);
+
+        // В поясе UTC+3 первая запись (29 февраля 23:59:59 UTC) уже относится к марту
+        SlozhniyPrognoz moscow = vector.getMonth(march + 15 * 86400, 3 * 3600);
+        REQUIRE(moscow.size() == 2);
+        REQUIRE(moscow[0].getDate() == march - 1);
+    }
+}
+
+
+TEST_CASE("Month view with the month index", "[calendar][month]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    for (int i = 0; i < 3000; i++) {
+        vector += gen.getForecast();
+    }
+
+    SECTION("View has the same forecasts as getMonth") {
+        for (int q = 0; q < 200; q++) {
+            long long date = gen.getDate(1570000000, 1900000000);
+            long long smeshenie = 3600 * gen.getDate(-12, 14);
+
+            SlozhniyPrognoz month = vector.getMonth(date, smeshenie);
+            std::span<const ProstoyPrognoz> view = vector.getMonthView(date, smeshenie);
+
+            REQUIRE(view.size() == month.size());
+            for (size_t i = 0; i < view.size(); i++) {
+                REQUIRE(view[i].getDate() == month[i].getDate());
+            }
+        }
+    }
+
+    SECTION("Index is extended when forecasts are appended in order") {
+        vector.sortDates();
+        const SlozhniyPrognoz& c = vector;
+        long long last = c[c.size() - 1].getDate();
+        vector.getMonthView(last);
+
+        // Добавляем по дню в конец: 100 дней, несколько новых месяцев
+        for (int i = 1; i <= 100; i++) {
+            vector += ProstoyPrognoz(last + i * 86400LL, 1.0, 2.0, 3.0, 0.0, "Sunny");
+        }
+
+        for (int i = 1; i <= 100; i += 7) {
+            long long date = last + i * 86400LL;
+            REQUIRE(vector.getMonthView(date).size() == vector.getMonth(date).size());
+        }
+        REQUIRE(vector.getMonthView(last + 1000 * 86400LL).empty());
+    }
+}
+
+
+TEST_CASE("Dense day-indexed storage", "[dnevnoy]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+    DnevnoyPrognoz dnevnoy;
+
+    // Прогнозы ровно на начало суток, с повторами и пропусками, в случайном порядке
+    for (int i = 0; i < 3000; i++) {
+        ProstoyPrognoz p = gen.getForecast();
+        p.setDate(86400 * gen.getDate(18000, 19000));
+        vector += p;
+        dnevnoy += p;
+    }
+
+    vector.mergePovtorki();
+    REQUIRE(dnevnoy.size() == vector.size());
+
+    const SlozhniyPrognoz& c = vector;
+    for (size_t i = 0; i < c.size(); i++) {
+        const ProstoyPrognoz* p = dnevnoy.nayti(c[i].getDate() + 4000);
+        REQUIRE(p != nullptr);
+        REQUIRE(p->getDate() == c[i].getDate());
+        REQUIRE(p->getAverageTemp() == c[i].getAverageTemp());
+        REQUIRE(p->getStatus() == c[i].getStatus());
+    }
+
+    for (int q = 0; q < 100; q++) {
+        long long a = 86400 * gen.getDate(17900, 19100) + gen.getDate(0, 86399);
+        long long b = a + 86400 * gen.getDate(0, 60);
+        DnevnoyPrognoz::Srez srez = dnevnoy.diapazon(a, b);
+
+        size_t est = 0;
+        for (size_t i = 0; i < srez.prognozi.size(); i++) {
+            if (srez.est(i)) est++;
+        }
+        size_t expected = 0;
+        for (size_t i = 0; i < c.size(); i++) {
+            if (c[i].getDate() >= a - a % 86400 && c[i].getDate() <= b) expected++;
+        }
+        REQUIRE(est == expected);
+
+        if (est == 0) {
+            REQUIRE_THROWS_AS(dnevnoy.getColdestDay(a, b), std::logic_error);
+        }
+        else {
+            REQUIRE(dnevnoy.getColdestDay(a, b).getDate() == c.getColdestDay(a - a % 86400, b).getDate());
+        }
+    }
+
+    REQUIRE(dnevnoy.udalit(c[0].getDate()));
+    REQUIRE(dnevnoy.nayti(c[0].getDate()) == nullptr);
+    REQUIRE(dnevnoy.toSlozhniy().size() == c.size() - 1);
+
+    // Ошибочная дата далеко от остальных не раздувает массив, а отклоняется
+    size_t razmah = dnevnoy.razmah();
+    ProstoyPrognoz vibros = gen.getForecast();
+    vibros.setDate(86400 * (19000 + DnevnoyPrognoz::MAKS_RAZMAH));
+    REQUIRE_THROWS_AS(dnevnoy += vibros, std::out_of_range);
+    vibros.setDate(-86400LL * 1000000);
+    REQUIRE_THROWS_AS(dnevnoy += vibros, std::out_of_range);
+    REQUIRE(dnevnoy.razmah() == razmah);
+    REQUIRE(dnevnoy.size() == c.size() - 1);
+
+    // Запас, добавленный при вставке в начало, не засчитывается в охват
+    DnevnoyPrognoz dolgiy;
+    ProstoyPrognoz den = gen.getForecast();
+    for (long long d = 20000; d <= 60000; d++) {
+        den.setDate(86400 * d);
+        dolgiy += den;
+    }
+    den.setDate(86400 * 19999LL);
+    dolgiy += den;
+    den.setDate(86400 * 60001LL);
+    REQUIRE_NOTHROW(dolgiy += den);
+    REQUIRE(dolgiy.razmah() == 40003);
+    REQUIRE(dolgiy.diapazon(0, 86400 * 70000LL).pervyyDen == 19999);
+
+    den.setDate(86400 * (19999 + DnevnoyPrognoz::MAKS_RAZMAH - 1));
+    REQUIRE_NOTHROW(dolgiy += den);
+    REQUIRE(dolgiy.razmah() == (size_t)DnevnoyPrognoz::MAKS_RAZMAH);
+    den.setDate(86400 * 19998LL);
+    REQUIRE_THROWS_AS(dolgiy += den, std::out_of_range);
+    den.setDate(86400 * (19999 + DnevnoyPrognoz::MAKS_RAZMAH));
+    REQUIRE_THROWS_AS(dolgiy += den, std::out_of_range);
+    REQUIRE(dolgiy.size() == 40004);
+}
+
+
+/**
+ * @brief Собирает минимальный файл TZif версии 2: один тип времени и правило в хвосте.
+ * @param smeshenie Смещение единственного типа времени (в секундах).
+ * @param pravilo Строка POSIX TZ для хвоста файла.
+ */
+std::string sobratTZif(int smeshenie, const std::string& pravilo) {
+    auto zagolovok = [](char version) {
+        std::string h = "TZif";
+        h += version;
+        h += std::string(15, '\0');
+        // isutcnt, isstdcnt, leapcnt, timecnt, typecnt = 1, charcnt = 4
+        const int schetchiki[6] = { 0, 0, 0, 0, 1, 4 };
+        for (int c : schetchiki) {
+            h += (char)(c >> 24); h += (char)(c >> 16); h += (char)(c >> 8); h += (char)c;
+        }
+        return h;
+    };
+    std::string tip;
+    tip += (char)(smeshenie >> 24); tip += (char)(smeshenie >> 16); tip += (char)(smeshenie >> 8); tip += (char)smeshenie;
+    tip += '\0'; tip += '\0';
+    std::string blok = tip + std::string("CET\0", 4);
+
+    return zagolovok('2') + blok + zagolovok('2') + blok + "\n" + pravilo + "\n";
+}
+
+TEST_CASE("Timezone transition table", "[calendar][timezone]") {
+    std::stringstream file(sobratTZif(3600, "CET-1CEST,M3.5.0,M10.5.0/3"));
+    ChasovoyPoyas berlin = ChasovoyPoyas::zagruzit(file);
+
+    REQUIRE(berlin.kolvoPerehodov() > 100);
+
+    // 2024-03-31 01:00 UTC - переход на летнее время, 2024-10-27 01:00 UTC - обратно
+    REQUIRE(berlin.smeshenie(1711846799) == 3600);
+    REQUIRE(berlin.smeshenie(1711846800) == 7200);
+    REQUIRE(berlin.smeshenie(1729990799) == 7200);
+    REQUIRE(berlin.smeshenie(1729990800) == 3600);
+
+    // Апрель 2024 по местному времени начинается 2024-03-31 22:00 UTC
+    long long start, end;
+    berlin.granitsiMesyatsa(1712500000, start, end);
+    REQUIRE(start == 1711922400);
+    REQUIRE(end == 1714514400);
+
+    SlozhniyPrognoz vector;
+    vector += ProstoyPrognoz(start - 1, 1.0, 1.0, 1.0, 0.0, "Sunny");
+    vector += ProstoyPrognoz(start, 1.0, 1.0, 1.0, 0.0, "Sunny");
+    vector += ProstoyPrognoz(end - 1, 1.0, 1.0, 1.0, 0.0, "Sunny");
+    vector += ProstoyPrognoz(end, 1.0, 1.0, 1.0, 0.0, "Sunny");
+
+    REQUIRE(vector.getMonth(1712500000, berlin).size() == 2);
+    REQUIRE(vector.getMonthView(1712500000, berlin).size() == 2);
+    REQUIRE(vector.getMonthView(1712500000, berlin)[0].getDate() == start);
+
+    // Постоянное смещение ведет себя так же, как getMonth со смещением
+    ChasovoyPoyas plus3 = ChasovoyPoyas::fiksirovanniy(3 * 3600);
+    REQUIRE(vector.getMonth(1712500000, plus3).size() == vector.getMonth(1712500000, 3 * 3600).size());
+
+    std::stringstream broken("TZif2 broken");
+    REQUIRE_THROWS_AS(ChasovoyPoyas::zagruzit(broken), std::runtime_error);
+    REQUIRE_THROWS_AS(ChasovoyPoyas::zagruzit("/no/such/zoneinfo/file"), std::runtime_error);
+}
+
+
+TEST_CASE("Grouping by time windows", "[calendar][gruppirovat]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    // 50 лет ежедневных прогнозов в случайном порядке
+    for (long long den = 0; den < 50 * 365; den++) {
+        ProstoyPrognoz p = gen.getForecast();
+        p.setDate(946684800 + den * 86400 + gen.getDate(0, 86399));
+        vector += p;
+    }
+    for (int i = 0; i < 1000; i++) {
+        size_t a = (size_t)gen.getDate(0, 50 * 365 - 1);
+        size_t b = (size_t)gen.getDate(0, 50 * 365 - 1);
+        ProstoyPrognoz tmp = vector[a];
+        vector[a] = vector[b];
+        vector[b] = tmp;
+    }
+
+    using TipOkna = SlozhniyPrognoz::TipOkna;
+    const TipOkna tipi[5] = { TipOkna::Nedelya, TipOkna::Dekada, TipOkna::Mesyats, TipOkna::Sezon, TipOkna::God };
+
+    for (TipOkna tip : tipi) {
+        SlozhniyPrognoz::SvodkaOkon svodka = vector.gruppirovat(tip, 3 * 3600);
+
+        REQUIRE(svodka.size() > 0);
+        size_t vsego = 0;
+        for (size_t w = 0; w < svodka.size(); w++) {
+            vsego += svodka.kolvo[w];
+            REQUIRE(svodka.nachalo[w] < svodka.konets[w]);
+            if (w > 0) REQUIRE(svodka.konets[w - 1] <= svodka.nachalo[w]);
+        }
+        REQUIRE(vsego == vector.size());
+
+        // Проверяем несколько окон "в лоб"
+        for (int q = 0; q < 20; q++) {
+            size_t w = (size_t)gen.getDate(0, (long long)svodka.size() - 1);
+            size_t kolvo = 0;
+            double minUtro = 1000.0, summaVecher = 0.0, osadki = 0.0;
+            std::string hudshiy = "Sunny";
+            const SlozhniyPrognoz& c = vector;
+            for (size_t i = 0; i < c.size(); i++) {
+                if (c[i].getDate() >= svodka.nachalo[w] && c[i].getDate() < svodka.konets[w]) {
+                    kolvo++;
+                    minUtro = std::min(minUtro, c[i].getMorningTemp());
+                    summaVecher += c[i].getEveningTemp();
+                    osadki += c[i].getOsadki();
+                    if (ProstoyPrognoz::kodStatusa(c[i].getStatus()) > ProstoyPrognoz::kodStatusa(hudshiy)) {
+                        hudshiy = c[i].getStatus();
+                    }
+                }
+            }
+            REQUIRE(svodka.kolvo[w] == kolvo);
+            REQUIRE(svodka.minUtro[w] == minUtro);
+            REQUIRE(svodka.srednVecher[w] == Approx(summaVecher / kolvo));
+            REQUIRE(svodka.summaOsadkov[w] == Approx(osadki));
+            REQUIRE(ProstoyPrognoz::imyaStatusa(svodka.hudshiyStatus[w]) == hudshiy);
+        }
+    }
+
+    SlozhniyPrognoz::SvodkaOkon goda = vector.gruppirovat(TipOkna::God);
+    REQUIRE(goda.size() == 50);
+    REQUIRE(goda.nachalo[0] == 946684800);
+
+    // Зима 2000/2001 начинается 1 декабря 2000 года
+    SlozhniyPrognoz::SvodkaOkon sezoni = vector.gruppirovat(TipOkna::Sezon);
+    REQUIRE(sezoni.nachalo[1] == Kalendar::daysFromCivil(2000, 3, 1) * 86400);
+    REQUIRE(sezoni.nachalo[4] == Kalendar::daysFromCivil(2000, 12, 1) * 86400);
+}
+
+
+TEST_CASE("Incrementally maintained monthly summaries", "[svodki]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    REQUIRE_THROWS_AS(vector.getSvodkaMesyatsa(1700000000), std::logic_error);
+
+    for (int i = 0; i < 2000; i++) {
+        vector += gen.getForecast();
+    }
+    vector.vklyuchitSvodki(3 * 3600);
+
+    // Сводка "в лоб" по всем прогнозам
+    auto proverit = [&](long long date) {
+        SlozhniyPrognoz::SvodkaMesyatsa svodka = vector.getSvodkaMesyatsa(date);
+        long long klyuch = Kalendar::klyuchMesyatsa(date, 3 * 3600);
+        size_t kolvo = 0, oshibok = 0, sunny = 0;
+        double temp = 0.0, osadki = 0.0;
+        const SlozhniyPrognoz& c = vector;
+        for (size_t i = 0; i < c.size(); i++) {
+            if (Kalendar::klyuchMesyatsa(c[i].getDate(), 3 * 3600) != klyuch) continue;
+            kolvo++;
+            temp += c[i].getAverageTemp();
+            osadki += c[i].getOsadki();
+            if (c[i].oshibka()) oshibok++;
+            if (c[i].getStatus() == "Sunny") sunny++;
+        }
+        REQUIRE(svodka.kolvo == kolvo);
+        REQUIRE(svodka.summaTemp == Approx(temp).margin(1e-6));
+        REQUIRE(svodka.summaOsadkov == Approx(osadki).margin(1e-6));
+        REQUIRE(svodka.oshibok == oshibok);
+        REQUIRE(svodka.poStatusam[ProstoyPrognoz::kodStatusa("Sunny")] == sunny);
+    };
+
+    for (int q = 0; q < 200; q++) {
+        int deystvie = (int)gen.getDate(0, 3);
+        if (deystvie == 0) {
+            vector += gen.getForecast();
+        }
+        else if (deystvie == 1 && vector.size() > 1) {
+            vector.remove((size_t)gen.getDate(0, (long long)vector.size() - 1));
+        }
+        else if (deystvie == 2) {
+            // Запись через operator[], в том числе перенос в другой месяц
+            size_t i = (size_t)gen.getDate(0, (long long)vector.size() - 1);
+            vector[i] = gen.getForecast();
+            vector[i].setOsadki(vector[i].getOsadki() + 1.0);
+        }
+        else {
+            ProstoyPrognoz p = gen.getForecast();
+            p.setDate(vector[(size_t)gen.getDate(0, (long long)vector.size() - 1)].getDate());
+            vector += p;
+        }
+        const SlozhniyPrognoz& c = vector;
+        proverit(c[(size_t)gen.getDate(0, (long long)c.size() - 1)].getDate());
+    }
+
+    vector.mergePovtorki();
+    for (int q = 0; q < 50; q++) {
+        const SlozhniyPrognoz& c = vector;
+        proverit(c[(size_t)gen.getDate(0, (long long)c.size() - 1)].getDate());
+    }
+
+    // Запись по ссылке учитывается до следующего запроса; после него ссылка берется заново
+    // и снова отмечает прогноз как измененный
+    {
+        const SlozhniyPrognoz& c = vector;
+        size_t i = (size_t)gen.getDate(0, (long long)c.size() - 1);
+        long long date = c[i].getDate();
+        ProstoyPrognoz& ssylka = vector[i];
+        ssylka.setOsadki(ssylka.getOsadki() + 5.0);
+        proverit(date);
+        vector[i].setOsadki(vector[i].getOsadki() + 7.0);
+        proverit(date);
+        vector[i].setDate(date + 40LL * 86400);
+        proverit(date);
+        proverit(date + 40LL * 86400);
+    }
+
+    SlozhniyPrognoz kopiya = vector;
+    REQUIRE(kopiya.getSvodkaMesyatsa(1700000000).kolvo == vector.getSvodkaMesyatsa(1700000000).kolvo);
+    REQUIRE(vector.getSvodkaMesyatsa(0).kolvo == 0);
+
+    vector.viklyuchitSvodki();
+    REQUIRE_THROWS_AS(vector.getSvodkaMesyatsa(1700000000), std::logic_error);
+}
+
+
+TEST_CASE("Rolling windows by days", "[skolzyashie]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    // Пропуски в днях и несколько прогнозов за один день, в случайном порядке
+    for (int i = 0; i < 3000; i++) {
+        ProstoyPrognoz p = gen.getForecast();
+        p.setDate(1577836800 + gen.getDate(0, 1500) * 86400 + gen.getDate(0, 86399));
+        vector += p;
+    }
+
+    SlozhniyPrognoz::SkolzyashieOkna okna;
+    REQUIRE_THROWS_AS(vector.skolzyashieOkna(0, okna), std::invalid_argument);
+
+    const long long dlini[3] = { 1, 7, 30 };
+    for (long long dney : dlini) {
+        vector.skolzyashieOkna(dney, okna, 3 * 3600);
+        REQUIRE(okna.size() == vector.size());
+
+        for (int q = 0; q < 200; q++) {
+            size_t k = (size_t)gen.getDate(0, (long long)okna.size() - 1);
+            if (k > 0) REQUIRE(okna.date[k - 1] <= okna.date[k]);
+
+            long long den = Kalendar::denIzDati(okna.date[k], 3 * 3600);
+            size_t kolvo = 0;
+            double summa = 0.0, minT = 1000.0, maxT = -1000.0, osadki = 0.0;
+            const SlozhniyPrognoz& c = vector;
+            for (size_t i = 0; i < c.size(); i++) {
+                long long d = Kalendar::denIzDati(c[i].getDate(), 3 * 3600);
+                if (d > den - dney && d <= den) {
+                    kolvo++;
+                    summa += c[i].getAverageTemp();
+                    minT = std::min(minT, c[i].getAverageTemp());
+                    maxT = std::max(maxT, c[i].getAverageTemp());
+                    osadki += c[i].getOsadki();
+                }
+            }
+            REQUIRE(okna.kolvo[k] == kolvo);
+            REQUIRE(okna.srednTemp[k] == Approx(summa / kolvo));
+            REQUIRE(okna.minTemp[k] == minT);
+            REQUIRE(okna.maxTemp[k] == maxT);
+            REQUIRE(okna.summaOsadkov[k] == Approx(osadki).margin(1e-6));
+        }
+    }
+
+    // Отсортированный массив дает тот же результат, память столбцов переиспользуется
+    SlozhniyPrognoz::SkolzyashieOkna nesortirovannie = okna;
+    const double* pamyat = okna.srednTemp.data();
+    const size_t* pamyatKolva = okna.kolvo.data();
+    vector.sortDates();
+    vector.skolzyashieOkna(30, okna, 3 * 3600);
+    REQUIRE(okna.srednTemp.data() == pamyat);
+    REQUIRE(okna.kolvo.data() == pamyatKolva);
+    REQUIRE(okna.kolvo == nesortirovannie.kolvo);
+    REQUIRE(okna.maxTemp == nesortirovannie.maxTemp);
+}
+
+
+TEST_CASE("Top-K query by key", "[topK]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    for (int i = 0; i < 5000; i++) {
+        vector += gen.getForecast();
+    }
+
+    using Klyuch = SlozhniyPrognoz::Klyuch;
+    using Poryadok = SlozhniyPrognoz::Poryadok;
+    const Klyuch klyuchi[5] = { Klyuch::SrednyayaTemp, Klyuch::Utro, Klyuch::Den, Klyuch::Vecher, Klyuch::Osadki };
+
+    auto znachenie = [](const ProstoyPrognoz& p, Klyuch klyuch) {
+        switch (klyuch) {
+        case Klyuch::SrednyayaTemp: return p.getAverageTemp();
+        case Klyuch::Utro: return p.getMorningTemp();
+        case Klyuch::Den: return p.getDayTemp();
+        case Klyuch::Vecher: return p.getEveningTemp();
+        default: return p.getOsadki();
+        }
+    };
+
+    for (int prohod = 0; prohod < 2; prohod++) {
+        if (prohod == 1) vector.sortDates();
+        const SlozhniyPrognoz& c = vector;
+
+        for (int q = 0; q < 40; q++) {
+            long long a = gen.getDate(1577836800, 1893456000);
+            long long b = gen.getDate(a, 1893456000);
+            Klyuch klyuch = klyuchi[q % 5];
+            Poryadok poryadok = (q % 2 == 0) ? Poryadok::Naimenshie : Poryadok::Naibolshie;
+            size_t k = (size_t)gen.getDate(1, 20);
+
+            // Эталон: полная сортировка значений из диапазона
+            std::vector<double> vse;
+            for (size_t i = 0; i < c.size(); i++) {
+                if (c[i].getDate() >= a && c[i].getDate() <= b) vse.push_back(znachenie(c[i], klyuch));
+            }
+            std::sort(vse.begin(), vse.end());
+            if (poryadok == Poryadok::Naibolshie) std::reverse(vse.begin(), vse.end());
+
+            std::vector<size_t> top = vector.topK(a, b, klyuch, k, poryadok);
+            REQUIRE(top.size() == std::min(k, vse.size()));
+            for (size_t j = 0; j < top.size(); j++) {
+                REQUIRE(c[top[j]].getDate() >= a);
+                REQUIRE(c[top[j]].getDate() <= b);
+                REQUIRE(znachenie(c[top[j]], klyuch) == vse[j]);
+            }
+        }
+    }
+
+    // Самый холодный совпадает с getColdestDay
+    const SlozhniyPrognoz& c = vector;
+    std::vector<size_t> top = vector.topK(1577836800, 1893456000, Klyuch::SrednyayaTemp, 1, Poryadok::Naimenshie);
+    REQUIRE(c[top[0]].getAverageTemp() == vector.getColdestDay(1577836800, 1893456000).getAverageTemp());
+    REQUIRE(vector.topK(1577836800, 1893456000, Klyuch::Osadki, 0, Poryadok::Naibolshie).empty());
+    REQUIRE(vector.topK(10, 0, Klyuch::Osadki, 5, Poryadok::Naibolshie).empty());
+}
+
+
+TEST_CASE("Quantile sketches", "[kvantili]") {
+    RandomGen gen;
+
+    REQUIRE_THROWS_AS(EskizKvantiley(4), std::invalid_argument);
+    EskizKvantiley pustoy;
+    REQUIRE_THROWS_AS(pustoy.kvantil(0.5), std::logic_error);
+
+    // Поток 200000 значений: память ограничена, ошибка ранга небольшая
+    EskizKvantiley eskiz;
+    EskizKvantiley chasti[4];
+    std::vector<double> vse;
+    for (int i = 0; i < 200000; i++) {
+        double x = gen.getDouble(-40.0, 40.0) + gen.getDouble(0.0, 10.0) * gen.getDouble(0.0, 1.0);
+        vse.push_back(x);
+        eskiz.dobavit(x);
+        chasti[i % 4].dobavit(x);
+    }
+    REQUIRE_THROWS_AS(eskiz.kvantil(1.5), std::invalid_argument);
+    REQUIRE(eskiz.size() == 200000);
+    REQUIRE(eskiz.hranimih() < 4 * EskizKvantiley::K_PO_UMOLCHANIYU);
+
+    EskizKvantiley obedinenniy = chasti[0];
+    for (int i = 1; i < 4; i++) obedinenniy.obedinit(chasti[i]);
+    REQUIRE(obedinenniy.size() == 200000);
+    REQUIRE(obedinenniy.hranimih() < 4 * EskizKvantiley::K_PO_UMOLCHANIYU);
+
+    std::sort(vse.begin(), vse.end());
+    REQUIRE(eskiz.kvantil(0.0) == vse.front());
+    REQUIRE(eskiz.kvantil(1.0) == vse.back());
+    const double urovni[5] = { 0.05, 0.25, 0.5, 0.75, 0.95 };
+    for (double q : urovni) {
+        for (EskizKvantiley* e : { &eskiz, &obedinenniy }) {
+            double x = e->kvantil(q);
+            // Истинный ранг найденного значения
+            double r = (double)(std::upper_bound(vse.begin(), vse.end(), x) - vse.begin()) / vse.size();
+            REQUIRE(std::abs(r - q) < 0.03);
+            REQUIRE(std::abs(e->rang(x) - r) < 0.03);
+        }
+    }
+
+    // Скетчи по прогнозам: за диапазон и по месяцам
+    SlozhniyPrognoz vector;
+    for (int i = 0; i < 20000; i++) {
+        vector += gen.getForecast();
+    }
+    using Klyuch = SlozhniyPrognoz::Klyuch;
+    const SlozhniyPrognoz& c = vector;
+
+    EskizKvantiley zaVse = vector.eskizKvantiley(1577836800, 1893456000, Klyuch::Utro);
+    REQUIRE(zaVse.size() == vector.size());
+    std::vector<double> utro;
+    for (size_t i = 0; i < c.size(); i++) utro.push_back(c[i].getMorningTemp());
+    std::sort(utro.begin(), utro.end());
+    double mediana = zaVse.kvantil(0.5);
+    double r = (double)(std::upper_bound(utro.begin(), utro.end(), mediana) - utro.begin()) / utro.size();
+    REQUIRE(std::abs(r - 0.5) < 0.03);
+
+    std::map<long long, EskizKvantiley> poMesyatsam = vector.eskiziPoMesyatsam(Klyuch::Osadki, 3 * 3600);
+    unsigned long long vsego = 0;
+    for (auto& [klyuch, e] : poMesyatsam) {
+        vsego += e.size();
+    }
+    REQUIRE(vsego == vector.size());
+
+    vector.sortDates();
+    long long date = c[c.size() / 2].getDate();
+    long long startMonth = 0, endMonth = 0;
+    Kalendar::granitsiMesyatsa(date, 3 * 3600, startMonth, endMonth);
+    EskizKvantiley mesyats = vector.eskizKvantiley(startMonth, endMonth - 1, Klyuch::Osadki);
+    EskizKvantiley& izKarty = poMesyatsam.at(Kalendar::klyuchMesyatsa(date, 3 * 3600));
+    REQUIRE(mesyats.size() == izKarty.size());
+    REQUIRE(mesyats.kvantil(1.0) == izKarty.kvantil(1.0));
+}
+
+
+TEST_CASE("Prefix-sum and Fenwick range totals", "[summi]") {
+    RandomGen gen;
+
+    using TipIndeksaSumm = SlozhniyPrognoz::TipIndeksaSumm;
+    for (TipIndeksaSumm tip : { TipIndeksaSumm::Prefiksniy, TipIndeksaSumm::Fenwick }) {
+        SlozhniyPrognoz vector;
+        for (int i = 0; i < 3000; i++) {
+            vector += gen.getForecast();
+        }
+        vector.nastroitIndeksSumm(tip, 20.0);
+
+        // Суммы "в лоб"
+        auto proverit = [&](long long a, long long b) {
+            SlozhniyPrognoz::SummiZaPeriod summi = vector.getSummi(a, b);
+            size_t kolvo = 0;
+            double osadki = 0.0, otoplenie = 0.0, ohlazhdenie = 0.0;
+            const SlozhniyPrognoz& c = vector;
+            for (size_t i = 0; i < c.size(); i++) {
+                if (c[i].getDate() < a || c[i].getDate() > b) continue;
+                kolvo++;
+                osadki += c[i].getOsadki();
+                otoplenie += std::max(0.0, 20.0 - c[i].getAverageTemp());
+                ohlazhdenie += std::max(0.0, c[i].getAverageTemp() - 20.0);
+            }
+            REQUIRE(summi.kolvo == kolvo);
+            REQUIRE(summi.osadki == Approx(osadki).margin(1e-6));
+            REQUIRE(summi.gradusoDniOtopleniya == Approx(otoplenie).margin(1e-6));
+            REQUIRE(summi.gradusoDniOhlazhdeniya == Approx(ohlazhdenie).margin(1e-6));
+        };
+
+        for (int q = 0; q < 300; q++) {
+            int deystvie = (int)gen.getDate(0, 3);
+            const SlozhniyPrognoz& c = vector;
+            if (deystvie == 0) {
+                // Добавление в конец по порядку дат - индекс дополняется
+                ProstoyPrognoz p = gen.getForecast();
+                p.setDate(c[c.size() - 1].getDate() + gen.getDate(0, 86400));
+                vector += p;
+            }
+            else if (deystvie == 1) {
+                // Запись через [] без изменения даты - точечное обновление для Fenwick
+                size_t i = (size_t)gen.getDate(0, (long long)c.size() - 1);
+                vector[i].setOsadki(gen.getDouble(0.0, 50.0));
+                vector[i].setDayTemp(gen.getDouble(-30.0, 40.0));
+            }
+            else if (deystvie == 2 && q % 20 == 0) {
+                // Запись, нарушающая порядок, и удаление - индекс строится заново
+                vector[(size_t)gen.getDate(0, (long long)c.size() - 1)].setDate(gen.getDate(1577836800, 1893456000));
+                vector.remove((size_t)gen.getDate(0, (long long)c.size() - 1));
+            }
+            long long a = gen.getDate(1577836800, 1893456000);
+            proverit(a, gen.getDate(a, 1893456000));
+        }
+
+        SlozhniyPrognoz kopiya = vector;
+        REQUIRE(kopiya.getSummi(0, 2000000000).kolvo == vector.size());
+        REQUIRE(vector.getSummi(10, 0).kolvo == 0);
+    }
+}
+
+
+TEST_CASE("Streak index", "[serii]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    // Ежедневные прогнозы с пропусками и повторами за день
+    auto dobavit = [&](long long den) {
+        ProstoyPrognoz p = gen.getForecast();
+        p.setDate(1577836800 + den * 86400 + gen.getDate(0, 86399));
+        vector += p;
+    };
+    long long den = 0;
+    for (; den < 1500; den++) {
+        if (gen.getDate(0, 30) == 0) continue;
+        dobavit(den);
+        if (gen.getDate(0, 30) == 0) dobavit(den);
+    }
+
+    using Uslovie = SlozhniyPrognoz::UslovieSerii;
+    const Uslovie usloviya[3] = { Uslovie::poStatusu("Sunny"), Uslovie::moroz(), Uslovie::zhara(20.0) };
+
+    // Самая длинная серия "в лоб" по отсортированной копии
+    auto dlinneyshaya = [&](const Uslovie& u, long long a, long long b) {
+        SlozhniyPrognoz kopiya = vector;
+        kopiya.sortDates();
+        const SlozhniyPrognoz& c = kopiya;
+        long long luchshaya = 0, tekushaya = 0, nachalo = 0, prevDen = 0;
+        bool prevOk = false;
+        for (size_t i = 0; i < c.size(); i++) {
+            if (c[i].getDate() < a || c[i].getDate() > b) continue;
+            long long d = Kalendar::denIzDati(c[i].getDate());
+            bool ok = u.vipolneno(c[i]);
+            if (ok && prevOk && d - prevDen <= 1) {
+                tekushaya = d - nachalo + 1;
+            }
+            else if (ok) {
+                nachalo = d;
+                tekushaya = 1;
+            }
+            prevOk = ok;
+            prevDen = d;
+            luchshaya = std::max(luchshaya, ok ? tekushaya : 0);
+        }
+        return luchshaya;
+    };
+
+    for (int q = 0; q < 150; q++) {
+        const Uslovie& u = usloviya[q % 3];
+        long long a = 1577836800 + gen.getDate(-10, den + 10) * 86400 + gen.getDate(0, 86399);
+        long long b = a + gen.getDate(0, 400) * 86400;
+
+        long long ozhidaem = dlinneyshaya(u, a, b);
+        if (ozhidaem == 0) {
+            REQUIRE_THROWS_AS(vector.getSamayaDlinnayaSeriya(u, a, b), std::logic_error);
+        }
+        else {
+            SlozhniyPrognoz::Seriya s = vector.getSamayaDlinnayaSeriya(u, a, b);
+            REQUIRE(s.dney == ozhidaem);
+            REQUIRE(s.nachalo >= a);
+            REQUIRE(s.konets <= b);
+            const SlozhniyPrognoz& c = vector;
+            for (size_t i = s.pervyy; i <= s.posledniy; i++) {
+                REQUIRE(u.vipolneno(c[i]));
+            }
+        }
+
+        std::vector<SlozhniyPrognoz::Seriya> serii = vector.getSerii(u, a, b);
+        for (size_t i = 0; i < serii.size(); i++) {
+            REQUIRE(serii[i].konets >= a);
+            REQUIRE(serii[i].nachalo <= b);
+            if (i > 0) REQUIRE(serii[i - 1].posledniy < serii[i].pervyy);
+        }
+
+        // Добавление в конец: индексы серий дополняются
+        if (q % 10 == 0) {
+            for (int j = 0; j < 20; j++, den++) {
+                dobavit(den);
+            }
+        }
+    }
+}
+
+
+TEST_CASE("Composable filters", "[filtr]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+
+    for (int i = 0; i < 5000; i++) {
+        vector += gen.getForecast();
+    }
+    const SlozhniyPrognoz& c = vector;
+
+    using Pole = Filtr::Pole;
+    using Op = Filtr::Operaciya;
+
+    REQUIRE_THROWS_AS(Filtr::statusi({ "Hail" }), std::out_of_range);
+
+    // "Дождливые дни с вечерней температурой ниже 5 градусов в марте 2024 года"
+    long long mart = Kalendar::daysFromCivil(2024, 3, 1) * 86400;
+    long long aprel = Kalendar::daysFromCivil(2024, 4, 1) * 86400;
+    Filtr f1 = Filtr::statusi({ "Rain" }) && Filtr::sravnenie(Pole::Vecher, Op::Menshe, 5.0) && Filtr::daty(mart, aprel - 1);
+    REQUIRE(f1.nizhnyaya() == mart);
+    REQUIRE(f1.verhnyaya() == aprel - 1);
+
+    Filtr f2 = (Filtr::statusi({ "Snow", "Cloudy" }) || Filtr::sravnenie(Pole::Osadki, Op::BolsheIliRavno, 50.0))
+        && !Filtr::sravnenie(Pole::SrednyayaTemp, Op::Bolshe, 0.0);
+    Filtr f3 = !(Filtr::daty(1600000000, 1700000000) || Filtr::oshibochnie()) || Filtr::sravnenie(Pole::Utro, Op::Ravno, 10.0);
+    Filtr f4 = Filtr::daty(1700000000, 1600000000) && Filtr();
+
+    auto etalon1 = [&](const ProstoyPrognoz& p) {
+        return p.getStatus() == "Rain" && p.getEveningTemp() < 5.0 && p.getDate() >= mart && p.getDate() < aprel;
+    };
+    auto etalon2 = [&](const ProstoyPrognoz& p) {
+        return (p.getStatus() == "Snow" || p.getStatus() == "Cloudy" || p.getOsadki() >= 50.0) && !(p.getAverageTemp() > 0.0);
+    };
+    auto etalon3 = [&](const ProstoyPrognoz& p) {
+        return !((p.getDate() >= 1600000000 && p.getDate() <= 1700000000) || p.oshibka()) || p.getMorningTemp() == 10.0;
+    };
+
+    for (int prohod = 0; prohod < 2; prohod++) {
+        // Второй проход - по отсортированному массиву (с пропуском по границам дат)
+        if (prohod == 1) vector.sortDates();
+
+        std::vector<size_t> r1 = vector.nayti(f1);
+        std::vector<size_t> r2 = vector.nayti(f2);
+        std::vector<size_t> r3 = vector.nayti(f3);
+        std::vector<size_t> e1, e2, e3;
+        for (size_t i = 0; i < c.size(); i++) {
+            if (etalon1(c[i])) e1.push_back(i);
+            if (etalon2(c[i])) e2.push_back(i);
+            if (etalon3(c[i])) e3.push_back(i);
+            REQUIRE(f2.proverit(c[i]) == etalon2(c[i]));
+            REQUIRE(f3.proverit(c[i]) == etalon3(c[i]));
+        }
+        REQUIRE(r1 == e1);
+        REQUIRE(r2 == e2);
+        REQUIRE(r3 == e3);
+        REQUIRE(vector.poschitat(f2) == e2.size());
+        REQUIRE(vector.poschitat(Filtr()) == vector.size());
+        REQUIRE(vector.poschitat(f4) == 0);
+
+        std::vector<const ProstoyPrognoz*> vid = vector.vibrat(f3);
+        REQUIRE(vid.size() == e3.size());
+        for (size_t i = 0; i < vid.size(); i++) {
+            REQUIRE(vid[i] == &c[e3[i]]);
+        }
+    }
+}
+
+
+TEST_CASE("Multi-station store", "[stancii]") {
+    RandomGen gen;
+    HranilisheStanciy hranilishe;
+    std::map<std::string, SlozhniyPrognoz> etalon;
+
+    // Прогнозы станций приходят вперемешку и в несколько приемов
+    for (int priem = 0; priem < 3; priem++) {
+        for (int i = 0; i < 3000; i++) {
+            std::string id = "ST" + std::to_string(gen.getDate(0, 49));
+            ProstoyPrognoz p = gen.getForecast();
+            hranilishe.dobavit(id, p);
+            etalon[id] += p;
+        }
+        REQUIRE(hranilishe.size() == (size_t)(priem + 1) * 3000);
+        hranilishe.uplotnit();
+    }
+    ProstoyPrognoz osobiy(1700000000, 1.0, 2.0, 3.0, 0.0, "Fog");
+    hranilishe.dobavit("ST7", osobiy);
+    etalon["ST7"] += osobiy;
+
+    REQUIRE(hranilishe.kolvoStanciy() == etalon.size());
+    REQUIRE_THROWS_AS(hranilishe.getStanciya("nope"), std::out_of_range);
+    REQUIRE(hranilishe.nomerStancii("nope") == SlozhniyPrognoz::NE_NAYDENO);
+
+    for (auto& [id, vector] : etalon) {
+        vector.sortDates();
+        const SlozhniyPrognoz& c = vector;
+        std::span<const ProstoyPrognoz> blok = hranilishe.getStanciya(id);
+        REQUIRE(blok.size() == c.size());
+        for (size_t i = 0; i < c.size(); i++) {
+            REQUIRE(blok[i].getDate() == c[i].getDate());
+        }
+        REQUIRE(hranilishe.getMonthView(id, 1700000000).size() == c.getMonth(1700000000).size());
+    }
+
+    // Запросы по набору станций за один проход
+    std::vector<std::string> nabor = { "ST1", "ST2", "ST3" };
+    long long a = 1600000000, b = 1800000000;
+    HranilisheStanciy::Nahodka holod = hranilishe.getColdestDay(nabor, a, b);
+    double minimum = 1000.0;
+    for (const std::string& id : nabor) {
+        minimum = std::min(minimum, etalon[id].getColdestDay(a, b).getAverageTemp());
+    }
+    REQUIRE(hranilishe.prognoz(holod).getAverageTemp() == minimum);
+    REQUIRE(hranilishe.prognoz(hranilishe.getColdestDay({}, 0, 2000000000)).getAverageTemp() <= minimum);
+
+    HranilisheStanciy::Nahodka solnce = hranilishe.getNextSunnyDay(nabor, a);
+    long long blizhayshiy = 2000000000;
+    for (const std::string& id : nabor) {
+        const SlozhniyPrognoz& c = etalon[id];
+        for (size_t i = 0; i < c.size(); i++) {
+            if (c[i].getDate() >= a && c[i].getStatus() == "Sunny") blizhayshiy = std::min(blizhayshiy, c[i].getDate());
+        }
+    }
+    REQUIRE(hranilishe.prognoz(solnce).getDate() == blizhayshiy);
+
+    Filtr filtr = Filtr::statusi({ "Rain", "Snow" }) && Filtr::daty(a, b);
+    size_t ozhidaem = 0;
+    for (auto& [id, vector] : etalon) {
+        ozhidaem += vector.poschitat(filtr);
+    }
+    std::vector<HranilisheStanciy::Nahodka> naydennie = hranilishe.nayti({}, filtr);
+    REQUIRE(naydennie.size() == ozhidaem);
+    REQUIRE(hranilishe.poschitat({}, filtr) == ozhidaem);
+    for (const HranilisheStanciy::Nahodka& n : naydennie) {
+        REQUIRE(filtr.proverit(hranilishe.prognoz(n)));
+    }
+
+    // Двоичный формат: сохранение и загрузка
+    std::stringstream potok(std::ios::in | std::ios::out | std::ios::binary);
+    hranilishe.sohranit(potok);
+    HranilisheStanciy zagruzhennoe = HranilisheStanciy::zagruzit(potok);
+    REQUIRE(zagruzhennoe.kolvoStanciy() == hranilishe.kolvoStanciy());
+    REQUIRE(zagruzhennoe.size() == hranilishe.size());
+    for (auto& [id, vector] : etalon) {
+        std::span<const ProstoyPrognoz> x = hranilishe.getStanciya(id);
+        std::span<const ProstoyPrognoz> y = zagruzhennoe.getStanciya(id);
+        REQUIRE(x.size() == y.size());
+        for (size_t i = 0; i < x.size(); i++) {
+            REQUIRE(x[i].getDate() == y[i].getDate());
+            REQUIRE(x[i].getEveningTemp() == y[i].getEveningTemp());
+            REQUIRE(x[i].getStatus() == y[i].getStatus());
+        }
+    }
+    REQUIRE(zagruzhennoe.toSlozhniy("ST7").size() == etalon["ST7"].size());
+
+    std::string dannie = potok.str();
+    std::stringstream obrezannie(dannie.substr(0, dannie.size() - 10));
+    REQUIRE_THROWS_AS(HranilisheStanciy::zagruzit(obrezannie), std::runtime_error);
+    std::stringstream chuzhie("TZif2 not a store");
+    REQUIRE_THROWS_AS(HranilisheStanciy::zagruzit(chuzhie), std::runtime_error);
+
+    // Справочник, в котором сумма длин блоков переполняется и снова совпадает с числом записей
+    auto zapisatChislo = [](std::string& s, uint64_t x, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) s.push_back((char)((x >> (8 * i)) & 0xFF));
+    };
+    auto stanciya = [&](std::string& s, const std::string& id, uint64_t nachalo, uint64_t kolvo) {
+        zapisatChislo(s, id.size(), 4);
+        s += id;
+        zapisatChislo(s, nachalo, 8);
+        zapisatChislo(s, kolvo, 8);
+        zapisatChislo(s, 0, 1);  // Без координат
+        zapisatChislo(s, 0, 8);
+        zapisatChislo(s, 0, 8);
+    };
+    std::string perepolnenie = "FCST";
+    zapisatChislo(perepolnenie, 3, 4);
+    zapisatChislo(perepolnenie, 2, 8);
+    stanciya(perepolnenie, "A", 0, ~0ULL);
+    stanciya(perepolnenie, "B", ~0ULL, 1);
+    zapisatChislo(perepolnenie, 0, 4);
+    zapisatChislo(perepolnenie, 0, 8);
+    std::stringstream perepolnennie(perepolnenie);
+    REQUIRE_THROWS_AS(HranilisheStanciy::zagruzit(perepolnennie), std::runtime_error);
+
+    // Заявлено больше записей, чем помещается в потоке
+    std::string mnogo = "FCST";
+    zapisatChislo(mnogo, 3, 4);
+    zapisatChislo(mnogo, 1, 8);
+    stanciya(mnogo, "A", 0, 1ULL << 40);
+    zapisatChislo(mnogo, 0, 4);
+    zapisatChislo(mnogo, 1ULL << 40, 8);
+    std::stringstream mnogoZapisey(mnogo);
+    REQUIRE_THROWS_AS(HranilisheStanciy::zagruzit(mnogoZapisey), std::runtime_error);
+}
+
+TEST_CASE("Spatial index of stations", "[stancii][prostranstvo]") {
+    RandomGen gen;
+    HranilisheStanciy hranilishe;
+    std::vector<std::pair<double, double>> koordinati;
+    for (int i = 0; i < 2000; i++) {
+        double shirota = gen.getDouble(-90.0, 90.0);
+        double dolgota = gen.getDouble(-180.0, 180.0);
+        koordinati.push_back({ shirota, dolgota });
+        hranilishe.ustanovitKoordinati("ST" + std::to_string(i), shirota, dolgota);
+    }
+    hranilishe.dobavitStanciyu("bez koordinat");
+    hranilishe.dobavit("ST5", gen.getForecast());
+    REQUIRE_THROWS_AS(hranilishe.ustanovitKoordinati("ST0", 91.0, 0.0), std::invalid_argument);
+    double shirota, dolgota;
+    REQUIRE_FALSE(hranilishe.getKoordinati("bez koordinat", shirota, dolgota));
+    REQUIRE(hranilishe.getKoordinati("ST3", shirota, dolgota));
+    REQUIRE(shirota == koordinati[3].first);
+
+    REQUIRE(KDDerevo::rasstoyanie(0.0, 179.5, 0.0, -179.5) == Approx(111.195).epsilon(0.001));
+
+    // Сравнение с полным перебором
+    for (int z = 0; z < 200; z++) {
+        double qShirota = gen.getDouble(-90.0, 90.0);
+        double qDolgota = gen.getDouble(-180.0, 180.0);
+        std::vector<std::pair<double, size_t>> perebor;
+        for (size_t i = 0; i < koordinati.size(); i++) {
+            perebor.push_back({ KDDerevo::rasstoyanie(qShirota, qDolgota, koordinati[i].first, koordinati[i].second), i });
+        }
+        std::sort(perebor.begin(), perebor.end());
+
+        std::vector<KDDerevo::Sosed> sosedi = hranilishe.blizhayshieStancii(qShirota, qDolgota, 10);
+        REQUIRE(sosedi.size() == 10);
+        for (size_t i = 0; i < sosedi.size(); i++) {
+            REQUIRE(sosedi[i].rasstoyanie == Approx(perebor[i].first).margin(1e-6));
+        }
+        REQUIRE(hranilishe.idStancii(sosedi[0].nomer) == "ST" + std::to_string(perebor[0].second));
+
+        double minShirota = gen.getDouble(-90.0, 80.0);
+        double maxShirota = minShirota + gen.getDouble(0.0, 30.0);
+        double minDolgota = gen.getDouble(-180.0, 180.0);
+        double maxDolgota = gen.getDouble(-180.0, 180.0);  // Может быть меньше minDolgota - через 180-й меридиан
+        std::vector<size_t> ozhidaem;
+        for (size_t i = 0; i < koordinati.size(); i++) {
+            auto [f, l] = koordinati[i];
+            bool poDolgote = (minDolgota <= maxDolgota) ? (l >= minDolgota && l <= maxDolgota) : (l >= minDolgota || l <= maxDolgota);
+            if (f >= minShirota && f <= maxShirota && poDolgote) ozhidaem.push_back(i);
+        }
+        REQUIRE(hranilishe.stanciiVPryamougolnike(minShirota, maxShirota, minDolgota, maxDolgota) == ozhidaem);
+    }
+
+    // Номера станций передаются в запросы по набору станций
+    std::vector<KDDerevo::Sosed> ryadom = hranilishe.blizhayshieStancii(koordinati[5].first, koordinati[5].second, 3);
+    REQUIRE(ryadom[0].nomer == 5);
+    std::vector<size_t> nomera = { ryadom[0].nomer, ryadom[1].nomer, ryadom[2].nomer };
+    std::vector<std::string> ids = hranilishe.idStanciy(nomera);
+    REQUIRE(ids[0] == "ST5");
+    REQUIRE(hranilishe.poschitat(ids, Filtr()) == 1);
+
+    // Координаты сохраняются в двоичном формате
+    std::stringstream potok(std::ios::in | std::ios::out | std::ios::binary);
+    hranilishe.sohranit(potok);
+    HranilisheStanciy zagruzhennoe = HranilisheStanciy::zagruzit(potok);
+    REQUIRE(zagruzhennoe.getKoordinati("ST3", shirota, dolgota));
+    REQUIRE(dolgota == koordinati[3].second);
+    REQUIRE(zagruzhennoe.blizhayshieStancii(koordinati[7].first, koordinati[7].second, 1)[0].nomer == 7);
+}
+
+TEST_CASE("Batch kernels for averages and error mask", "[yadra]") {
+    RandomGen gen;
+    std::vector<ProstoyPrognoz> prognozi;
+    const double granici[] = { 0.0, -100.0, 60.0, 1500.0, -0.0, 1e-9, -1e-9, 60.000001, -100.000001, 1500.000001 };
+    const std::string statusi[] = { "Sunny", "Cloudy", "Rain", "Snow", "Fog" };
+    for (int i = 0; i < 5000; i++) {
+        // Значения на границах правил и NaN встречаются чаще, чем при равномерном выборе
+        auto znachenie = [&](double min, double max) {
+            long long v = gen.getDate(0, 9);
+            if (v < 4) return granici[gen.getDate(0, 9)];
+            if (v == 4) return std::numeric_limits<double>::quiet_NaN();
+            return gen.getDouble(min, max);
+        };
+        prognozi.emplace_back(gen.getDate(0, 2000000000), znachenie(-120.0, 80.0), znachenie(-120.0, 80.0),
+            znachenie(-120.0, 80.0), znachenie(0.0, 2000.0), statusi[gen.getDate(0, 4)]);
+    }
+
+    Yadra::Kolonki kolonki;
+    uint64_t maska[Yadra::SLOV_MASKI];
+    double srednie[Yadra::RAZMER_BLOKA];
+    for (size_t nachalo = 0; nachalo < prognozi.size(); nachalo += 777) {
+        size_t razmer = std::min<size_t>(777, prognozi.size() - nachalo);
+        kolonki.zapolnit(prognozi.data() + nachalo, razmer);
+        size_t kolvo = Yadra::maskaOshibok(kolonki, maska);
+        Yadra::srednie(kolonki.utro, kolonki.den, kolonki.vecher, razmer, srednie);
+
+        size_t ozhidaem = 0;
+        for (size_t i = 0; i < razmer; i++) {
+            const ProstoyPrognoz& p = prognozi[nachalo + i];
+            REQUIRE((((maska[i / 64] >> (i % 64)) & 1) != 0) == p.oshibka());
+            ozhidaem += p.oshibka() ? 1 : 0;
+            double a = p.getAverageTemp();
+            REQUIRE(((srednie[i] == a) || (std::isnan(srednie[i]) && std::isnan(a))));
+        }
+        REQUIRE(kolvo == ozhidaem);
+    }
+    REQUIRE_THROWS_AS(kolonki.zapolnit(prognozi.data(), Yadra::RAZMER_BLOKA + 1), std::invalid_argument);
+
+    // removeOshibki и фильтр по ошибкам используют ядро
+    SlozhniyPrognoz vector;
+    std::vector<long long> ostavshiesya;
+    for (const ProstoyPrognoz& p : prognozi) {
+        vector += p;
+        if (!p.oshibka()) ostavshiesya.push_back(p.getDate());
+    }
+    REQUIRE(vector.poschitat(Filtr::oshibochnie()) == prognozi.size() - ostavshiesya.size());
+    vector.vklyuchitSvodki();
+    vector.removeOshibki();
+    const SlozhniyPrognoz& c = vector;
+    REQUIRE(c.size() == ostavshiesya.size());
+    for (size_t i = 0; i < c.size(); i++) {
+        REQUIRE(c[i].getDate() == ostavshiesya[i]);
+    }
+    REQUIRE(vector.poschitat(Filtr::oshibochnie()) == 0);
+    REQUIRE(vector.getSvodkaMesyatsa(c[0].getDate()).oshibok == 0);
+}
+
+TEST_CASE("Vectorized coldest day search", "[yadra][coldest]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+    for (int i = 0; i < 10000; i++) {
+        // Целые температуры дают много равных средних, NaN изредка
+        double utro = (double)gen.getDate(-30, 30);
+        if (gen.getDate(0, 499) == 0) utro = std::numeric_limits<double>::quiet_NaN();
+        vector += ProstoyPrognoz(gen.getDate(0, 1000000), utro, (double)gen.getDate(-30, 30), (double)gen.getDate(-30, 30), 0.0, "Sunny");
+    }
+
+    auto etalon = [](const SlozhniyPrognoz& c, long long a, long long b) {
+        bool found = false;
+        double minimum = 0.0;
+        size_t index = 0;
+        for (size_t i = 0; i < c.size(); i++) {
+            if (c[i].getDate() >= a && c[i].getDate() <= b) {
+                double average = c[i].getAverageTemp();
+                if (!found || average < minimum) {
+                    minimum = average;
+                    index = i;
+                    found = true;
+                }
+            }
+        }
+        return index;
+    };
+
+    for (int prohod = 0; prohod < 2; prohod++) {
+        const SlozhniyPrognoz& c = vector;
+        for (int z = 0; z < 300; z++) {
+            long long a = gen.getDate(-1000, 1000000);
+            long long b = a + gen.getDate(0, z % 2 ? 5000 : 1000000);
+            size_t ozhidaem = etalon(c, a, b);
+            bool estVDiapazone = false;
+            for (size_t i = 0; i < c.size() && !estVDiapazone; i++) {
+                estVDiapazone = c[i].getDate() >= a && c[i].getDate() <= b;
+            }
+            if (!estVDiapazone) {
+                REQUIRE_THROWS_AS(vector.getColdestDay(a, b), std::logic_error);
+                continue;
+            }
+            ProstoyPrognoz p = vector.getColdestDay(a, b);
+            REQUIRE(p.getDate() == c[ozhidaem].getDate());
+            REQUIRE(p.getEveningTemp() == c[ozhidaem].getEveningTemp());
+            REQUIRE(p.getDayTemp() == c[ozhidaem].getDayTemp());
+        }
+        vector.sortDates();  // Второй проход - с двоичным поиском границ (среди равных по дате - первый)
+    }
+}
+
+TEST_CASE("Kernel dispatch by instruction set", "[yadra][dispatch]") {
+    RandomGen gen;
+    Yadra::Uroven ishodniy = Yadra::uroven();
+    REQUIRE(ishodniy <= Yadra::apparatniyUroven());
+    REQUIRE(std::string(Yadra::imyaUrovnya(Yadra::Uroven::AVX2)) == "avx2");
+    REQUIRE(Yadra::ustanovitUroven(Yadra::Uroven::AVX512) == Yadra::apparatniyUroven());
+
+    // Блок с границами правил, NaN, равными средними и датами по обе стороны промежутка
+    std::vector<ProstoyPrognoz> prognozi;
+    const std::string statusi[] = { "Sunny", "Cloudy", "Rain", "Snow", "Fog" };
+    for (int i = 0; i < 1021; i++) {
+        double t[3];
+        for (double& x : t) {
+            long long v = gen.getDate(0, 19);
+            x = (v == 0) ? std::numeric_limits<double>::quiet_NaN() : (v < 5 ? (double)gen.getDate(-2, 2) * 50.0 : (double)gen.getDate(-120, 80));
+        }
+        double osadki = gen.getDate(0, 2) == 0 ? 0.0 : (double)gen.getDate(0, 2000);
+        prognozi.emplace_back(gen.getDate(0, 100), t[0], t[1], t[2], osadki, statusi[gen.getDate(0, 4)]);
+    }
+    Yadra::Kolonki kolonki;
+    kolonki.zapolnit(prognozi.data(), prognozi.size());
+
+    for (int u = 0; u <= (int)Yadra::apparatniyUroven(); u++) {
+        REQUIRE(Yadra::ustanovitUroven((Yadra::Uroven)u) == (Yadra::Uroven)u);
+        INFO("Uroven " << Yadra::imyaUrovnya(Yadra::uroven()));
+
+        uint64_t maska[Yadra::SLOV_MASKI];
+        double srednie[Yadra::RAZMER_BLOKA];
+        Yadra::maskaOshibok(kolonki, maska);
+        Yadra::srednie(kolonki.utro, kolonki.den, kolonki.vecher, kolonki.razmer, srednie);
+        for (size_t i = 0; i < prognozi.size(); i++) {
+            REQUIRE((((maska[i / 64] >> (i % 64)) & 1) != 0) == prognozi[i].oshibka());
+            double a = prognozi[i].getAverageTemp();
+            REQUIRE(((srednie[i] == a) || (std::isnan(srednie[i]) && std::isnan(a))));
+        }
+
+        for (int z = 0; z < 200; z++) {
+            long long a = gen.getDate(0, 100);
+            long long b = a + gen.getDate(0, 30);
+            bool found = false, foundEtalon = false;
+            double minimum = 0.0, minimumEtalon = 0.0;
+            size_t etalon = Yadra::NET;
+            for (size_t i = 0; i < prognozi.size(); i++) {
+                if (prognozi[i].getDate() < a || prognozi[i].getDate() > b) continue;
+                double average = prognozi[i].getAverageTemp();
+                if (!foundEtalon || average < minimumEtalon) {
+                    minimumEtalon = average;
+                    etalon = i;
+                    foundEtalon = true;
+                }
+            }
+            REQUIRE(Yadra::minimumSrednego(kolonki, a, b, found, minimum) == etalon);
+            REQUIRE(found == foundEtalon);
+        }
+    }
+    Yadra::ustanovitUroven(ishodniy);
+}
+
+TEST_CASE("Status bitmaps with popcount range counts", "[karti]") {
+    RandomGen gen;
+
+    SECTION("Roaring-style bitmap against std::vector<bool>") {
+        // Участки разной плотности: редкие (массив) и плотные (биты) по обе стороны границ 65536
+        const size_t N = 300000;
+        std::vector<bool> a(N), b(N);
+        BitovayaKarta ka, kb;
+        for (size_t i = 0; i < N; i++) {
+            long long plotnost = (i / 65536) % 2 == 0 ? 2 : 100;
+            if (gen.getDate(0, plotnost) == 0) {
+                a[i] = true;
+                ka.ustanovit(i);
+            }
+            if (gen.getDate(0, 3) == 0) {
+                b[i] = true;
+                kb.ustanovit(i);
+            }
+        }
+        kb.ustanovit(5);  // Добавление не в конец
+        b[5] = true;
+
+        auto proverit = [&]() {
+            for (int z = 0; z < 200; z++) {
+                size_t ot = (size_t)gen.getDate(0, (long long)a.size());
+                size_t doo = std::min(a.size(), ot + (size_t)gen.getDate(0, 150000));
+                size_t ca = 0, cb = 0, ci = 0, cili = 0;
+                for (size_t i = ot; i < doo; i++) {
+                    ca += a[i];
+                    cb += b[i];
+                    ci += a[i] && b[i];
+                    cili += a[i] || b[i];
+                }
+                REQUIRE(ka.kolvo(ot, doo) == ca);
+                REQUIRE(kb.kolvo(ot, doo) == cb);
+                REQUIRE(BitovayaKarta::kolvoI(ka, kb, ot, doo) == ci);
+                REQUIRE(BitovayaKarta::kolvoIli(ka, kb, ot, doo) == cili);
+            }
+        };
+        proverit();
+
+        BitovayaKarta i = ka & kb, ili = ka | kb;
+        REQUIRE(i.size() == BitovayaKarta::kolvoI(ka, kb, 0, N));
+        REQUIRE(ili.size() == BitovayaKarta::kolvoIli(ka, kb, 0, N));
+        std::vector<size_t> pozicii = i.pozicii();
+        for (size_t p : pozicii) {
+            REQUIRE((a[p] && b[p]));
+        }
+
+        // Удаление со сдвигом (в том числе переносы через границы участков)
+        for (int z = 0; z < 60; z++) {
+            size_t p = (z % 3 == 0) ? 65536 * (size_t)gen.getDate(0, 3) : (size_t)gen.getDate(0, (long long)a.size() - 1);
+            ka.udalit(p);
+            kb.udalit(p);
+            a.erase(a.begin() + p);
+            b.erase(b.begin() + p);
+        }
+        size_t vsegoA = 0;
+        for (bool x : a) vsegoA += x;
+        REQUIRE(ka.size() == vsegoA);
+        for (size_t p = 0; p < a.size(); p += 7) {
+            REQUIRE(ka.proverit(p) == a[p]);
+        }
+        proverit();
+    }
+
+    SECTION("SlozhniyPrognoz keeps bitmaps in sync") {
+        SlozhniyPrognoz vector;
+        for (int i = 0; i < 20000; i++) {
+            vector += gen.getForecast();
+        }
+        auto etalon = [](const SlozhniyPrognoz& c, const std::string& status, long long a, long long b) {
+            size_t kolvo = 0;
+            for (size_t i = 0; i < c.size(); i++) {
+                if (c[i].getDate() >= a && c[i].getDate() <= b && c[i].getStatus() == status) kolvo++;
+            }
+            return kolvo;
+        };
+        auto etalonOshibok = [](const SlozhniyPrognoz& c, long long a, long long b) {
+            size_t kolvo = 0;
+            for (size_t i = 0; i < c.size(); i++) {
+                if (c[i].getDate() >= a && c[i].getDate() <= b && c[i].oshibka()) kolvo++;
+            }
+            return kolvo;
+        };
+
+        for (int shag = 0; shag < 40; shag++) {
+            long long a = gen.getDate(1577836800, 1893456000);
+            long long b = a + gen.getDate(0, 100000000);
+            REQUIRE(vector.poschitatStatus("Rain", a, b) == etalon(vector, "Rain", a, b));
+            REQUIRE(vector.poschitatOshibki(a, b) == etalonOshibok(vector, a, b));
+
+            // Дождливые ошибочные дни: пересечение карт в промежутке
+            size_t nachalo, konets;
+            vector.poziciiDiapazona(a, b, nachalo, konets);
+            size_t ozhidaem = 0;
+            const SlozhniyPrognoz& c = vector;
+            for (size_t i = nachalo; i < konets; i++) {
+                ozhidaem += (c[i].getStatus() == "Rain" && c[i].oshibka()) ? 1 : 0;
+            }
+            REQUIRE(BitovayaKarta::kolvoI(vector.kartaStatusa("Rain"), vector.kartaOshibok(), nachalo, konets) == ozhidaem);
+
+            // Добавления по порядку и удаления не сбрасывают карты
+            long long posledniy = c[c.size() - 1].getDate();
+            for (int i = 0; i < 50; i++) {
+                ProstoyPrognoz p = gen.getForecast();
+                p.setDate(posledniy + i * 86400);
+                vector += p;
+            }
+            for (int i = 0; i < 20; i++) {
+                vector.remove((size_t)gen.getDate(0, (long long)vector.size() - 1));
+            }
+        }
+        REQUIRE(vector.poschitatStatus("Snow", 0, 4000000000) == etalon(vector, "Snow", 0, 4000000000));
+
+        std::map<long long, size_t> poMesyatsam = vector.poschitatStatusPoMesyatsam("Sunny");
+        size_t vsego = 0;
+        for (auto& [klyuch, kolvo] : poMesyatsam) {
+            long long nachaloMesyatsa = Kalendar::nachaloMesyatsa(klyuch);
+            REQUIRE(kolvo == etalon(vector, "Sunny", nachaloMesyatsa, Kalendar::nachaloMesyatsa(klyuch + 1) - 1));
+            vsego += kolvo;
+        }
+        REQUIRE(vsego == etalon(vector, "Sunny", 0, 4000000000));
+        REQUIRE_THROWS_AS(vector.kartaStatusa("Fog"), std::out_of_range);
+    }
+}
+
+
+TEST_CASE("Zone maps for block skipping", "[zoni]") {
+    RandomGen gen;
+    using P = Filtr::Pole;
+    using O = Filtr::Operaciya;
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    // Температура растет вдоль массива, поэтому у блоков узкие и разные промежутки
+    auto sozdat = [&](long long i, long long date) {
+        double t = -40.0 + 80.0 * (double)(i % 20000) / 20000.0 + gen.getDouble(-2.0, 2.0);
+        double utro = (gen.getDate(0, 500) == 0) ? NaN : t - 3.0;
+        return ProstoyPrognoz(date, utro, t + 3.0, t, gen.getDouble(0.0, 10.0), gen.getStatus());
+    };
+    std::vector<Filtr> filtri = {
+        Filtr::sravnenie(P::Den, O::Menshe, -30.0),
+        Filtr::sravnenie(P::Vecher, O::BolsheIliRavno, 35.5),
+        Filtr::sravnenie(P::Utro, O::MensheIliRavno, -41.0),
+        Filtr::sravnenie(P::SrednyayaTemp, O::Bolshe, 10.0) && Filtr::sravnenie(P::SrednyayaTemp, O::Menshe, 12.0),
+        Filtr::sravnenie(P::Den, O::Ravno, 5.0) || Filtr::sravnenie(P::Vecher, O::Bolshe, 39.0),
+        Filtr::sravnenie(P::Vecher, O::NeRavno, NaN) && Filtr::sravnenie(P::Osadki, O::Ravno, NaN),
+        !Filtr::sravnenie(P::Den, O::Bolshe, -35.0),
+        Filtr::statusi({"Rain"}) && Filtr::sravnenie(P::Vecher, O::Menshe, -38.0),
+        Filtr::daty(1000000, 1500000) && Filtr::sravnenie(P::Utro, O::Bolshe, 0.0),
+        Filtr::oshibochnie()
+    };
+
+    SECTION("Zone of a block and conservative check") {
+        ZonnayaKarta karta;
+        karta.dopisat(ProstoyPrognoz(100, 1.0, 2.0, 3.0, 0.5, "Sunny"));
+        karta.dopisat(ProstoyPrognoz(50, NaN, 4.0, -1.0, 0.0, "Rain"));
+        REQUIRE(karta.size() == 1);
+        REQUIRE(karta[0].minDate == 50);
+        REQUIRE(karta[0].maxDate == 100);
+        REQUIRE(karta[0].min[(int)P::Utro] == -std::numeric_limits<double>::infinity());
+        REQUIRE(karta[0].min[(int)P::Vecher] == -1.0);
+        REQUIRE(karta[0].max[(int)P::Den] == 4.0);
+
+        REQUIRE_FALSE(Filtr::sravnenie(P::Den, O::Bolshe, 4.0).mozhetPodoyti(karta[0]));
+        REQUIRE(Filtr::sravnenie(P::Den, O::BolsheIliRavno, 4.0).mozhetPodoyti(karta[0]));
+        REQUIRE(Filtr::sravnenie(P::Utro, O::Bolshe, 1000.0).mozhetPodoyti(karta[0]));
+        REQUIRE_FALSE(Filtr::daty(101, 200).mozhetPodoyti(karta[0]));
+        REQUIRE_FALSE((Filtr::daty(0, 200) && Filtr::sravnenie(P::Osadki, O::Menshe, 0.0)).mozhetPodoyti(karta[0]));
+        REQUIRE(Filtr::oshibochnie().mozhetPodoyti(karta[0]));
+
+        // Построенная заново карта дает ту же зону (так проверяются зоны из файла)
+        ZonnayaKarta zanovo;
+        ProstoyPrognoz dva[2] = { ProstoyPrognoz(100, 1.0, 2.0, 3.0, 0.5, "Sunny"), ProstoyPrognoz(50, NaN, 4.0, -1.0, 0.0, "Rain") };
+        zanovo.postroit(dva, 2);
+        REQUIRE(zanovo[0] == karta[0]);
+        zanovo.postroit(dva, 1);
+        REQUIRE_FALSE(zanovo[0] == karta[0]);
+    }
+
+    SECTION("Filter queries with zones match the full scan") {
+        SlozhniyPrognoz vector;
+        for (long long i = 0; i < 30000; i++) {
+            vector += sozdat(i, 1000000 + i * 60);
+        }
+        auto perebor = [](const SlozhniyPrognoz& v, const Filtr& f) {
+            std::vector<size_t> rez;
+            for (size_t i = 0; i < v.size(); i++) {
+                if (f.proverit(v[i])) rez.push_back(i);
+            }
+            return rez;
+        };
+        auto sravnit = [&]() {
+            const SlozhniyPrognoz& v = vector;
+            for (const Filtr& f : filtri) {
+                std::vector<size_t> ozhidaem = perebor(v, f);
+                REQUIRE(v.nayti(f) == ozhidaem);
+                REQUIRE(v.poschitat(f) == ozhidaem.size());
+                REQUIRE(vector.estLi(f) == !ozhidaem.empty());
+            }
+        };
+
+        vector.postroitZoni();
+        sravnit();
+
+        // Дописывание в конец (в том числе не по порядку дат) дополняет зоны
+        for (long long i = 0; i < 1500; i++) {
+            vector += sozdat(i * 13, 1000000 + gen.getDate(0, 40000) * 60);
+        }
+        sravnit();
+
+        // Изменение по ссылке и удаление сбрасывают зоны, estLi строит их заново
+        vector[17] = ProstoyPrognoz(1200000, -80.0, -80.0, -80.0, 0.0, "Rain");
+        vector.remove(5);
+        sravnit();
+        vector.mergePovtorki();
+        sravnit();
+        REQUIRE(vector.estLi(Filtr::sravnenie(P::Vecher, O::Menshe, -79.0)));
+        REQUIRE_FALSE(vector.estLi(Filtr::sravnenie(P::Vecher, O::Bolshe, 1000.0)));
+    }
+
+    SECTION("Station store skips blocks and keeps zones in the binary format") {
+        HranilisheStanciy hranilishe;
+        std::map<std::string, SlozhniyPrognoz> etalon;
+        for (int priem = 0; priem < 2; priem++) {
+            for (long long i = 0; i < 12000; i++) {
+                std::string id = "ZS" + std::to_string(gen.getDate(0, 4));
+                ProstoyPrognoz p = sozdat(i + priem * 12000, 1000000 + (i + priem * 12000) * 60 + gen.getDate(0, 30));
+                hranilishe.dobavit(id, p);
+                etalon[id] += p;
+            }
+            hranilishe.uplotnit();
+        }
+
+        auto sravnit = [&](HranilisheStanciy& h) {
+            for (const Filtr& f : filtri) {
+                size_t ozhidaem = 0;
+                for (auto& [id, vector] : etalon) {
+                    ozhidaem += ((const SlozhniyPrognoz&)vector).poschitat(f);
+                }
+                std::vector<HranilisheStanciy::Nahodka> naydennie = h.nayti({}, f);
+                REQUIRE(naydennie.size() == ozhidaem);
+                REQUIRE(h.poschitat({}, f) == ozhidaem);
+                for (const HranilisheStanciy::Nahodka& n : naydennie) {
+                    REQUIRE(f.proverit(h.prognoz(n)));
+                }
+            }
+        };
+        sravnit(hranilishe);
+
+        std::stringstream potok(std::ios::in | std::ios::out | std::ios::binary);
+        hranilishe.sohranit(potok);
+        HranilisheStanciy zagruzhennoe = HranilisheStanciy::zagruzit(potok);
+        sravnit(zagruzhennoe);
+
+        // Испорченная зона (дата не совпадает с прогнозами) не принимается
+        std::string dannie = potok.str();
+        dannie[dannie.size() - 96 * 3] ^= 1;
+        std::stringstream isporchennie(dannie);
+        REQUIRE_THROWS_AS(HranilisheStanciy::zagruzit(isporchennie), std::runtime_error);
+    }
+
+    SECTION("A tampered temperature range in a stored zone is rejected") {
+        HranilisheStanciy hranilishe;
+        for (long long i = 0; i < 10; i++) {
+            hranilishe.dobavit("T", ProstoyPrognoz(1000000 + i * 86400, -5.0, 1.0, 2.0, 0.0, "Rain"));
+        }
+        hranilishe.uplotnit();
+        Filtr holodnoeUtro = Filtr::sravnenie(Filtr::Pole::Utro, Filtr::Operaciya::Menshe, 0.0);
+
+        std::stringstream potok(std::ios::in | std::ios::out | std::ios::binary);
+        hranilishe.sohranit(potok);
+        std::string dannie = potok.str();
+        std::stringstream celie(dannie);
+        REQUIRE(HranilisheStanciy::zagruzit(celie).poschitat({}, holodnoeUtro) == 10);
+
+        // Единственная зона - последние 96 байт: даты, затем min/max утра (смещения 16 и 24)
+        uint64_t tysyacha = std::bit_cast<uint64_t>(1000.0);
+        size_t zona = dannie.size() - 96;
+        for (size_t smeshenie : { zona + 16, zona + 24 }) {
+            for (size_t b = 0; b < 8; b++) dannie[smeshenie + b] = (char)((tysyacha >> (8 * b)) & 0xFF);
+        }
+        std::stringstream isporchennie(dannie);
+        REQUIRE_THROWS_AS(HranilisheStanciy::zagruzit(isporchennie), std::runtime_error);
+    }
+}
+
+TEST_CASE("Per-query memory arena", "[arena]") {
+    RandomGen gen;
+    SlozhniyPrognoz vector;
+    for (int i = 0; i < 20000; i++) {
+        vector += gen.getForecast();
+    }
+    const long long date = vector[123].getDate();
+    Filtr filtr = Filtr::sravnenie(Filtr::Pole::Vecher, Filtr::Operaciya::Menshe, 0.0) || Filtr::statusi({"Rain"});
+
+    // Все временные данные запроса умещаются в буфер арены, без обращения к общей куче
+    std::vector<std::byte> pamyat(8 << 20);
+    std::pmr::monotonic_buffer_resource arena(pamyat.data(), pamyat.size(), std::pmr::null_memory_resource());
+
+    SECTION("getMonth and getMonths place results in the arena") {
+        SlozhniyPrognoz obichniy = vector.getMonth(date);
+        SlozhniyPrognoz vArene = vector.getMonth(date, 0, &arena);
+        REQUIRE(vArene.resursPamyati() == &arena);
+        REQUIRE(vArene.size() == obichniy.size());
+        for (size_t i = 0; i < vArene.size(); i++) {
+            REQUIRE(vArene[i].getDate() == obichniy[i].getDate());
+            REQUIRE(vArene[i].getStatus() == obichniy[i].getStatus());
+        }
+        for (int i = 0; i < 50; i++) {
+            vArene += gen.getForecast();  // Рост массива тоже идет в арене
+        }
+        REQUIRE(vArene.resursPamyati() == &arena);
+
+        // Копия живет дольше арены, перемещение забирает массив вместе с ареной
+        SlozhniyPrognoz kopiya = vArene;
+        REQUIRE(kopiya.resursPamyati() == std::pmr::get_default_resource());
+        SlozhniyPrognoz peremeshenniy = std::move(vArene);
+        REQUIRE(peremeshenniy.resursPamyati() == &arena);
+        REQUIRE(peremeshenniy.size() == kopiya.size());
+
+        std::vector<SlozhniyPrognoz> mesyatsi = vector.getMonths({ date, date + 40LL * 86400 }, 0, &arena);
+        REQUIRE(mesyatsi[0].resursPamyati() == &arena);
+        REQUIRE(mesyatsi[0].size() == obichniy.size());
+        REQUIRE(mesyatsi[1].size() == vector.getMonth(date + 40LL * 86400).size());
+
+        vector.sortDates();
+        REQUIRE(vector.getMonth(date, 0, &arena).size() == obichniy.size());
+    }
+
+    SECTION("Move assignment keeps the target's memory resource") {
+        std::vector<std::byte> pamyatZaprosa(1 << 20);
+        std::pmr::monotonic_buffer_resource zapros(pamyatZaprosa.data(), pamyatZaprosa.size(), std::pmr::null_memory_resource());
+
+        SlozhniyPrognoz etalon = vector.getMonth(date);
+        REQUIRE(etalon.size() > SlozhniyPrognoz::VSTROENNAYA_EMKOST);
+        SlozhniyPrognoz dolgiy;
+        dolgiy = vector.getMonth(date, 0, &zapros);
+        REQUIRE(dolgiy.resursPamyati() == std::pmr::get_default_resource());
+
+        // Арена запроса освобождена и затерта, а результат, присвоенный долгоживущему объекту, цел
+        zapros.release();
+        std::fill(pamyatZaprosa.begin(), pamyatZaprosa.end(), std::byte{ 0xAB });
+        REQUIRE(dolgiy.size() == etalon.size());
+        for (size_t i = 0; i < dolgiy.size(); i++) {
+            REQUIRE(dolgiy[i].getDate() == etalon[i].getDate());
+            REQUIRE(dolgiy[i].getStatus() == etalon[i].getStatus());
+        }
+
+        // С одинаковым источником массив забирается без копирования
+        SlozhniyPrognoz vArene = vector.getMonth(date, 0, &arena);
+        SlozhniyPrognoz tozheVArene(&arena);
+        const ProstoyPrognoz* adres = &vArene[0];
+        tozheVArene = std::move(vArene);
+        REQUIRE(&tozheVArene[0] == adres);
+        REQUIRE(vArene.size() == 0);
+    }
+
+    SECTION("Filter results and scratch buffers come from the arena") {
+        std::vector<size_t> obichnie = vector.nayti(filtr);
+        std::pmr::vector<size_t> vArene = vector.nayti(filtr, &arena);
+        REQUIRE(vArene.get_allocator().resource() == &arena);
+        REQUIRE(std::equal(vArene.begin(), vArene.end(), obichnie.begin(), obichnie.end()));
+        REQUIRE(vector.poschitat(filtr, &arena) == obichnie.size());
+
+        std::pmr::vector<const ProstoyPrognoz*> ukazateli = vector.vibrat(filtr, &arena);
+        REQUIRE(ukazateli.size() == obichnie.size());
+        for (size_t i = 0; i < ukazateli.size(); i++) {
+            REQUIRE(ukazateli[i] == &vector[obichnie[i]]);
+        }
+    }
+
+    SECTION("mergePovtorki with scratch in the arena") {
+        for (int i = 0; i < 80000; i++) {
+            vector += gen.getForecast();
+        }
+        SlozhniyPrognoz etalon = vector;
+        etalon.mergePovtorki();
+        vector.mergePovtorki(&arena);
+        REQUIRE(vector.size() == etalon.size());
+        for (size_t i = 0; i < vector.size(); i++) {
+            REQUIRE(vector[i].getDate() == etalon[i].getDate());
+            REQUIRE(vector[i].getDayTemp() == etalon[i].getDayTemp());
+        }
+        REQUIRE(vector.resursPamyati() == std::pmr::get_default_resource());
+    }
+
+    // Одно освобождение арены возвращает всю память запроса
+    arena.release();
+}
+
+TEST_CASE("Inline storage for short arrays", "[vstroenniy]") {
+    RandomGen gen;
+
+    SECTION("Up to VSTROENNAYA_EMKOST forecasts need no memory resource") {
+        // Источник, который отказывает в любом выделении: рост сверх буфера бросает исключение
+        SlozhniyPrognoz nedelya(std::pmr::null_memory_resource());
+        std::vector<ProstoyPrognoz> etalon;
+        for (size_t i = 0; i < SlozhniyPrognoz::VSTROENNAYA_EMKOST; i++) {
+            ProstoyPrognoz p = gen.getForecast();
+            nedelya += p;
+            etalon.push_back(p);
+        }
+        REQUIRE(nedelya.size() == SlozhniyPrognoz::VSTROENNAYA_EMKOST);
+        REQUIRE_THROWS_AS(nedelya += gen.getForecast(), std::bad_alloc);
+
+        SlozhniyPrognoz kopiya = nedelya;
+        SlozhniyPrognoz peremeshenniy = std::move(nedelya);
+        REQUIRE(nedelya.size() == 0);
+        REQUIRE(peremeshenniy.size() == etalon.size());
+        for (size_t i = 0; i < etalon.size(); i++) {
+            REQUIRE(peremeshenniy[i].getDate() == etalon[i].getDate());
+            REQUIRE(peremeshenniy[i].getStatus() == etalon[i].getStatus());
+            REQUIRE(kopiya[i].getDayTemp() == etalon[i].getDayTemp());
+        }
+
+        // Перемещающее присваивание и повторное использование перемещенного объекта
+        nedelya = std::move(peremeshenniy);
+        peremeshenniy += etalon[0];
+        REQUIRE(nedelya.size() == etalon.size());
+        REQUIRE(peremeshenniy.size() == 1);
+        nedelya.sortDates();
+        for (size_t i = 1; i < nedelya.size(); i++) {
+            REQUIRE(nedelya[i - 1].getDate() <= nedelya[i].getDate());
+        }
+    }
+
+    SECTION("Single-forecast constructor and small copies do not allocate") {
+        std::pmr::memory_resource* prezhniy = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        bool bezVydeleniya = true;
+        try {
+            ProstoyPrognoz p(86400, 1.0, 2.0, 3.0, 0.0, "Rain");
+            SlozhniyPrognoz odin(p);
+            SlozhniyPrognoz kopiya(odin);
+            kopiya += p;
+            kopiya = odin;
+            SlozhniyPrognoz iz(std::move(kopiya));
+            REQUIRE(iz.size() == 1);
+            REQUIRE(odin[0].getStatus() == "Rain");
+        }
+        catch (const std::bad_alloc&) {
+            bezVydeleniya = false;
+        }
+        std::pmr::set_default_resource(prezhniy);
+        REQUIRE(bezVydeleniya);
+    }
+
+    SECTION("Growing past the inline buffer moves the array to the heap") {
+        SlozhniyPrognoz vector;
+        std::vector<ProstoyPrognoz> etalon;
+        for (int i = 0; i < 100; i++) {
+            ProstoyPrognoz p = gen.getForecast();
+            vector += p;
+            etalon.push_back(p);
+            REQUIRE(vector.size() == etalon.size());
+            REQUIRE(vector[etalon.size() - 1].getDate() == p.getDate());
+        }
+        for (size_t i = 0; i < etalon.size(); i++) {
+            REQUIRE(vector[i].getEveningTemp() == etalon[i].getEveningTemp());
+        }
+        while (vector.size() > 3) vector.remove(0);
+        SlozhniyPrognoz malenkiy = vector;  // Копия короткого содержимого большой емкости
+        SlozhniyPrognoz prisvoenniy;
+        prisvoenniy = vector;
+        const ProstoyPrognoz* vKuche = &vector[0];
+        SlozhniyPrognoz zabral = std::move(vector);
+        REQUIRE(malenkiy.size() == 3);
+        REQUIRE(prisvoenniy.size() == 3);
+        REQUIRE(zabral.size() == 3);
+        REQUIRE(zabral[2].getDate() == etalon.back().getDate());
+        REQUIRE(&zabral[0] == vKuche);  // Массив из кучи забирается по указателю
+
+        // Копии встроены: при перемещении прогнозы переносятся в новый объект
+        const ProstoyPrognoz* vKopii = &malenkiy[0];
+        SlozhniyPrognoz izKopii = std::move(malenkiy);
+        REQUIRE(&izKopii[0] != vKopii);
+        REQUIRE(izKopii[2].getDate() == etalon.back().getDate());
+
+        // И могут дорасти до VSTROENNAYA_EMKOST без выделения памяти
+        std::pmr::memory_resource* prezhniy = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        bool bezVydeleniya = true;
+        try {
+            SlozhniyPrognoz kopiya = zabral;
+            SlozhniyPrognoz naznachenie;
+            naznachenie = zabral;
+            while (kopiya.size() < SlozhniyPrognoz::VSTROENNAYA_EMKOST) kopiya += etalon[kopiya.size()];
+        }
+        catch (const std::bad_alloc&) {
+            bezVydeleniya = false;
+        }
+        std::pmr::set_default_resource(prezhniy);
+        REQUIRE(bezVydeleniya);
+    }
+}
+
 //Тесты для простого класса
 
 TEST_CASE("Testing setters and operators, Prostoy", "[operators][setters]") {